@@ -0,0 +1,98 @@
+#include "archive.hpp"
+#include "loader.hpp"
+#include "snapshot.hpp"
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <sys/stat.h>
+
+namespace {
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " append <archive" << ARCHIVE_EXTENSION << "> <data.json|data"
+              << SNAPSHOT_EXTENSION << ">...\n"
+              << "       " << argv0 << " list <archive" << ARCHIVE_EXTENSION << ">" << std::endl;
+}
+
+// Seconds since the epoch of the file's last modification
+double modified_time(const std::string& path) {
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        throw std::runtime_error("Cannot stat file: " + path);
+    }
+    return double(st.st_mtim.tv_sec) + st.st_mtim.tv_nsec * 1e-9;
+}
+
+std::string format_time(double timestamp) {
+    const std::time_t t = std::time_t(timestamp);
+    std::tm tm{};
+    gmtime_r(&t, &tm);
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &tm);
+    return buf;
+}
+
+int append(const std::string& archive, int argc, char* argv[]) {
+    ArchiveWriter writer(archive);
+    size_t bytes = 0;
+    for (int i = 0; i < argc; ++i) {
+        const std::string path = argv[i];
+        if (!std::filesystem::exists(path)) {
+            std::cerr << "Error: Data file not found: " << path << std::endl;
+            return 1;
+        }
+        // JSON snapshots carry Tradier's timestamp; otherwise the file's mtime
+        std::optional<double> timestamp;
+        OptionChain chain;
+        std::optional<double> spot;
+        if (std::filesystem::path(path).extension() == SNAPSHOT_EXTENSION) {
+            std::tie(chain, spot) = load_snapshot(path);
+        } else {
+            TradierSnapshot snapshot = read_option_snapshot(path);
+            chain = std::move(snapshot.chain);
+            spot = snapshot.spot;
+            timestamp = snapshot.timestamp;
+        }
+        bytes += writer.append(chain, spot, timestamp.value_or(modified_time(path)));
+    }
+    writer.close();
+    std::cout << "Appended " << argc << " snapshots (" << bytes << " bytes) to " << archive << "; "
+              << writer.entries() << " in the archive" << std::endl;
+    return 0;
+}
+
+int list(const std::string& archive) {
+    const ArchiveReader reader(archive);
+    const auto& entries = reader.entries();
+    std::printf("%-8s %-20s %8s %12s %s\n", "Symbol", "Time (UTC)", "Rows", "Block", "Structure");
+    for (const ArchiveEntry& entry : entries) {
+        std::printf("%-8s %-20s %8u %12llu %s\n", reader.symbols()[entry.symbol_id].c_str(),
+                    format_time(entry.timestamp).c_str(), entry.row_count,
+                    static_cast<unsigned long long>(entry.block_offset),
+                    entry.structure_offset == entry.block_offset ? "own" : "shared");
+    }
+    std::printf("%zu snapshots of %zu symbols\n", entries.size(), reader.symbols().size());
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        if (argc < 3) {
+            usage(argv[0]);
+            return 1;
+        }
+        const std::string command = argv[1];
+        if (command == "append" && argc > 3) return append(argv[2], argc - 3, argv + 3);
+        if (command == "list" && argc == 3) return list(argv[2]);
+        usage(argv[0]);
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
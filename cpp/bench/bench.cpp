@@ -0,0 +1,259 @@
+#include "synthetic_chain.hpp"
+#include "loader.hpp"
+#include "factory/factory.hpp"
+#include "factory/option_filter.hpp"
+#include "factory/chain_index.hpp"
+#include "factory/pricing.hpp"
+#include "result_writer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Per-stage benchmarks over synthetic chains:
+//
+//   option_screener_bench [--strikes 50,200,1000,2000] [--expiries 8] [--reps 5]
+//                         [--ic-max-strikes 200] [--iv-atm 0.3] [--iv-skew -0.2]
+//                         [--iv-smile 0.5] [--iv-noise 0.02] [--seed 42]
+//
+// Iron condor counts grow with the fourth power of strikes, so that stage is
+// skipped above --ic-max-strikes.
+
+namespace {
+
+struct StageResult {
+    size_t items = 0;
+    double min_ms = 0.0;
+    double median_ms = 0.0;
+};
+
+// Runs fn reps times; fn returns the number of items it processed
+template <typename Fn>
+StageResult time_stage(size_t reps, Fn&& fn) {
+    std::vector<double> ms;
+    StageResult result;
+    for (size_t r = 0; r < reps; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        result.items = fn();
+        auto end = std::chrono::steady_clock::now();
+        ms.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    std::sort(ms.begin(), ms.end());
+    result.min_ms = ms.front();
+    result.median_ms = ms[ms.size() / 2];
+    return result;
+}
+
+void print_stage(const char* name, const char* unit, const StageResult& r) {
+    double per_sec = r.min_ms > 0.0 ? r.items / (r.min_ms / 1000.0) : 0.0;
+    std::printf("  %-22s %12zu %-10s %12.3f %12.3f %14.3e\n", name, r.items, unit, r.min_ms, r.median_ms, per_sec);
+}
+
+void print_skipped(const char* name, const char* reason) {
+    std::printf("  %-22s %12s %s\n", name, "-", reason);
+}
+
+std::vector<size_t> parse_list(const std::string& s) {
+    std::vector<size_t> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        out.push_back(std::stoul(item));
+    }
+    return out;
+}
+
+// Representative screen: liquid near-dated contracts, capped risk
+ConfigFilter bench_config() {
+    ConfigFilter cfg;
+    cfg.min_oi = 10;
+    cfg.min_price = 0.05;
+    cfg.days_to_expiry_range = std::make_tuple(0, 90);
+    cfg.max_bid_ask_spread = 1.0;
+    cfg.direction = Direction::SHORT;
+    cfg.credit_range = std::make_tuple(0.0, 5000.0);
+    cfg.potential_loss_range = std::make_tuple(0.0, 500.0);
+    cfg.rr_range = std::make_tuple(0.1, 100.0);
+    return cfg;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        std::vector<size_t> strikes = {50, 200, 1000, 2000};
+        size_t reps = 5;
+        size_t ic_max_strikes = 200;
+        SyntheticChainParams params;
+
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return 1;
+            }
+            std::string value = argv[++i];
+            if (arg == "--strikes") strikes = parse_list(value);
+            else if (arg == "--expiries") params.expiries = std::stoul(value);
+            else if (arg == "--reps") reps = std::max<size_t>(1, std::stoul(value));
+            else if (arg == "--ic-max-strikes") ic_max_strikes = std::stoul(value);
+            else if (arg == "--iv-atm") params.iv_atm = std::stod(value);
+            else if (arg == "--iv-skew") params.iv_skew = std::stod(value);
+            else if (arg == "--iv-smile") params.iv_smile = std::stod(value);
+            else if (arg == "--iv-noise") params.iv_noise = std::stod(value);
+            else if (arg == "--seed") params.seed = std::stoull(value);
+            else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                return 1;
+            }
+        }
+
+        const ConfigFilter cfg = bench_config();
+        const std::string path = (std::filesystem::temp_directory_path() / "option_screener_bench.json").string();
+
+        for (size_t n : strikes) {
+            params.strikes_per_expiry = n;
+            const std::string text = make_synthetic_snapshot_json(params);
+            {
+                std::ofstream out(path, std::ios::binary);
+                out << text;
+            }
+
+            std::printf("\n%zu strikes x %zu expiries (%zu options, %.1f MB JSON)\n",
+                        n, params.expiries, 2 * n * params.expiries, text.size() / 1e6);
+            std::printf("  %-22s %12s %-10s %12s %12s %14s\n", "stage", "items", "", "min ms", "median ms", "items/s");
+
+            // ---- Load ----
+            print_stage("json_load", "options", time_stage(reps, [&] {
+                auto [chain, spot] = load_option_snapshot(path);
+                return chain.size();
+            }));
+
+            auto [chain, spot_opt] = load_option_snapshot(path);
+            const double spot = spot_opt.value();
+
+            // ---- Option-level filter ----
+            print_stage("option_filter", "rows", time_stage(reps, [&] {
+                OptionFilter filter(chain, spot);
+                filter.apply_filter(cfg);
+                return chain.size();
+            }));
+
+            print_stage("chain_index", "rows", time_stage(reps, [&] {
+                ChainIndex index(chain, spot, cfg);
+                return index.rows().size();
+            }));
+
+            // ---- Pricing: every row's IV from its mid, then greeks ----
+            OptionChain priced = chain;
+            print_stage("pricing", "rows", time_stage(reps, [&] {
+                price_chain(priced, spot, PricingConfig{PricingMode::ALL, 0.0});
+                return priced.size();
+            }));
+
+            // ---- Generators ----
+            const ChainIndex index(chain, spot, cfg);
+            std::vector<StrategyRecord> generated;
+
+            auto bench_generator = [&](const char* name, StrategyGenerator& generator) {
+                print_stage(name, "strategies", time_stage(reps, [&] {
+                    size_t count = 0;
+                    generator.generate(index, cfg, [&](const StrategyRecord&) { ++count; });
+                    return count;
+                }));
+                auto records = generator.collect(index, cfg);
+                generated.insert(generated.end(), records.begin(), records.end());
+            };
+
+            SingleCallsGenerator single_calls;
+            IronCondorsGenerator iron_condors;
+            StraddlesGenerator straddles;
+            StranglesGenerator strangles;
+            CallVerticalsGenerator call_verticals;
+            CallButterfliesGenerator call_butterflies;
+            CallCalendarsGenerator call_calendars;
+            CallDiagonalsGenerator call_diagonals;
+            bench_generator("gen_single_calls", single_calls);
+            if (n <= ic_max_strikes) {
+                bench_generator("gen_iron_condors", iron_condors);
+            } else {
+                print_skipped("gen_iron_condors", "(strikes > --ic-max-strikes)");
+            }
+            bench_generator("gen_straddles", straddles);
+            bench_generator("gen_strangles", strangles);
+            bench_generator("gen_call_verticals", call_verticals);
+            bench_generator("gen_call_butterflies", call_butterflies);
+            bench_generator("gen_call_calendars", call_calendars);
+            bench_generator("gen_call_diagonals", call_diagonals);
+
+            // ---- Strategy-level filter ----
+            std::vector<StrategyRecord> passed;
+            print_stage("filter_strategies", "strategies", time_stage(reps, [&] {
+                passed.clear();
+                for (const StrategyRecord& s : generated) {
+                    if (passes_strategy_level_filters(cfg, s)) passed.push_back(s);
+                }
+                return generated.size();
+            }));
+
+            // ---- Ranking (over everything generated, filtered or not) ----
+            print_stage("rank_rr", "strategies", time_stage(reps, [&] {
+                auto ranked = StrategyList(chain, std::vector<StrategyRecord>(generated)).rank("rr");
+                return ranked.size();
+            }));
+
+            print_stage("rank_top20_rr", "strategies", time_stage(reps, [&] {
+                auto top = StrategyList(chain, std::vector<StrategyRecord>(generated)).rank("rr").top(20);
+                return generated.size();
+            }));
+
+            print_stage("ranked_top20_rr", "strategies", time_stage(reps, [&] {
+                auto top = StrategyList(chain, std::vector<StrategyRecord>(generated)).ranked_top("rr", 20);
+                return generated.size();
+            }));
+
+            print_stage("ranked_top20_mixed", "strategies", time_stage(reps, [&] {
+                auto top = StrategyList(chain, std::vector<StrategyRecord>(generated)).ranked_top("rr*liquidity,theta/loss", 20);
+                return generated.size();
+            }));
+
+            print_stage("top_k20_rr", "strategies", time_stage(reps, [&] {
+                TopStrategies best("rr", 20);
+                for (const StrategyRecord& s : generated) best.push(s);
+                best.take(chain);
+                return generated.size();
+            }));
+
+            // ---- Result writers (everything generated, to /dev/null) ----
+            auto bench_writer = [&](const char* name, ResultFormat format) {
+                print_stage(name, "strategies", time_stage(reps, [&] {
+                    std::FILE* sink = std::fopen("/dev/null", "wb");
+                    if (!sink) throw std::runtime_error("Cannot open /dev/null");
+                    {
+                        ResultWriter writer(sink, format);
+                        for (const StrategyRecord& s : generated) writer.write(chain, s, chain.symbol);
+                        writer.flush();
+                    }
+                    std::fclose(sink);
+                    return generated.size();
+                }));
+            };
+            bench_writer("write_csv", ResultFormat::CSV);
+            bench_writer("write_ndjson", ResultFormat::NDJSON);
+            bench_writer("write_binary", ResultFormat::BINARY);
+        }
+
+        std::filesystem::remove(path);
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
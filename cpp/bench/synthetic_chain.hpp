@@ -0,0 +1,115 @@
+#ifndef SYNTHETIC_CHAIN_HPP
+#define SYNTHETIC_CHAIN_HPP
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <random>
+#include <string>
+
+// ===================== SYNTHETIC CHAIN =====================
+// Tradier-format snapshot text with Black-Scholes prices and greeks on a
+// parametric volatility smile, for benchmarks that need chains of any size.
+struct SyntheticChainParams {
+    size_t strikes_per_expiry = 200;
+    size_t expiries = 8;
+    size_t expiry_spacing_days = 7;
+    double spot = 100.0;
+    // Strikes span spot * [1 - strike_range, 1 + strike_range]
+    double strike_range = 0.5;
+
+    // iv(K) = iv_atm + iv_skew * m + iv_smile * m^2 + noise, m = ln(K / spot)
+    double iv_atm = 0.30;
+    double iv_skew = -0.20;
+    double iv_smile = 0.50;
+    double iv_noise = 0.02;
+
+    // Quoted bid/ask spread as a fraction of the option price
+    double spread = 0.04;
+    uint64_t seed = 42;
+};
+
+namespace synthetic_detail {
+
+inline double norm_pdf(double x) { return std::exp(-0.5 * x * x) / std::sqrt(2.0 * M_PI); }
+inline double norm_cdf(double x) { return 0.5 * std::erfc(-x / std::sqrt(2.0)); }
+
+inline std::string date_in_days(size_t days) {
+    std::time_t t = std::chrono::system_clock::to_time_t(
+        std::chrono::system_clock::now() + std::chrono::hours(24 * days));
+    std::tm tm = *std::localtime(&t);
+    char buf[16];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%d", &tm);
+    return buf;
+}
+
+}  // namespace synthetic_detail
+
+inline std::string make_synthetic_snapshot_json(const SyntheticChainParams& p, const std::string& symbol = "SYN") {
+    using namespace synthetic_detail;
+    std::mt19937_64 rng(p.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::lognormal_distribution<double> volume_dist(4.0, 1.2);
+    std::lognormal_distribution<double> oi_dist(6.0, 1.2);
+
+    const double S = p.spot;
+    const double k_lo = S * (1.0 - p.strike_range);
+    const double k_step = p.strikes_per_expiry > 1
+        ? 2.0 * S * p.strike_range / double(p.strikes_per_expiry - 1) : 0.0;
+
+    std::string out;
+    out.reserve(p.expiries * p.strikes_per_expiry * 2 * 330 + 256);
+    char buf[512];
+    std::snprintf(buf, sizeof(buf),
+        "{\"symbols\":[\"%s\"],\"underlying\":{\"last\":%.4f,\"bid\":%.4f,\"ask\":%.4f},\"chains\":{\"%s\":{",
+        symbol.c_str(), S, S - 0.01, S + 0.01, symbol.c_str());
+    out += buf;
+
+    for (size_t e = 0; e < p.expiries; ++e) {
+        const size_t days = (e + 1) * p.expiry_spacing_days;
+        const std::string expiry = date_in_days(days);
+        const double T = double(days) / 365.0;
+        out += (e ? ",\"" : "\"") + expiry + "\":[";
+
+        for (size_t k = 0; k < p.strikes_per_expiry; ++k) {
+            const double K = std::round((k_lo + k_step * double(k)) * 100.0) / 100.0;
+            const double m = std::log(K / S);
+            for (int is_call = 1; is_call >= 0; --is_call) {
+                double iv = p.iv_atm + p.iv_skew * m + p.iv_smile * m * m + p.iv_noise * (2.0 * unit(rng) - 1.0);
+                iv = std::max(iv, 0.01);
+
+                const double sd = iv * std::sqrt(T);
+                const double d1 = (std::log(S / K) + 0.5 * iv * iv * T) / sd;
+                const double d2 = d1 - sd;
+                const double price = is_call ? S * norm_cdf(d1) - K * norm_cdf(d2)
+                                             : K * norm_cdf(-d2) - S * norm_cdf(-d1);
+                const double delta = is_call ? norm_cdf(d1) : norm_cdf(d1) - 1.0;
+                const double gamma = norm_pdf(d1) / (S * sd);
+                const double vega = S * norm_pdf(d1) * std::sqrt(T) / 100.0;
+                const double theta = -S * norm_pdf(d1) * iv / (2.0 * std::sqrt(T)) / 365.0;
+                const double rho = (is_call ? K * T * norm_cdf(d2) : -K * T * norm_cdf(-d2)) / 100.0;
+
+                const double mid = std::max(price, 0.01);
+                const double half = std::max(mid * p.spread / 2.0, 0.005);
+
+                std::snprintf(buf, sizeof(buf),
+                    "%s{\"symbol\":\"%s%s%c%.2f\",\"strike\":%.2f,\"option_type\":\"%s\",\"expiration_date\":\"%s\","
+                    "\"bid\":%.2f,\"ask\":%.2f,\"last\":%.2f,\"volume\":%.0f,\"open_interest\":%.0f,"
+                    "\"greeks\":{\"delta\":%.6f,\"gamma\":%.6f,\"theta\":%.6f,\"vega\":%.6f,\"rho\":%.6f,\"mid_iv\":%.6f}}",
+                    (k || !is_call) ? "," : "", symbol.c_str(), expiry.c_str(), is_call ? 'C' : 'P', K, K,
+                    is_call ? "call" : "put", expiry.c_str(),
+                    std::max(mid - half, 0.0), mid + half, mid,
+                    std::floor(volume_dist(rng)), std::floor(oi_dist(rng)),
+                    delta, gamma, theta, vega, rho, iv);
+                out += buf;
+            }
+        }
+        out += "]";
+    }
+    out += "}}}";
+    return out;
+}
+
+#endif // SYNTHETIC_CHAIN_HPP
@@ -1,75 +1,656 @@
 #include "loader.hpp"
+#include "batch.hpp"
+#include "shard.hpp"
+#include "resident.hpp"
+#include "ingest.hpp"
+#include "archive.hpp"
 #include "factory/factory.hpp"
+#include "factory/pricing.hpp"
 #include "config.hpp"
-#include <iostream>
+#include "result_writer.hpp"
+#include "memory.hpp"
+#include "stats.hpp"
+#include <cstdio>
+#include <chrono>
+#include <ctime>
 #include <fstream>
+#include <iostream>
 #include <filesystem>
+#include <stdexcept>
+#include <optional>
+#include <string>
 #include <vector>
-#include <json.hpp>
 
-using json = nlohmann::json;
+static void print_usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " [config.json] [data_file]" << std::endl;
+    std::cerr << "       " << argv0 << " config.json --batch <snapshot_dir|manifest>" << std::endl;
+    std::cerr << "       " << argv0 << " config.json --shard=i/N <snapshot_dir|manifest> --output=part" << SHARD_EXTENSION
+              << std::endl;
+    std::cerr << "       " << argv0 << " config.json --merge part" << SHARD_EXTENSION << "..." << std::endl;
+    std::cerr << "       " << argv0 << " config.json data_file --serve   (quote updates as NDJSON on stdin)" << std::endl;
+    std::cerr << "       " << argv0 << " config.json --ingest [stream|-]  (snapshot lines, e.g. tradier.py --stream)" << std::endl;
+    std::cerr << "       " << argv0 << " config.json --replay archive" << ARCHIVE_EXTENSION
+              << " [--symbol=SYM] [--from=time] [--to=time]" << std::endl;
+    std::cerr << "  --stats[=file]  stage timings and filter counters as JSON (stderr by default)" << std::endl;
+    std::cerr << "  --memory        count allocations per stage and generator into --stats (implies --stats)" << std::endl;
+    std::cerr << "  --format=text|csv|ndjson|binary  result format (default text)" << std::endl;
+    std::cerr << "  --output=file   write csv, ndjson or binary results to file instead of stdout" << std::endl;
+    std::cerr << "  --scenarios=file  P&L of the results under the config's scenario grid, as CSV" << std::endl;
+    std::cerr << "  --page=N [--after=token]  N results after token instead of the top_n; the next page's" << std::endl;
+    std::cerr << "                  token goes to stderr" << std::endl;
+}
+
+// A --page=N size: a positive integer
+static size_t parse_page_size(const std::string& text) {
+    size_t used = 0;
+    unsigned long long size = 0;
+    try {
+        size = std::stoull(text, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used == 0 || used != text.size() || size == 0 || text[0] == '-') {
+        throw std::runtime_error("invalid --page size '" + text + "'");
+    }
+    return size_t(size);
+}
+
+// Where csv, ndjson and binary results go: stdout, or a file closed on
+// destruction
+class ResultOutput {
+public:
+    explicit ResultOutput(const std::string& path)
+        : file_(path.empty() ? stdout : std::fopen(path.c_str(), "wb")), owned_(!path.empty()) {
+        if (!file_) {
+            throw std::runtime_error("Cannot open output file: " + path);
+        }
+    }
+
+    ~ResultOutput() {
+        if (owned_) std::fclose(file_);
+    }
+
+    ResultOutput(const ResultOutput&) = delete;
+    ResultOutput& operator=(const ResultOutput&) = delete;
+
+    std::FILE* file() const { return file_; }
+
+private:
+    std::FILE* file_;
+    bool owned_;
+};
+
+// Screens every snapshot of a directory or manifest and prints one ranking;
+// with a machine-readable format the summary goes to stderr
+static int run_batch_mode(const ScreenerConfig& config, const std::string& batch_path,
+                          ResultFormat format, const std::string& output_path) {
+    if (!std::filesystem::exists(batch_path)) {
+        std::cerr << "Error: Batch input not found: " << batch_path << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> inputs = list_batch_inputs(batch_path);
+    BatchResult results = run_batch(config, inputs);
+
+    for (const BatchFailure& failure : results.failures) {
+        std::cerr << "Warning: Skipped " << failure.path << ": " << failure.error << std::endl;
+    }
+
+    if (format != ResultFormat::TEXT) {
+        std::cerr << "Screened " << results.screened << " of " << inputs.size() << " snapshots, "
+                  << results.strategies.size() << " strategies" << std::endl;
+        ResultOutput output(output_path);
+        ResultWriter writer(output.file(), format);
+        results.write(writer);
+        writer.flush();
+        return 0;
+    }
+
+    std::cout << "Screened " << results.screened << " of " << inputs.size() << " snapshots" << std::endl;
+    std::cout << "Found " << results.strategies.size() << " strategies" << std::endl;
+    std::cout << "Ranked by: " << config.rank_key << std::endl;
+    std::cout << "----------------------------------------" << std::endl;
+    results.print();
+    return 0;
+}
+
+// Screens one shard of a batch and writes its partial for --merge
+static int run_shard_mode(const ScreenerConfig& config, const std::string& config_path, ShardSpec spec,
+                          const std::string& batch_path, const std::string& output_path) {
+    if (!std::filesystem::exists(batch_path)) {
+        std::cerr << "Error: Batch input not found: " << batch_path << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> inputs = list_batch_inputs(batch_path);
+    ShardPartial partial = run_shard(config, inputs, spec, config_fingerprint(config_path));
+    write_shard(partial, output_path);
+
+    std::cerr << "Shard " << spec.index << "/" << spec.count << ": " << partial.units << " units of "
+              << inputs.size() << " snapshots, " << partial.strategies.size() << " strategies" << std::endl;
+    return 0;
+}
+
+// Ranks the partials of every shard of a batch together and prints or
+// writes them like --batch; --stats lists each shard's stats
+static int run_merge_mode(const ScreenerConfig& config, const std::string& config_path,
+                          const std::vector<std::string>& shard_paths, ResultFormat format,
+                          const std::string& output_path, bool want_stats, const std::string& stats_path) {
+    std::vector<ShardPartial> partials;
+    for (const std::string& path : shard_paths) {
+        partials.push_back(read_shard(path));
+    }
+    if (partials.front().config_hash != config_fingerprint(config_path)) {
+        std::cerr << "Error: Shards were screened with a different config than " << config_path << std::endl;
+        return 1;
+    }
+    BatchResult results = merge_shards(config, partials);
+
+    for (const BatchFailure& failure : results.failures) {
+        std::cerr << "Warning: Skipped " << failure.path << ": " << failure.error << std::endl;
+    }
+    if (want_stats) {
+        std::string list = "[";
+        for (const ShardPartial& p : partials) {
+            list += (list.size() > 1 ? "," : "") + p.stats_json;
+        }
+        list += "]";
+        if (stats_path.empty()) {
+            std::cerr << list << std::endl;
+        } else {
+            std::ofstream out(stats_path);
+            out << list << std::endl;
+            if (!out) {
+                std::cerr << "Error: Cannot write stats file: " << stats_path << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    const size_t inputs = partials.front().inputs.size();
+    if (format != ResultFormat::TEXT) {
+        std::cerr << "Merged " << partials.size() << " shards: screened " << results.screened << " of " << inputs
+                  << " snapshots, " << results.strategies.size() << " strategies" << std::endl;
+        ResultOutput output(output_path);
+        ResultWriter writer(output.file(), format);
+        results.write(writer);
+        writer.flush();
+        return 0;
+    }
+
+    std::cout << "Merged " << partials.size() << " shards" << std::endl;
+    std::cout << "Screened " << results.screened << " of " << inputs << " snapshots" << std::endl;
+    std::cout << "Found " << results.strategies.size() << " strategies" << std::endl;
+    std::cout << "Ranked by: " << config.rank_key << std::endl;
+    std::cout << "----------------------------------------" << std::endl;
+    results.print();
+    return 0;
+}
+
+// Screens a chain as it streams in, one snapshot line per expiration, from
+// a file or pipe (stdin for "-"); with a machine-readable format the summary
+// goes to stderr
+static int run_ingest_mode(const ScreenerConfig& config, const std::string& stream_path,
+                           ResultFormat format, const std::string& output_path) {
+    std::ifstream file;
+    if (stream_path != "-") {
+        file.open(stream_path);
+        if (!file) {
+            std::cerr << "Error: Cannot open stream: " << stream_path << std::endl;
+            return 1;
+        }
+    }
+    std::istream& in = stream_path == "-" ? std::cin : file;
+
+    IngestScreener screener(config);
+    std::string line;
+    while (std::getline(in, line)) {
+        screener.push(line);
+    }
+
+    // Only what is left once the last expiration is in: the last
+    // expiries' screens, calendars and diagonals, and the merge
+    auto finish_start = std::chrono::steady_clock::now();
+    StrategyList results = screener.finish();
+    auto finish_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - finish_start);
+
+    std::ostream& summary = format == ResultFormat::TEXT ? std::cout : std::cerr;
+    summary << "Ingested " << screener.expiries() << " expirations, " << screener.rows() << " contracts; "
+            << finish_ms.count() << " ms after end of input" << std::endl;
+
+    if (format != ResultFormat::TEXT) {
+        ResultOutput output(output_path);
+        ResultWriter writer(output.file(), format);
+        results.write(writer);
+        writer.flush();
+        return 0;
+    }
+
+    std::cout << "Found " << results.size() << " strategies" << std::endl;
+    std::cout << "Ranked by: " << config.rank_key << std::endl;
+    std::cout << "----------------------------------------" << std::endl;
+    results.print();
+    return 0;
+}
+
+// Seconds since the epoch of "1700000000", "2025-10-31" or
+// "2025-10-31T15:30[:00]", the latter UTC
+static double parse_replay_time(const std::string& text) {
+    std::tm tm{};
+    const char* end = nullptr;
+    for (const char* format : {"%Y-%m-%dT%H:%M:%S", "%Y-%m-%dT%H:%M", "%Y-%m-%d"}) {
+        tm = std::tm{};
+        end = strptime(text.c_str(), format, &tm);
+        if (end && *end == '\0') return double(timegm(&tm));
+    }
+    size_t used = 0;
+    double seconds = 0.0;
+    try {
+        seconds = std::stod(text, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used == 0 || used != text.size()) {
+        throw std::runtime_error("Invalid replay time: " + text);
+    }
+    return seconds;
+}
+
+struct ReplayRange {
+    std::string symbol;  // empty: every symbol
+    std::optional<double> from;
+    std::optional<double> to;
+};
+
+// Screens every archived snapshot in range, each symbol's in time order.
+// Consecutive snapshots with the same strikes share one ChainLayout, so only
+// the quotes are decoded and filtered again. Text output ranks each snapshot
+// under its own heading; csv, ndjson and binary rows are the snapshots'
+// rankings one after another, in that order.
+static int run_replay_mode(const ScreenerConfig& config, const std::string& archive_path,
+                           const ReplayRange& range, ResultFormat format, const std::string& output_path) {
+    if (!std::filesystem::exists(archive_path)) {
+        std::cerr << "Error: Archive not found: " << archive_path << std::endl;
+        return 1;
+    }
+
+    const ArchiveReader reader(archive_path);
+    std::optional<ResultOutput> output;
+    std::optional<ResultWriter> writer;
+    if (format != ResultFormat::TEXT) {
+        output.emplace(output_path);
+        writer.emplace(output->file(), format);
+    }
+
+    ArchiveSnapshot snapshot;
+    std::optional<ChainLayout> layout;
+    size_t screened = 0;
+    size_t layouts = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t e = 0; e < reader.entries().size(); ++e) {
+        const ArchiveEntry& entry = reader.entries()[e];
+        if (!range.symbol.empty() && reader.symbols()[entry.symbol_id] != range.symbol) continue;
+        if ((range.from && entry.timestamp < *range.from) || (range.to && entry.timestamp > *range.to)) continue;
+
+        if (!reader.read(e, snapshot) || !layout) {
+            layout.emplace(snapshot.chain);
+            ++layouts;
+        }
+        const OptionChain& chain = snapshot.chain;
+        if (!snapshot.spot.has_value()) {
+            std::cerr << "Warning: Skipped " << chain.symbol << " at " << std::fixed << snapshot.timestamp
+                      << std::defaultfloat << ": no spot price" << std::endl;
+            continue;
+        }
+        if (config.pricing.has_value()) price_chain(snapshot.chain, snapshot.spot.value(), *config.pricing);
+
+        StrategyFactory factory(chain, snapshot.spot.value(), config.threads);
+        factory.use_layout(&*layout);
+        StrategyList results =
+            config.pareto.empty()
+                ? factory.top(config.strategy_filter, config.config_filter, config.rank_key, config.top_n)
+                : factory.pareto_top(config.strategy_filter, config.config_filter, config.pareto, config.rank_key,
+                                     config.top_n);
+        ++screened;
+
+        if (writer) {
+            results.write(*writer);
+            continue;
+        }
+        const std::time_t t = std::time_t(snapshot.timestamp);
+        std::tm tm{};
+        gmtime_r(&t, &tm);
+        char when[32];
+        std::strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S UTC", &tm);
+        std::cout << "== " << chain.symbol << " " << when << " (spot " << snapshot.spot.value() << "): "
+                  << results.size() << " strategies" << std::endl;
+        std::cout << "----------------------------------------" << std::endl;
+        results.print();
+    }
+    if (writer) writer->flush();
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+    std::ostream& summary = format == ResultFormat::TEXT ? std::cout : std::cerr;
+    summary << "Replayed " << screened << " snapshots with " << layouts << " chain layouts, ranked by "
+            << config.rank_key << "; " << elapsed.count() << " ms" << std::endl;
+    return 0;
+}
+
+// Keeps the chain and its candidate strategies resident and re-screens after
+// every line of quote updates read from stdin
+static int run_serve_mode(const ScreenerConfig& config, OptionChain chain, double spot) {
+    ResidentScreener screener(std::move(chain), spot, config);
+
+    std::cout << "Resident screen: " << screener.candidates() << " candidates, "
+              << screener.passing() << " passing" << std::endl;
+    std::cout << "Ranked by: " << config.rank_key << std::endl;
+    std::cout << "----------------------------------------" << std::endl;
+    screener.top().print();
+    if (screener.ambiguous_contracts() > 0) {
+        std::cerr << "Warning: " << screener.ambiguous_contracts()
+                  << " contract(s) share an expiry, strike and side with another row; their updates are ignored"
+                  << std::endl;
+    }
+
+    std::string line;
+    size_t tick = 0;
+    while (std::getline(std::cin, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+        // A bad line is reported and skipped; the session keeps running
+        std::vector<QuoteUpdate> updates;
+        try {
+            updates = parse_quote_updates(line);
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: Ignored update line: " << e.what() << std::endl;
+            continue;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        RescreenStats stats = screener.apply(updates);
+        auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+
+        if (stats.unknown > 0) {
+            std::cerr << "Warning: " << stats.unknown << " update(s) for contracts not in the chain" << std::endl;
+        }
+        if (stats.ambiguous > 0) {
+            std::cerr << "Warning: " << stats.ambiguous << " update(s) match several rows and were ignored" << std::endl;
+        }
+        std::cout << "Tick " << ++tick << ": " << stats.quotes << " quotes, " << stats.rescored
+                  << " strategies rescored in " << elapsed.count() << " us, "
+                  << screener.passing() << " passing" << std::endl;
+        std::cout << "----------------------------------------" << std::endl;
+        screener.top().print();
+    }
+    return 0;
+}
 
 int main(int argc, char* argv[]) {
     try {
+        const char* argv0 = argc > 0 ? argv[0] : "option_screener";
+
+        // --stats[=file], --format=... and --output=... may appear anywhere;
+        // the rest is positional
+        bool want_stats = false;
+        bool want_memory = false;
+        std::string stats_path;
+        ResultFormat format = ResultFormat::TEXT;
+        std::string output_path;
+        std::string scenarios_path;
+        std::optional<ShardSpec> shard;
+        std::optional<size_t> page_size;
+        std::optional<PageCursor> page_after;
+        ReplayRange range;
+        std::vector<char*> args;
+        for (int i = 0; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (i > 0 && (arg == "--stats" || arg.rfind("--stats=", 0) == 0)) {
+                want_stats = true;
+                stats_path = arg.size() > 8 ? arg.substr(8) : "";
+            } else if (i > 0 && arg == "--memory") {
+                want_stats = true;
+                want_memory = true;
+            } else if (i > 0 && arg.rfind("--format=", 0) == 0) {
+                format = parse_result_format(arg.substr(9));
+            } else if (i > 0 && arg.rfind("--output=", 0) == 0) {
+                output_path = arg.substr(9);
+            } else if (i > 0 && arg.rfind("--scenarios=", 0) == 0) {
+                scenarios_path = arg.substr(12);
+            } else if (i > 0 && arg.rfind("--shard=", 0) == 0) {
+                shard = ShardSpec::parse(arg.substr(8));
+            } else if (i > 0 && arg.rfind("--page=", 0) == 0) {
+                page_size = parse_page_size(arg.substr(7));
+            } else if (i > 0 && arg.rfind("--after=", 0) == 0) {
+                page_after = PageCursor::parse(arg.substr(8));
+            } else if (i > 0 && arg.rfind("--symbol=", 0) == 0) {
+                range.symbol = arg.substr(9);
+            } else if (i > 0 && arg.rfind("--from=", 0) == 0) {
+                range.from = parse_replay_time(arg.substr(7));
+            } else if (i > 0 && arg.rfind("--to=", 0) == 0) {
+                range.to = parse_replay_time(arg.substr(5));
+            } else {
+                args.push_back(argv[i]);
+            }
+        }
+        argc = static_cast<int>(args.size());
+        argv = args.data();
+
         // Get config file path (default: config.json)
         std::string config_path = "config.json";
         std::string data_path;
+        std::string batch_path;
+        std::string stream_path;
+        std::string archive_path;
+        std::vector<std::string> shard_paths;
+        bool serve = false;
         
         if (argc > 1) {
             config_path = argv[1];
         }
         if (argc > 2) {
-            data_path = argv[2];
+            if (std::string(argv[2]) == "--batch") {
+                if (argc < 4) {
+                    print_usage(argv0);
+                    return 1;
+                }
+                batch_path = argv[3];
+            } else if (std::string(argv[2]) == "--merge") {
+                if (argc < 4) {
+                    print_usage(argv0);
+                    return 1;
+                }
+                shard_paths.assign(argv + 3, argv + argc);
+            } else if (std::string(argv[2]) == "--ingest") {
+                stream_path = argc > 3 ? argv[3] : "-";
+            } else if (std::string(argv[2]) == "--replay") {
+                if (argc < 4) {
+                    print_usage(argv0);
+                    return 1;
+                }
+                archive_path = argv[3];
+            } else {
+                data_path = argv[2];
+                serve = argc > 3 && std::string(argv[3]) == "--serve";
+            }
+        }
+
+        if (shard.has_value()) {
+            // --shard=i/N takes the batch input as its one positional argument
+            if (data_path.empty() || serve || output_path.empty()) {
+                std::cerr << "Error: --shard needs <snapshot_dir|manifest> and --output=part" << SHARD_EXTENSION
+                          << std::endl;
+                return 1;
+            }
+        }
+        if (!output_path.empty() && format == ResultFormat::TEXT && !shard.has_value()) {
+            std::cerr << "Error: --output needs --format=csv, ndjson or binary" << std::endl;
+            return 1;
+        }
+
+        if (page_after.has_value() && !page_size.has_value()) {
+            std::cerr << "Error: --after needs --page=N" << std::endl;
+            return 1;
         }
 
         // Check if config file exists
         if (!std::filesystem::exists(config_path)) {
             std::cerr << "Error: Config file not found: " << config_path << std::endl;
-            std::cerr << "Usage: " << (argc > 0 ? argv[0] : "option_screener") << " [config.json] [data_file]" << std::endl;
+            print_usage(argv0);
+            return 1;
+        }
+
+        // Filters, ranking and threads, parsed once
+        ScreenerConfig config = ConfigLoader::load(config_path);
+
+        // Allocations are counted from here on; a budget applies to every mode
+        if (want_memory || config.memory_budget != 0) {
+            memory::enable();
+            memory::set_budget(config.memory_budget);
+        }
+
+        if (shard.has_value()) {
+            if (want_stats || format != ResultFormat::TEXT) {
+                std::cerr << "Warning: a shard's stats and results go into its partial; --stats and --format ignored"
+                          << std::endl;
+            }
+            return run_shard_mode(config, config_path, shard.value(), data_path, output_path);
+        }
+        if (!shard_paths.empty()) {
+            return run_merge_mode(config, config_path, shard_paths, format, output_path, want_stats, stats_path);
+        }
+
+        if (want_stats && (serve || !batch_path.empty() || !stream_path.empty() || !archive_path.empty())) {
+            std::cerr << "Warning: --stats only applies to a single screen; ignored" << std::endl;
+            want_stats = false;
+        }
+        if (!scenarios_path.empty() && !config.scenarios.has_value()) {
+            std::cerr << "Error: --scenarios needs a \"scenarios\" section in the config" << std::endl;
+            return 1;
+        }
+        if (!scenarios_path.empty() && (serve || !batch_path.empty() || !stream_path.empty() || !archive_path.empty())) {
+            std::cerr << "Warning: --scenarios only applies to a single screen; ignored" << std::endl;
+            scenarios_path.clear();
+        }
+        if (!config.pareto.empty() && (serve || !stream_path.empty())) {
+            std::cerr << "Warning: \"ranking.pareto\" does not apply to --serve or --ingest; ignored" << std::endl;
+        }
+        if (page_size.has_value() && (serve || !batch_path.empty() || !stream_path.empty() || !archive_path.empty())) {
+            std::cerr << "Warning: --page only applies to a single screen; ignored" << std::endl;
+            page_size.reset();
+        }
+        if (page_size.has_value() && !config.pareto.empty()) {
+            std::cerr << "Error: --page does not apply with \"ranking.pareto\"" << std::endl;
             return 1;
         }
+        if (format != ResultFormat::TEXT && serve) {
+            std::cerr << "Warning: --format and --output only apply to a single or batch screen; ignored" << std::endl;
+            format = ResultFormat::TEXT;
+        }
+
+        if (!batch_path.empty()) {
+            return run_batch_mode(config, batch_path, format, output_path);
+        }
+        if (!stream_path.empty()) {
+            return run_ingest_mode(config, stream_path, format, output_path);
+        }
+        if (!archive_path.empty()) {
+            return run_replay_mode(config, archive_path, range, format, output_path);
+        }
 
         // Check if data file exists
         if (data_path.empty() || !std::filesystem::exists(data_path)) {
             std::cerr << "Error: Data file not found: " << (data_path.empty() ? "(not provided)" : data_path) << std::endl;
-            std::cerr << "Usage: " << (argc > 0 ? argv[0] : "option_screener") << " [config.json] [data_file]" << std::endl;
+            print_usage(argv0);
             return 1;
         }
 
-        // Load filters from config
-        StrategyFilter s_filter = ConfigLoader::load_strategy_filter_from_json(config_path);
-        ConfigFilter c_filter = ConfigLoader::load_from_json(config_path);
-        
-        // Load config JSON for ranking settings
-        json config_json;
-        {
-            std::ifstream config_file(config_path);
-            config_json = json::parse(config_file);
-        }
+        ScreenStats stats_storage;
+        ScreenStats* stats = want_stats ? &stats_storage : nullptr;
+        if (stats) stats->memory = want_memory;
+
+        // Load options and spot (binary snapshot or Tradier JSON, by extension).
+        // A one-off screen drops options failing the option-level filters
+        // while loading; --serve keeps them, as updates can make them pass.
+        auto [chain, spot] = [&] {
+            StageTimer timer(stats, "load");
+            return serve ? load_snapshot(data_path)
+                         : load_snapshot(data_path, config.config_filter, stats ? &stats->options() : nullptr);
+        }();
 
-        // Load options and spot
-        auto [options, spot] = load_option_snapshot(data_path);
-        
         if (!spot.has_value()) {
             std::cerr << "Error: Could not determine spot price" << std::endl;
             return 1;
         }
 
+        if (serve) {
+            return run_serve_mode(config, std::move(chain), spot.value());
+        }
+
+        if (config.pricing.has_value()) {
+            StageTimer timer(stats, "pricing");
+            price_chain(chain, spot.value(), *config.pricing, stats ? &stats->pricing() : nullptr);
+        }
+
         // Create factory and generate strategies
-        StrategyFactory factory(options, spot.value());
-        
-        // Get ranking parameters from config
-        auto ranking = config_json["ranking"];
-        std::string rank_key = ranking["key"].get<std::string>();
-        size_t top_n = ranking["top_n"].get<size_t>();
+        StrategyFactory factory(chain, spot.value(), config.threads);
 
-        // Generate, rank, and get top strategies
-        auto results = factory.strategy(s_filter, c_filter).rank(rank_key).top(top_n);
+        // Generate and keep only the top strategies (or the page) while ranking
+        std::optional<PageCursor> next_page;
+        auto results = [&] {
+            if (page_size.has_value()) {
+                StrategyPage page = factory.page(config.strategy_filter, config.config_filter, config.rank_key,
+                                                 *page_size, page_after, true, stats);
+                next_page = page.next;
+                return std::move(page.strategies);
+            }
+            return config.pareto.empty()
+                       ? factory.top(config.strategy_filter, config.config_filter, config.rank_key, config.top_n,
+                                     true, stats)
+                       : factory.pareto_top(config.strategy_filter, config.config_filter, config.pareto,
+                                            config.rank_key, config.top_n, true, stats);
+        }();
 
-        std::cout << "Found " << results.size() << " strategies" << std::endl;
-        std::cout << "Ranked by: " << rank_key << std::endl;
-        std::cout << "----------------------------------------" << std::endl;
-        results.print();
+        if (format != ResultFormat::TEXT) {
+            StageTimer timer(stats, "write");
+            ResultOutput output(output_path);
+            ResultWriter writer(output.file(), format);
+            results.write(writer);
+            writer.flush();
+        } else {
+            StageTimer timer(stats, "print");
+            std::cout << "Found " << results.size() << " strategies" << std::endl;
+            std::cout << "Ranked by: " << config.rank_key << std::endl;
+            std::cout << "----------------------------------------" << std::endl;
+            results.print();
+            std::cout.flush();
+        }
+
+        if (page_size.has_value()) {
+            if (next_page.has_value()) {
+                std::cerr << "Next page: --after=" << next_page->to_string() << std::endl;
+            } else {
+                std::cerr << "Last page" << std::endl;
+            }
+        }
+
+        if (!scenarios_path.empty()) {
+            ScenarioMatrix matrix = factory.scenarios(results, config.scenarios.value(), stats);
+            ResultOutput out(scenarios_path);
+            matrix.write_csv(out.file(), results);
+        }
+
+        if (stats) {
+            if (stats_path.empty()) {
+                std::cerr << stats->to_json() << std::endl;
+            } else {
+                std::ofstream out(stats_path);
+                out << stats->to_json(2) << std::endl;
+                if (!out) {
+                    std::cerr << "Error: Cannot write stats file: " << stats_path << std::endl;
+                    return 1;
+                }
+            }
+        }
 
         return 0;
     } catch (const std::exception& e) {
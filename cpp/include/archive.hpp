@@ -0,0 +1,182 @@
+#ifndef ARCHIVE_HPP
+#define ARCHIVE_HPP
+
+#include "chain.hpp"
+#include "mapped_file.hpp"
+#include "snapshot.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+// ===================== SNAPSHOT ARCHIVE FORMAT =====================
+// Many snapshots (symbols x timestamps) in one append-only file, for replay.
+//
+// Layout (little-endian, every section 8-byte aligned):
+//   ArchiveHeader, with the offset of the current footer
+//   blocks, one per snapshot, never moved once written
+//   index: symbol table, then ArchiveEntry[entry_count] by (symbol, timestamp)
+//   ArchiveFooter
+//
+// An append writes its blocks after the current footer, then a new index
+// and footer, and only then points the header at the new footer. Until that
+// last 8-byte write the header still names the old index, so an append cut
+// short by a crash or a full disk loses only its own snapshots; the next
+// append writes over whatever it left. Each append leaves the previous index
+// behind as dead space.
+//
+// A block is an ArchiveBlockHeader and one ArchiveColumnHeader plus payload
+// per SnapshotColumn. Each column is stored in whichever of these is
+// smaller and exact:
+//   RAW     the doubles as they are
+//   SCALED  q = v * 10^decimals as integers, zigzag delta varints in row
+//           order, used only if q / 10^decimals gives back every v exactly;
+//           NaNs (missing bid/ask) are a bitmap ahead of the varints
+// so strikes sorted within an expiry cost a byte or two, prices are
+// quantized to cents, and no value changes.
+//
+// The strike, expiry id and side columns and the expiry table are the
+// block's structure. A block whose structure equals that of the symbol's
+// latest block points at that block instead of storing it again, and
+// consecutive snapshots that share a structure can share one ChainLayout.
+constexpr char ARCHIVE_MAGIC[8] = {'O', 'A', 'R', 'C', 'H', 'I', 'V', '\0'};
+constexpr uint32_t ARCHIVE_VERSION = 2;
+constexpr uint32_t ARCHIVE_BYTE_ORDER = 0x01020304;
+constexpr const char* ARCHIVE_EXTENSION = ".oarch";
+
+struct ArchiveHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t footer_offset;  // 0 until the first index is written
+};
+
+struct ArchiveFooter {
+    uint64_t index_offset;
+    uint32_t entry_count;
+    uint32_t symbol_count;
+    uint32_t version;
+    uint32_t byte_order;
+    char magic[8];
+};
+
+struct ArchiveEntry {
+    double timestamp;         // seconds since the epoch
+    uint64_t block_offset;
+    uint64_t structure_offset;  // block holding the structure; block_offset if its own
+    uint32_t symbol_id;       // into the symbol table
+    uint32_t row_count;
+};
+
+struct ArchiveBlockHeader {
+    uint32_t row_count;
+    uint32_t expiry_count;
+    uint32_t has_spot;
+    uint32_t has_structure;  // 0: structure columns and expiries are in the block at structure_offset
+    double spot;
+    double timestamp;
+    uint64_t block_bytes;    // header included
+};
+
+enum ArchiveEncoding : uint8_t {
+    ENC_RAW,
+    ENC_SCALED,
+};
+
+struct ArchiveColumnHeader {
+    uint8_t encoding;
+    uint8_t decimals;     // SCALED by 10^decimals
+    uint8_t has_missing;  // SCALED: a NaN bitmap precedes the varints
+    uint8_t padding[5];
+    uint64_t bytes;       // payload, before 8-byte alignment
+};
+
+static_assert(sizeof(ArchiveHeader) == 24, "ArchiveHeader layout is part of the format");
+static_assert(sizeof(ArchiveFooter) == 32, "ArchiveFooter layout is part of the format");
+static_assert(sizeof(ArchiveEntry) == 32, "ArchiveEntry layout is part of the format");
+static_assert(sizeof(ArchiveBlockHeader) == 40, "ArchiveBlockHeader layout is part of the format");
+static_assert(sizeof(ArchiveColumnHeader) == 16, "ArchiveColumnHeader layout is part of the format");
+
+// ===================== ARCHIVE WRITER =====================
+// Opens path for appending, creating it if needed. New blocks go after the
+// current footer; the new index and footer are written, synced and committed
+// to the header by close() (or the destructor, which ignores errors), so
+// until then readers see the archive as it was.
+class ArchiveWriter {
+public:
+    explicit ArchiveWriter(const std::string& path);
+    ~ArchiveWriter();
+
+    ArchiveWriter(const ArchiveWriter&) = delete;
+    ArchiveWriter& operator=(const ArchiveWriter&) = delete;
+
+    // Adds chain as the snapshot of chain.symbol at timestamp; returns the
+    // block's size in bytes
+    size_t append(const OptionChain& chain, std::optional<double> spot, double timestamp);
+
+    void close();
+
+    size_t entries() const { return entries_.size(); }
+
+private:
+    // Structure columns of a symbol's latest block, to detect a repeat
+    struct Structure {
+        double timestamp;
+        uint64_t offset;
+        std::vector<std::string> expiries;
+        std::vector<double> strike;
+        std::vector<uint16_t> expiry_id;
+        std::vector<Side> side;
+    };
+
+    uint32_t symbol_id(const std::string& symbol);
+    const Structure* latest_structure(uint32_t symbol);
+
+    std::string path_;
+    std::FILE* file_ = nullptr;
+    uint64_t end_ = 0;  // where the next block goes
+    bool dirty_ = false;  // the index on disk is missing entries_ or absent
+    std::vector<std::string> symbols_;
+    std::vector<ArchiveEntry> entries_;
+    std::map<uint32_t, Structure> latest_;
+};
+
+// ===================== ARCHIVE READER =====================
+// Read-only view of an archive through one mapping; blocks are decoded on
+// demand.
+struct ArchiveSnapshot {
+    OptionChain chain;
+    std::optional<double> spot;
+    double timestamp = 0.0;
+    uint64_t structure_offset = 0;  // structure the chain's strike, side and expiry columns hold
+};
+
+class ArchiveReader {
+public:
+    explicit ArchiveReader(const std::string& path);
+
+    const std::vector<std::string>& symbols() const { return symbols_; }
+
+    // By (symbol, timestamp)
+    const std::vector<ArchiveEntry>& entries() const { return entries_; }
+
+    // Decodes entry e into into. If into already holds that entry's
+    // structure (as after reading an entry that shares it), only the quote
+    // columns are decoded and true is returned. days_to_expiry counts from
+    // the snapshot's timestamp.
+    bool read(size_t e, ArchiveSnapshot& into) const;
+
+    // Where the committed footer starts
+    uint64_t footer_offset() const { return footer_offset_; }
+
+private:
+    MappedFile file_;
+    std::string path_;
+    uint64_t footer_offset_ = 0;
+    std::vector<std::string> symbols_;
+    std::vector<ArchiveEntry> entries_;
+};
+
+#endif // ARCHIVE_HPP
@@ -0,0 +1,57 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include "config.hpp"
+#include "result_writer.hpp"
+#include "strategy/strategy_class.hpp"
+#include <string>
+#include <vector>
+
+// ===================== BATCH SCREENING =====================
+// Screens many snapshots with one parsed config and ranks all symbols
+// together. Snapshots are loaded and screened concurrently, one per worker,
+// so at most config.threads chains are in memory at a time. Only each
+// symbol's top_n survive its screen, already formatted, so the combined
+// result does not keep any chain alive.
+struct ScreenedStrategy {
+    // A leg's contract, kept for the result writers
+    struct Leg {
+        Side side;
+        double strike;
+        std::string expiry;
+    };
+
+    size_t input;        // index into the batch inputs
+    std::string symbol;
+    std::string name;    // pretty() of the record against its chain
+    StrategyRecord record;
+    Leg legs[MAX_LEGS];
+
+    // Views into this strategy
+    ResultRow row() const;
+};
+
+struct BatchFailure {
+    std::string path;
+    std::string error;
+};
+
+struct BatchResult {
+    // Best first, across every symbol; ties keep input order, then the
+    // symbol's own ranking
+    std::vector<ScreenedStrategy> strategies;
+    std::vector<BatchFailure> failures;
+    size_t screened = 0;
+
+    void print() const;
+    void write(ResultWriter& writer) const;
+};
+
+// Snapshot files of a directory (.json and SNAPSHOT_EXTENSION, by name), or
+// the lines of a manifest file. Manifest paths are relative to the manifest;
+// blank lines and lines starting with '#' are skipped.
+std::vector<std::string> list_batch_inputs(const std::string& path);
+
+BatchResult run_batch(const ScreenerConfig& config, const std::vector<std::string>& inputs);
+
+#endif // BATCH_HPP
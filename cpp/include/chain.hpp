@@ -0,0 +1,64 @@
+#ifndef CHAIN_HPP
+#define CHAIN_HPP
+
+#include "object.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <optional>
+
+// ===================== OPTION CHAIN =====================
+// Column-wise option universe for one underlying. Row i is the option formed
+// by the i-th entry of every column; generators and filters refer to rows by
+// index instead of copying Option records around.
+//
+// Expiries are interned: each row stores a uint16_t id into `expiries`, and
+// days_to_expiry is kept once per expiry. Missing bid/ask are stored as NaN.
+struct OptionChain {
+    std::string symbol;
+
+    // Expiry table, indexed by expiry id
+    std::vector<std::string> expiries;
+    std::vector<int> expiry_days;
+
+    // Row columns
+    std::vector<double> strike;
+    std::vector<double> mid;
+    std::vector<double> iv;
+    std::vector<double> volume;
+    std::vector<double> oi;
+    std::vector<double> bid;
+    std::vector<double> ask;
+    std::vector<double> delta;
+    std::vector<double> gamma;
+    std::vector<double> theta;
+    std::vector<double> vega;
+    std::vector<double> rho;
+    std::vector<uint16_t> expiry_id;
+    std::vector<Side> side;
+
+    size_t size() const { return strike.size(); }
+    bool empty() const { return strike.empty(); }
+
+    void reserve(size_t n);
+
+    // Returns the id of `expiry`, adding it to the table if it is new
+    uint16_t intern_expiry(const std::string& expiry, int days_to_expiry);
+    std::optional<uint16_t> find_expiry(const std::string& expiry) const;
+
+    // Expiry ids ordered by expiry string
+    std::vector<uint16_t> expiry_order() const;
+
+    void push_back(const Option& opt);
+
+    // Materialize row i as a standalone Option
+    Option option(size_t i) const;
+
+    bool is_call(size_t i) const { return side[i] == Side::CALL; }
+    bool is_put(size_t i) const { return side[i] == Side::PUT; }
+    double price(size_t i) const { return mid[i] > 0.0 ? mid[i] : 0.0; }
+    int days_to_expiry(size_t i) const { return expiry_days[expiry_id[i]]; }
+    const std::string& expiry(size_t i) const { return expiries[expiry_id[i]]; }
+};
+
+#endif // CHAIN_HPP
@@ -2,13 +2,39 @@
 #define CONFIG_HPP
 
 #include "object.hpp"
+#include <cstdint>
 #include <string>
 #include <optional>
 
+// Everything in config.json, parsed once
+struct ScreenerConfig {
+    StrategyFilter strategy_filter;
+    ConfigFilter config_filter;
+    std::string rank_key;
+    size_t top_n = 0;
+    // Optional "ranking.pareto": RankOrder spec of the metrics whose Pareto
+    // front is ranked instead of every result; empty = off
+    std::string pareto;
+    // 0 = all hardware threads
+    size_t threads = 1;
+    // Optional "memory_budget_mb": live heap limit in bytes, 0 = none
+    uint64_t memory_budget = 0;
+    // Optional "scenarios" section, for the P&L grid of the results
+    std::optional<ScenarioGrid> scenarios;
+    // Optional "pricing" section: IV and greeks recomputed after loading
+    std::optional<PricingConfig> pricing;
+};
+
 class ConfigLoader {
 public:
+    static ScreenerConfig load(const std::string& path);
+    // Same, from the text of a config.json (for embedding callers)
+    static ScreenerConfig parse(const std::string& text);
+
     static ConfigFilter load_from_json(const std::string& path);
     static StrategyFilter load_strategy_filter_from_json(const std::string& path);
+    // Top-level "threads" (0 = all hardware threads); 1 when absent
+    static size_t load_threads_from_json(const std::string& path);
 };
 
 #endif // CONFIG_HPP
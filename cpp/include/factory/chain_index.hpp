@@ -0,0 +1,103 @@
+#ifndef CHAIN_INDEX_HPP
+#define CHAIN_INDEX_HPP
+
+#include "object.hpp"
+#include "chain.hpp"
+#include "stats.hpp"
+#include <cstdint>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+// ===================== EXPIRY SLICE =====================
+// Filtered rows of one expiry, split by side and sorted by strike. Ranges
+// are positions [begin, end) into calls or puts, found by binary search.
+struct ExpirySlice {
+    using Range = std::pair<size_t, size_t>;
+
+    uint16_t expiry_id;
+    std::pmr::vector<uint32_t> calls;
+    std::pmr::vector<uint32_t> puts;
+
+    // calls[otm_call_begin, end) have strike > spot
+    size_t otm_call_begin;
+    // puts[0, otm_put_end) have strike < spot
+    size_t otm_put_end;
+
+    // Whether |delta| is monotone in strike order, non-increasing for calls
+    // and non-decreasing for puts, so that delta ranges are contiguous
+    bool calls_delta_monotone = true;
+    bool puts_delta_monotone = true;
+
+    // Where sold legs may be picked under short_delta_range, the whole side
+    // without it. Every row inside qualifies if the side is delta-monotone;
+    // otherwise the range is the smallest holding every qualifying row.
+    Range short_calls{0, 0};
+    Range short_puts{0, 0};
+
+    const std::pmr::vector<uint32_t>& side(Side s) const { return s == Side::CALL ? calls : puts; }
+    bool delta_monotone(Side s) const { return s == Side::CALL ? calls_delta_monotone : puts_delta_monotone; }
+    Range short_range(Side s) const { return s == Side::CALL ? short_calls : short_puts; }
+
+    // Rows of side with lo <= strike <= hi
+    Range strike_range(const OptionChain& chain, Side s, double lo, double hi) const;
+    // Rows of side with lo <= strike / spot <= hi
+    Range moneyness_range(const OptionChain& chain, Side s, double spot, double lo, double hi) const;
+    // Rows of side with lo <= |delta| <= hi: O(log n) if the side is
+    // delta-monotone, else a scan giving the smallest range holding them
+    Range delta_range(const OptionChain& chain, Side s, double lo, double hi) const;
+};
+
+// ===================== CHAIN LAYOUT =====================
+// The quote-independent half of a ChainIndex: every row of each expiry, by
+// side, sorted by strike (stable), in expiry order. It depends only on the
+// strike, side and expiry columns, so one layout serves every snapshot that
+// shares them, whatever their quotes and filters.
+struct ChainLayout {
+    struct Expiry {
+        uint16_t expiry_id;
+        std::vector<uint32_t> calls;
+        std::vector<uint32_t> puts;
+    };
+
+    std::vector<Expiry> expiries;
+
+    explicit ChainLayout(const OptionChain& chain);
+};
+
+// ===================== CHAIN INDEX =====================
+// Immutable per-run view of a chain after the option-level filters, shared by
+// every generator so filtering, grouping and sorting happen once. Its arrays
+// are allocated from resource, which must outlive the index. A non-null stats
+// gets the option_filter and chain_index stages and the option counters.
+// Given a layout of the chain, grouping and sorting are skipped: the slices
+// are the layout's rows that pass the filters. Each slice's short ranges
+// answer cfg.short_delta_range.
+class ChainIndex {
+public:
+    ChainIndex(const OptionChain& chain, double spot, const ConfigFilter& cfg,
+               std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+               ScreenStats* stats = nullptr)
+        : ChainIndex(chain, spot, cfg, nullptr, resource, stats) {}
+
+    ChainIndex(const OptionChain& chain, double spot, const ConfigFilter& cfg, const ChainLayout* layout,
+               std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+               ScreenStats* stats = nullptr);
+
+    const OptionChain& chain() const { return chain_; }
+    double spot() const { return spot_; }
+
+    // Rows passing the option-level filters, in chain order
+    const std::pmr::vector<uint32_t>& rows() const { return rows_; }
+
+    // One slice per expiry with at least one passing row, in expiry order
+    const std::pmr::vector<ExpirySlice>& expiries() const { return expiries_; }
+
+private:
+    const OptionChain& chain_;
+    double spot_;
+    std::pmr::vector<uint32_t> rows_;
+    std::pmr::vector<ExpirySlice> expiries_;
+};
+
+#endif // CHAIN_INDEX_HPP
@@ -2,6 +2,15 @@
 #define FACTORY_HPP
 
 #include "object.hpp"
+#include "chain.hpp"
+#include "factory/strategy_level_filter.hpp"
+#include "factory/rank_order.hpp"
+#include "factory/pareto.hpp"
+#include "factory/run_arena.hpp"
+#include "factory/scenario.hpp"
+#include "factory/thread_pool.hpp"
+#include "result_writer.hpp"
+#include "stats.hpp"
 #include "strategy/generator_class.hpp"
 #include "strategy/strategy_class.hpp"
 #include <vector>
@@ -13,57 +22,180 @@
 #include <iomanip>
 #include <cmath>
 #include <cstdio>
+#include <cstdint>
+#include <functional>
+#include <deque>
+#include <memory_resource>
+#include <optional>
+#include <chrono>
+#include <numeric>
+#include <stdexcept>
+
+// ===================== TABLE OUTPUT =====================
+// Result table shared by StrategyList::print and batch output; a non-null
+// symbol adds a symbol column after the row number.
+inline void print_strategy_header(bool with_symbol = false) {
+    std::printf("%-5s ", "");
+    if (with_symbol) {
+        std::printf("%-8s ", "symbol");
+    }
+    std::printf("%-50s %12s %12s %12s %12s %18s %18s %18s %18s\n",
+                "strategy", "cost", "max_gain", "max_loss", "rr",
+                "delta", "theta", "vega", "iv");
+
+    // Print separator
+    std::cout << std::string(with_symbol ? 174 : 165, '-') << std::endl;
+}
+
+inline void print_strategy_row(size_t i, const std::string& name, const StrategyRecord& s,
+                               const char* symbol = nullptr) {
+    auto avg_iv = s.avg_iv();
+    double theta_val = s.net_theta;
+    // Use scientific notation for theta when very small or very large
+    bool use_scientific_theta = (std::abs(theta_val) < 0.001 && theta_val != 0.0) || 
+                               std::abs(theta_val) >= 1000.0;
+
+    // Print row number and strategy name
+    std::printf("%-5zu ", i);
+    if (symbol) {
+        std::printf("%-8s ", symbol);
+    }
+    std::printf("%-50s ", name.c_str());
+    
+    // Print cost
+    std::printf("%12.1f ", s.cost());
+    
+    // Print max_gain (infinity or number)
+    if (std::isinf(s.max_gain)) {
+        std::printf("%12s ", "inf");
+    } else {
+        std::printf("%12.1f ", s.max_gain);
+    }
+    
+    // Print max_loss (infinity or number)
+    if (std::isinf(s.max_loss)) {
+        std::printf("%12s ", "inf");
+    } else {
+        std::printf("%12.1f ", s.max_loss);
+    }
+    
+    // Print rr (infinity or number)
+    if (std::isinf(s.rr())) {
+        std::printf("%12s ", "inf");
+    } else {
+        std::printf("%12.2f ", s.rr());
+    }
+    
+    // Print delta (always fixed point)
+    std::printf("%18.6f ", s.net_delta);
+    
+    // Print theta (scientific for small/large values)
+    if (use_scientific_theta) {
+        std::printf("%18.6e ", theta_val);
+    } else {
+        std::printf("%18.6f ", theta_val);
+    }
+    
+    // Print vega (always fixed point)
+    std::printf("%18.6f ", s.net_vega);
+    
+    // Print iv (nan or number)
+    if (avg_iv.has_value()) {
+        std::printf("%18.6f", avg_iv.value());
+    } else {
+        std::printf("%18s", "nan");
+    }
+    
+    std::cout << std::endl;
+}
 
+// Strategies of one OptionChain; the chain must outlive the list
 class StrategyList {
 public:
-    StrategyList(std::vector<std::unique_ptr<Strategy>>&& strategies)
-        : strategies_(std::move(strategies)) {}
+    StrategyList(const OptionChain& chain, std::vector<StrategyRecord>&& strategies)
+        : chain_(&chain), strategies_(std::move(strategies)) {}
+
+    // Ties keep their current relative order. On a temporary the list is
+    // sorted in place; otherwise the records are copied first. key is a
+    // RankOrder spec.
+    StrategyList rank(const std::string& key = "rr", bool reverse = true) const & {
+        return StrategyList(*this).rank(key, reverse);
+    }
 
-    StrategyList rank(const std::string& key = "rr", bool reverse = true) {
-        if (strategies_.empty()) {
-            return StrategyList(std::vector<std::unique_ptr<Strategy>>());
-        }
-
-        std::vector<std::unique_ptr<Strategy>> sorted = [&]() {
-            auto copy = clone();
-            
-            if (key == "rr") {
-                std::sort(copy.begin(), copy.end(), 
-                    [&](const auto& a, const auto& b) { 
-                        return reverse ? (a->rr() > b->rr()) : (a->rr() < b->rr());
-                    });
-            } else if (key == "gain") {
-                std::sort(copy.begin(), copy.end(),
-                    [&](const auto& a, const auto& b) {
-                        return reverse ? (a->max_gain() > b->max_gain()) : (a->max_gain() < b->max_gain());
-                    });
-            } else if (key == "loss") {
-                std::sort(copy.begin(), copy.end(),
-                    [](const auto& a, const auto& b) {
-                        return a->max_loss() < b->max_loss();
-                    });
-            } else if (key == "cost") {
-                std::sort(copy.begin(), copy.end(),
-                    [&](const auto& a, const auto& b) {
-                        return reverse ? (a->cost() > b->cost()) : (a->cost() < b->cost());
-                    });
-            }
-            
-            return copy;
-        }();
+    StrategyList rank(const std::string& key = "rr", bool reverse = true) && {
+        const size_t n = strategies_.size();
+        return std::move(*this).ranked_top(key, n, reverse);
+    }
 
-        return StrategyList(std::move(sorted));
+    // Same as rank(key, reverse).top(n), but only the first n are ordered
+    StrategyList ranked_top(const std::string& key, size_t n, bool reverse = true) const & {
+        return StrategyList(*this).ranked_top(key, n, reverse);
     }
 
-    StrategyList top(size_t n = 10) {
+    StrategyList ranked_top(const std::string& key, size_t n, bool reverse = true) && {
+        const RankOrder order(key, reverse);
         n = std::min(n, strategies_.size());
-        std::vector<std::unique_ptr<Strategy>> result;
+        if (order.keys() == 0) {
+            return std::move(*this).top(n);
+        }
+
+        // Each key is extracted once into its own contiguous column, then
+        // indices are selected and ordered by the columns; the index breaks
+        // ties, so the order is total and equal to a stable sort
+        std::vector<std::vector<double>> columns(order.keys(), std::vector<double>(strategies_.size()));
+        for (size_t k = 0; k < order.keys(); ++k) {
+            double* column = columns[k].data();
+            for (size_t i = 0; i < strategies_.size(); ++i) {
+                column[i] = order.key(k, strategies_[i]);
+            }
+        }
+        std::vector<uint32_t> idx(strategies_.size());
+        std::iota(idx.begin(), idx.end(), uint32_t(0));
+
+        auto ranks_before = [&](uint32_t a, uint32_t b) {
+            for (const std::vector<double>& column : columns) {
+                if (column[a] != column[b]) return column[a] > column[b];
+            }
+            return a < b;
+        };
+        if (n < idx.size()) {
+            std::nth_element(idx.begin(), idx.begin() + n, idx.end(), ranks_before);
+        }
+        std::sort(idx.begin(), idx.begin() + n, ranks_before);
+
+        std::vector<StrategyRecord> sorted;
+        sorted.reserve(n);
         for (size_t i = 0; i < n; ++i) {
-            result.push_back(clone_strategy(*strategies_[i]));
+            sorted.push_back(strategies_[idx[i]]);
+        }
+        return StrategyList(*chain_, std::move(sorted));
+    }
+
+    StrategyList top(size_t n = 10) const & {
+        return StrategyList(*this).top(n);
+    }
+
+    StrategyList top(size_t n = 10) && {
+        if (n < strategies_.size()) {
+            strategies_.resize(n);
         }
-        return StrategyList(std::move(result));
+        return StrategyList(*chain_, std::move(strategies_));
     }
 
+    // The strategies on the Pareto front of spec, a RankOrder spec of the
+    // metrics to trade off (see pareto_front), in their current order
+    StrategyList pareto(const std::string& spec) const {
+        std::vector<StrategyRecord> front;
+        for (uint32_t i : pareto_front(RankOrder(spec), strategies_)) {
+            front.push_back(strategies_[i]);
+        }
+        return StrategyList(*chain_, std::move(front));
+    }
+
+    const OptionChain& chain() const { return *chain_; }
+    const std::vector<StrategyRecord>& records() const { return strategies_; }
+    const StrategyRecord& operator[](size_t i) const { return strategies_[i]; }
+
     size_t size() const { return strategies_.size(); }
 
     void print() const {
@@ -72,233 +204,660 @@ public:
             return;
         }
 
-        // Print header
-        std::printf("%-5s %-50s %12s %12s %12s %12s %18s %18s %18s %18s\n",
-                    "", "strategy", "cost", "max_gain", "max_loss", "rr",
-                    "delta", "theta", "vega", "iv");
-        
-        // Print separator
-        std::cout << std::string(165, '-') << std::endl;
-
-        // Print each strategy
+        print_strategy_header();
         for (size_t i = 0; i < strategies_.size(); ++i) {
-            const auto& s = strategies_[i];
-            
-            auto avg_iv = s->avg_iv();
-            double theta_val = s->net_theta();
-            // Use scientific notation for theta when very small or very large
-            bool use_scientific_theta = (std::abs(theta_val) < 0.001 && theta_val != 0.0) || 
-                                       std::abs(theta_val) >= 1000.0;
-
-            // Print row number and strategy name
-            std::printf("%-5zu %-50s ", i, s->pretty().c_str());
-            
-            // Print cost
-            std::printf("%12.1f ", s->cost());
-            
-            // Print max_gain (infinity or number)
-            if (std::isinf(s->max_gain())) {
-                std::printf("%12s ", "inf");
-            } else {
-                std::printf("%12.1f ", s->max_gain());
-            }
-            
-            // Print max_loss (infinity or number)
-            if (std::isinf(s->max_loss())) {
-                std::printf("%12s ", "inf");
-            } else {
-                std::printf("%12.1f ", s->max_loss());
-            }
-            
-            // Print rr (infinity or number)
-            if (std::isinf(s->rr())) {
-                std::printf("%12s ", "inf");
-            } else {
-                std::printf("%12.2f ", s->rr());
-            }
-            
-            // Print delta (always fixed point)
-            std::printf("%18.6f ", s->net_delta());
-            
-            // Print theta (scientific for small/large values)
-            if (use_scientific_theta) {
-                std::printf("%18.6e ", theta_val);
-            } else {
-                std::printf("%18.6f ", theta_val);
-            }
-            
-            // Print vega (always fixed point)
-            std::printf("%18.6f ", s->net_vega());
-            
-            // Print iv (nan or number)
-            if (avg_iv.has_value()) {
-                std::printf("%18.6f", avg_iv.value());
-            } else {
-                std::printf("%18s", "nan");
-            }
-            
-            std::cout << std::endl;
+            print_strategy_row(i, strategies_[i].pretty(*chain_), strategies_[i]);
+        }
+    }
+
+    // Every strategy, in order, under the chain's symbol
+    void write(ResultWriter& writer) const {
+        for (const StrategyRecord& s : strategies_) {
+            writer.write(*chain_, s, chain_->symbol);
         }
     }
 
 private:
-    std::vector<std::unique_ptr<Strategy>> strategies_;
+    const OptionChain* chain_;
+    std::vector<StrategyRecord> strategies_;
+};
+
+// ===================== PAGE CURSORS =====================
+// Where a page of a ranking ended: the rank value and emission position
+// (task, seq) of its last strategy over a schedule of PAGE_PARTS parts,
+// so positions do not depend on the worker count. The next page is the
+// strategies ranked strictly after it. A cursor only means something for
+// the chain, filters, key and direction that produced it.
+constexpr size_t PAGE_PARTS = 64;
+
+struct PageCursor {
+    RankValue value;
+    uint64_t task = 0;
+    uint64_t seq = 0;
+
+    // Opaque token for handing a cursor to another process or to Python
+    std::string to_string() const;
+    // Throws std::runtime_error if token is not a to_string() result
+    static PageCursor parse(const std::string& token);
+};
+
+// One page of a ranking, and where the next one starts if there is one
+struct StrategyPage {
+    StrategyList strategies;
+    std::optional<PageCursor> next;
+};
+
+// ===================== TOP STRATEGIES =====================
+// Bounded heap of the n best strategies seen so far under a RankOrder, so a
+// ranked top-n never holds more than n strategies. Ties go to the earlier
+// push, which gives the same result as rank(key, reverse).top(n). The heap
+// is allocated from resource, which must outlive it.
+class TopStrategies {
+public:
+    TopStrategies(const std::string& key, size_t n, bool reverse = true,
+                  std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : order_(key, reverse), n_(n), heap_(resource) {}
+
+    void push(const StrategyRecord& strategy) {
+        push(strategy, 0, seq_++);
+    }
 
-    std::vector<std::unique_ptr<Strategy>> clone() {
-        std::vector<std::unique_ptr<Strategy>> result;
-        for (const auto& s : strategies_) {
-            result.push_back(clone_strategy(*s));
+    // Explicit emission position for pushes from several producers: ties go
+    // to the smaller (task, seq)
+    void push(const StrategyRecord& strategy, uint64_t task, uint64_t seq) {
+        push(Entry{order_.value(strategy), task, seq, strategy});
+    }
+
+    // As push, if strategy ranks strictly after cursor
+    void push_after(const PageCursor& cursor, const StrategyRecord& strategy, uint64_t task, uint64_t seq) {
+        const RankValue value = order_.value(strategy);
+        if (!ranks_before(cursor.value, cursor.task, cursor.seq, value, task, seq)) return;
+        push(Entry{value, task, seq, strategy});
+    }
+
+    // Adds other's kept strategies, keeping their emission positions
+    void merge(TopStrategies&& other) {
+        for (Entry& entry : other.heap_) {
+            push(std::move(entry));
+        }
+        other.heap_.clear();
+    }
+
+    size_t size() const { return heap_.size(); }
+
+    // A kept strategy and its emission position
+    struct Ranked {
+        uint64_t task;
+        uint64_t seq;
+        StrategyRecord strategy;
+    };
+
+    // Kept strategies with their positions, best first; leaves this empty
+    std::vector<Ranked> take_ranked() {
+        std::sort_heap(heap_.begin(), heap_.end(), better());
+        std::vector<Ranked> result;
+        result.reserve(heap_.size());
+        for (const Entry& entry : heap_) {
+            result.push_back({entry.task, entry.seq, entry.strategy});
         }
+        heap_.clear();
         return result;
     }
 
-    std::unique_ptr<Strategy> clone_strategy(const Strategy& s) {
-        // Clone strategy based on type
-        if (auto* st = dynamic_cast<const SingleLeg*>(&s)) {
-            auto legs = s.legs();
-            std::string action = s.leg_sign(legs[0]);
-            return std::make_unique<SingleLeg>(legs[0], action, s.direction);
-        }
-        if (auto* st = dynamic_cast<const IronCondor*>(&s)) {
-            auto legs = s.legs();
-            // IronCondor constructor: sc, bc, sp, bp
-            // legs() returns: sc, bc, sp, bp
-            return std::make_unique<IronCondor>(legs[0], legs[1], legs[2], legs[3], s.direction);
-        }
-        if (auto* st = dynamic_cast<const Straddle*>(&s)) {
-            auto legs = s.legs();
-            // Straddle constructor: call, put
-            // Identify call and put by side
-            Option call, put;
-            for (const auto& leg : legs) {
-                if (leg.is_call()) call = leg;
-                if (leg.is_put()) put = leg;
-            }
-            return std::make_unique<Straddle>(call, put, s.direction);
-        }
-        if (auto* st = dynamic_cast<const Strangle*>(&s)) {
-            auto legs = s.legs();
-            // Strangle constructor: call, put
-            // Identify call and put by side
-            Option call, put;
-            for (const auto& leg : legs) {
-                if (leg.is_call()) call = leg;
-                if (leg.is_put()) put = leg;
-            }
-            return std::make_unique<Strangle>(call, put, s.direction);
+    // Kept strategies, best first; leaves this empty
+    StrategyList take(const OptionChain& chain) {
+        std::sort_heap(heap_.begin(), heap_.end(), better());
+        std::vector<StrategyRecord> result;
+        result.reserve(heap_.size());
+        for (const Entry& entry : heap_) {
+            result.push_back(entry.strategy);
+        }
+        heap_.clear();
+        return StrategyList(chain, std::move(result));
+    }
+
+private:
+    struct Entry {
+        RankValue value;
+        uint64_t task;
+        uint64_t seq;
+        StrategyRecord strategy;
+    };
+
+    void push(Entry&& entry) {
+        if (n_ == 0) return;
+
+        if (heap_.size() < n_) {
+            heap_.push_back(std::move(entry));
+            std::push_heap(heap_.begin(), heap_.end(), better());
+        } else if (better()(entry, heap_.front())) {
+            // Replace the worst kept entry
+            std::pop_heap(heap_.begin(), heap_.end(), better());
+            heap_.back() = std::move(entry);
+            std::push_heap(heap_.begin(), heap_.end(), better());
+        }
+    }
+
+    // Heap comparator: the front of the heap is the worst kept entry
+    struct Better {
+        bool operator()(const Entry& a, const Entry& b) const {
+            return ranks_before(a.value, a.task, a.seq, b.value, b.task, b.seq);
         }
-        return nullptr;
+    };
+
+    static bool ranks_before(const RankValue& a, uint64_t a_task, uint64_t a_seq, const RankValue& b,
+                             uint64_t b_task, uint64_t b_seq) {
+        if (RankOrder::before(a, b)) return true;
+        if (RankOrder::before(b, a)) return false;
+        if (a_task != b_task) return a_task < b_task;
+        return a_seq < b_seq;
     }
+
+    static Better better() { return Better{}; }
+
+    RankOrder order_;
+    size_t n_;
+    uint64_t seq_ = 0;
+    std::pmr::vector<Entry> heap_;
 };
 
+// ===================== STRATEGY FACTORY =====================
+// With threads != 1 the (strategy type x expiry) tasks run on a work-stealing
+// pool (threads == 0 uses every hardware thread). Results are merged in task
+// order, so output does not depend on the thread count. Everything a run
+// allocates besides its result lives in a RunArena released when it returns.
+// A run given a non-null ScreenStats records its stages and counters there.
 class StrategyFactory {
 public:
-    StrategyFactory(const std::vector<Option>& options, double spot)
-        : options_(options), spot_(spot) {
-        generators_["single_calls"] = std::make_unique<SingleCallsGenerator>(options, spot);
-        generators_["iron_condors"] = std::make_unique<IronCondorsGenerator>(options, spot);
-        generators_["straddles"] = std::make_unique<StraddlesGenerator>(options, spot);
-        generators_["strangles"] = std::make_unique<StranglesGenerator>(options, spot);
+    StrategyFactory(const OptionChain& chain, double spot, size_t threads = 1)
+        : chain_(chain), spot_(spot) {
+        generators_["single_calls"] = std::make_unique<SingleCallsGenerator>();
+        generators_["iron_condors"] = std::make_unique<IronCondorsGenerator>();
+        generators_["straddles"] = std::make_unique<StraddlesGenerator>();
+        generators_["strangles"] = std::make_unique<StranglesGenerator>();
+        generators_["call_verticals"] = std::make_unique<CallVerticalsGenerator>();
+        generators_["put_verticals"] = std::make_unique<PutVerticalsGenerator>();
+        generators_["call_butterflies"] = std::make_unique<CallButterfliesGenerator>();
+        generators_["put_butterflies"] = std::make_unique<PutButterfliesGenerator>();
+        generators_["call_calendars"] = std::make_unique<CallCalendarsGenerator>();
+        generators_["put_calendars"] = std::make_unique<PutCalendarsGenerator>();
+        generators_["call_diagonals"] = std::make_unique<CallDiagonalsGenerator>();
+        generators_["put_diagonals"] = std::make_unique<PutDiagonalsGenerator>();
+
+        if (threads != 1) {
+            pool_ = std::make_unique<WorkStealingPool>(threads);
+        }
     }
 
+    // Runs then index the chain through layout, which must be of this
+    // chain's strike, side and expiry columns and outlive the runs, instead
+    // of grouping and sorting it again; null goes back to sorting
+    void use_layout(const ChainLayout* layout) { layout_ = layout; }
+
     StrategyList strategy(const StrategyFilter& s_filter, const ConfigFilter& c_filter) {
         return generate(s_filter, c_filter);
     }
 
-    StrategyList generate(const StrategyFilter& s_filter, const ConfigFilter& c_filter) {
-        std::vector<std::unique_ptr<Strategy>> all_strategies;
+    StrategyList generate(const StrategyFilter& s_filter, const ConfigFilter& c_filter,
+                          ScreenStats* stats = nullptr) {
+        RunArena arena(workers());
+        const ChainIndex index(chain_, spot_, c_filter, layout_, arena.shared(), stats);
+        const auto tasks = schedule(s_filter, index);
+        TaskCounters counters(tasks.size(), stats);
+
+        // One buffer per task in the arena of the worker running it,
+        // concatenated in task order. A deque grows by whole blocks, so no
+        // arena memory is abandoned to regrowth.
+        std::vector<std::optional<std::pmr::deque<StrategyRecord>>> buffers(tasks.size());
+        {
+            StageTimer timer(stats, "generate");
+            run(tasks.size(), [&](size_t t, size_t worker) {
+                auto& buffer = buffers[t].emplace(arena.worker(worker));
+                run_task(index, c_filter, tasks[t], [&](const StrategyRecord& s) { buffer.push_back(s); },
+                         arena.worker(worker), counters[t]);
+            });
+        }
+        record_counters(stats, tasks, counters);
+
+        StageTimer timer(stats, "collect");
+        size_t total = 0;
+        for (const auto& buffer : buffers) total += buffer->size();
+        std::vector<StrategyRecord> all_strategies;
+        all_strategies.reserve(total);
+        for (const auto& buffer : buffers) {
+            all_strategies.insert(all_strategies.end(), buffer->begin(), buffer->end());
+        }
+        return StrategyList(chain_, std::move(all_strategies));
+    }
 
-        if (s_filter.single_calls) {
-            auto strategies = generators_["single_calls"]->generate(c_filter);
-            auto filtered = filter_strategies(std::move(strategies), c_filter);
-            all_strategies.insert(all_strategies.end(),
-                std::make_move_iterator(filtered.begin()),
-                std::make_move_iterator(filtered.end()));
+    // Ranked top n, streamed through a bounded heap; same result as
+    // strategy(s_filter, c_filter).rank(key, reverse).top(n)
+    StrategyList top(const StrategyFilter& s_filter, const ConfigFilter& c_filter,
+                     const std::string& key, size_t n, bool reverse = true, ScreenStats* stats = nullptr) {
+        RunArena arena(workers());
+        const ChainIndex index(chain_, spot_, c_filter, layout_, arena.shared(), stats);
+        const auto tasks = schedule(s_filter, index);
+        TaskCounters counters(tasks.size(), stats);
+
+        // One heap per worker; ties resolve by (task, seq) = serial emission order
+        std::vector<TopStrategies> heaps;
+        heaps.reserve(workers());
+        for (size_t w = 0; w < workers(); ++w) {
+            heaps.emplace_back(key, n, reverse, arena.worker(w));
+        }
+        {
+            StageTimer timer(stats, "generate");
+            run(tasks.size(), [&](size_t t, size_t worker) {
+                uint64_t seq = 0;
+                run_task(index, c_filter, tasks[t], [&](const StrategyRecord& s) { heaps[worker].push(s, t, seq++); },
+                         arena.worker(worker), counters[t]);
+            });
         }
+        record_counters(stats, tasks, counters);
 
-        if (s_filter.iron_condors) {
-            auto strategies = generators_["iron_condors"]->generate(c_filter);
-            auto filtered = filter_strategies(std::move(strategies), c_filter);
-            all_strategies.insert(all_strategies.end(),
-                std::make_move_iterator(filtered.begin()),
-                std::make_move_iterator(filtered.end()));
+        // Pushes into the heaps happen while generating; this is the merge
+        StageTimer timer(stats, "rank");
+        TopStrategies best(key, n, reverse, arena.shared());
+        for (TopStrategies& heap : heaps) {
+            best.merge(std::move(heap));
         }
+        return best.take(chain_);
+    }
 
-        if (s_filter.straddles) {
-            auto strategies = generators_["straddles"]->generate(c_filter);
-            auto filtered = filter_strategies(std::move(strategies), c_filter);
-            all_strategies.insert(all_strategies.end(),
-                std::make_move_iterator(filtered.begin()),
-                std::make_move_iterator(filtered.end()));
+    // Ranked top n of the Pareto front of the metrics in front (a RankOrder
+    // spec); same result as strategy(s_filter, c_filter).pareto(front)
+    // .rank(key, reverse).top(n). A strategy off its task's front is off
+    // the whole front, so each task prunes its buffer to its own front
+    // whenever the buffer doubles, and only the task fronts are merged.
+    StrategyList pareto_top(const StrategyFilter& s_filter, const ConfigFilter& c_filter, const std::string& front,
+                            const std::string& key, size_t n, bool reverse = true, ScreenStats* stats = nullptr) {
+        constexpr size_t MIN_PRUNE = 64 * 1024;
+        const RankOrder order(front);
+
+        RunArena arena(workers());
+        const ChainIndex index(chain_, spot_, c_filter, layout_, arena.shared(), stats);
+        const auto tasks = schedule(s_filter, index);
+        TaskCounters counters(tasks.size(), stats);
+
+        auto prune = [&](std::vector<StrategyRecord>& buffer) {
+            const auto keep = pareto_front(order, buffer);
+            for (size_t i = 0; i < keep.size(); ++i) buffer[i] = buffer[keep[i]];
+            buffer.resize(keep.size());
+        };
+        std::vector<std::vector<StrategyRecord>> buffers(tasks.size());
+        {
+            StageTimer timer(stats, "generate");
+            run(tasks.size(), [&](size_t t, size_t worker) {
+                auto& buffer = buffers[t];
+                size_t limit = MIN_PRUNE;
+                run_task(index, c_filter, tasks[t], [&](const StrategyRecord& s) {
+                    buffer.push_back(s);
+                    if (buffer.size() >= limit) {
+                        prune(buffer);
+                        limit = std::max(MIN_PRUNE, 2 * buffer.size());
+                    }
+                }, arena.worker(worker), counters[t]);
+                prune(buffer);
+            });
         }
+        record_counters(stats, tasks, counters);
 
-        if (s_filter.strangles) {
-            auto strategies = generators_["strangles"]->generate(c_filter);
-            auto filtered = filter_strategies(std::move(strategies), c_filter);
-            all_strategies.insert(all_strategies.end(),
-                std::make_move_iterator(filtered.begin()),
-                std::make_move_iterator(filtered.end()));
+        std::vector<StrategyRecord> fronts;
+        {
+            StageTimer timer(stats, "pareto");
+            for (const auto& buffer : buffers) {
+                fronts.insert(fronts.end(), buffer.begin(), buffer.end());
+            }
+            prune(fronts);
         }
 
-        return StrategyList(std::move(all_strategies));
+        StageTimer timer(stats, "rank");
+        return StrategyList(chain_, std::move(fronts)).ranked_top(key, n, reverse);
     }
 
-private:
-    const std::vector<Option>& options_;
-    double spot_;
-    std::map<std::string, std::unique_ptr<StrategyGenerator>> generators_;
+    // The ranked top n of each generator s_filter enables, on its own, in
+    // schedule order. Pushing every list into one TopStrategies, list by list
+    // as successive tasks and each in its order, gives top().
+    std::vector<StrategyList> top_by_generator(const StrategyFilter& s_filter, const ConfigFilter& c_filter,
+                                               const std::string& key, size_t n, bool reverse = true) {
+        RunArena arena(workers());
+        const ChainIndex index(chain_, spot_, c_filter, layout_, arena.shared());
+        const auto names = enabled_generators(s_filter);
+        const auto tasks = schedule(s_filter, index);
+
+        // heaps[worker * names.size() + g]; task t belongs to generator
+        // generator_of[t], and tasks of a generator are contiguous
+        std::vector<size_t> generator_of(tasks.size());
+        for (size_t t = 0, g = 0; t < tasks.size(); ++t) {
+            while (*tasks[t].name != names[g]) ++g;
+            generator_of[t] = g;
+        }
+        std::vector<TopStrategies> heaps;
+        heaps.reserve(workers() * names.size());
+        for (size_t h = 0; h < workers() * names.size(); ++h) {
+            heaps.emplace_back(key, n, reverse, arena.worker(h / names.size()));
+        }
+        run(tasks.size(), [&](size_t t, size_t worker) {
+            TopStrategies& heap = heaps[worker * names.size() + generator_of[t]];
+            uint64_t seq = 0;
+            run_task(index, c_filter, tasks[t], [&](const StrategyRecord& s) { heap.push(s, t, seq++); },
+                     arena.worker(worker), nullptr);
+        });
+
+        std::vector<StrategyList> lists;
+        lists.reserve(names.size());
+        for (size_t g = 0; g < names.size(); ++g) {
+            TopStrategies best(key, n, reverse, arena.shared());
+            for (size_t w = 0; w < workers(); ++w) {
+                best.merge(std::move(heaps[w * names.size() + g]));
+            }
+            lists.push_back(best.take(chain_));
+        }
+        return lists;
+    }
+
+    // Ranked top n over the tasks of a schedule that splits large expiries
+    // into `parts` pieces whatever the worker count, keeping only the tasks
+    // select(task) picks, with every kept record's (task, seq). Processes
+    // that use the same parts agree on task numbers, and positions order
+    // like serial emission, so the top n of the union of several such
+    // results, ties to the smaller position, is top() over their tasks.
+    // tasks is set to the schedule's length.
+    std::vector<TopStrategies::Ranked> top_of_tasks(const StrategyFilter& s_filter, const ConfigFilter& c_filter,
+                                                    const std::string& key, size_t n, size_t parts,
+                                                    const std::function<bool(size_t)>& select, size_t& tasks,
+                                                    bool reverse = true, ScreenStats* stats = nullptr) {
+        RunArena arena(workers());
+        const ChainIndex index(chain_, spot_, c_filter, layout_, arena.shared(), stats);
+        const auto scheduled = schedule(s_filter, index, parts);
+        tasks = scheduled.size();
+
+        std::vector<size_t> picked;
+        for (size_t t = 0; t < scheduled.size(); ++t) {
+            if (select(t)) picked.push_back(t);
+        }
+        std::vector<ScheduledTask> chosen;
+        for (size_t t : picked) chosen.push_back(scheduled[t]);
+        TaskCounters counters(chosen.size(), stats);
+
+        std::vector<TopStrategies> heaps;
+        heaps.reserve(workers());
+        for (size_t w = 0; w < workers(); ++w) {
+            heaps.emplace_back(key, n, reverse, arena.worker(w));
+        }
+        {
+            StageTimer timer(stats, "generate");
+            run(chosen.size(), [&](size_t i, size_t worker) {
+                uint64_t seq = 0;
+                run_task(index, c_filter, chosen[i], [&](const StrategyRecord& s) {
+                    heaps[worker].push(s, picked[i], seq++);
+                }, arena.worker(worker), counters[i]);
+            });
+        }
+        record_counters(stats, chosen, counters);
 
-    static bool check_range(double value, const std::optional<std::tuple<double, double>>& range) {
-        if (!range.has_value()) return true;
-        
-        // Handle NaN - NaN cannot be in any range
-        if (std::isnan(value)) return false;
-        
-        auto [min_val, max_val] = range.value();
-        // Inclusive range check: min_val <= value <= max_val
-        // Infinity values are handled correctly by normal comparison:
-        // - inf <= finite_max is false, so inf outside finite range is correctly excluded
-        // - inf <= inf is true, so inf can be allowed if range includes infinity
-        return value >= min_val && value <= max_val;
-    }
-
-    std::vector<std::unique_ptr<Strategy>> filter_strategies(
-        std::vector<std::unique_ptr<Strategy>> strategies,
-        const ConfigFilter& c_filter) {
-        
-        std::vector<std::unique_ptr<Strategy>> filtered;
-
-        for (auto& strategy : strategies) {
-            if (c_filter.debit_range.has_value() && strategy->debit() > 0) {
-                if (!check_range(strategy->debit(), c_filter.debit_range)) {
-                    continue;
+        StageTimer timer(stats, "rank");
+        TopStrategies best(key, n, reverse, arena.shared());
+        for (TopStrategies& heap : heaps) {
+            best.merge(std::move(heap));
+        }
+        return best.take_ranked();
+    }
+
+    // The next size strategies of the ranking top() gives, after `after`
+    // (from the first if unset): concatenating pages from the first gives
+    // top(), so a caller can walk a ranking of any length holding one page.
+    // Every page is one generation pass. A ranked key keeps the size + 1
+    // best after the cursor per worker; with key "none" (emission order)
+    // tasks are pulled in order, a wave of workers() tasks at a time, from
+    // the cursor's task until the page fills, and the rest never run.
+    StrategyPage page(const StrategyFilter& s_filter, const ConfigFilter& c_filter, const std::string& key,
+                      size_t size, const std::optional<PageCursor>& after = std::nullopt, bool reverse = true,
+                      ScreenStats* stats = nullptr) {
+        if (size == 0) throw std::invalid_argument("page size must be positive");
+        const RankOrder order(key, reverse);
+        const size_t want = size + 1;  // one past the page tells whether another follows
+
+        RunArena arena(workers());
+        const ChainIndex index(chain_, spot_, c_filter, layout_, arena.shared(), stats);
+        const auto tasks = schedule(s_filter, index, PAGE_PARTS);
+        TaskCounters counters(tasks.size(), stats);
+
+        std::vector<TopStrategies::Ranked> ranked;
+        if (order.keys() == 0) {
+            StageTimer timer(stats, "generate");
+            for (size_t begin = after ? after->task : 0; begin < tasks.size() && ranked.size() < want;
+                 begin += workers()) {
+                const size_t end = std::min(tasks.size(), begin + workers());
+                const size_t need = want - ranked.size();
+                std::vector<std::vector<TopStrategies::Ranked>> buffers(end - begin);
+                run(end - begin, [&](size_t i, size_t worker) {
+                    const size_t t = begin + i;
+                    const bool resumed = after && t == after->task;
+                    uint64_t seq = 0;
+                    run_task(index, c_filter, tasks[t], [&](const StrategyRecord& s) {
+                        const uint64_t q = seq++;
+                        if ((resumed && q <= after->seq) || buffers[i].size() == need) return;
+                        buffers[i].push_back({t, q, s});
+                    }, arena.worker(worker), counters[t]);
+                });
+                for (auto& buffer : buffers) {
+                    const size_t take = std::min(buffer.size(), want - ranked.size());
+                    ranked.insert(ranked.end(), buffer.begin(), buffer.begin() + take);
                 }
             }
+        } else {
+            std::vector<TopStrategies> heaps;
+            heaps.reserve(workers());
+            for (size_t w = 0; w < workers(); ++w) {
+                heaps.emplace_back(key, want, reverse, arena.worker(w));
+            }
+            {
+                StageTimer timer(stats, "generate");
+                run(tasks.size(), [&](size_t t, size_t worker) {
+                    uint64_t seq = 0;
+                    run_task(index, c_filter, tasks[t], [&](const StrategyRecord& s) {
+                        if (after) {
+                            heaps[worker].push_after(*after, s, t, seq++);
+                        } else {
+                            heaps[worker].push(s, t, seq++);
+                        }
+                    }, arena.worker(worker), counters[t]);
+                });
+            }
+            StageTimer timer(stats, "rank");
+            TopStrategies best(key, want, reverse, arena.shared());
+            for (TopStrategies& heap : heaps) {
+                best.merge(std::move(heap));
+            }
+            ranked = best.take_ranked();
+        }
+        record_counters(stats, tasks, counters);
 
-            if (c_filter.credit_range.has_value() && strategy->credit() > 0) {
-                if (!check_range(strategy->credit(), c_filter.credit_range)) {
-                    continue;
+        std::optional<PageCursor> next;
+        if (ranked.size() > size) {
+            const TopStrategies::Ranked& last = ranked[size - 1];
+            next = PageCursor{order.value(last.strategy), last.task, last.seq};
+            ranked.resize(size);
+        }
+        std::vector<StrategyRecord> strategies;
+        strategies.reserve(ranked.size());
+        for (const TopStrategies::Ranked& r : ranked) {
+            strategies.push_back(r.strategy);
+        }
+        return {StrategyList(chain_, std::move(strategies)), next};
+    }
+
+    // P&L of every strategy of list (built over this factory's chain) under
+    // every scenario of grid, from this factory's spot. Each distinct leg row
+    // is valued once over the whole grid, in parallel over rows; each
+    // strategy's row is then the signed sum of its legs', in parallel over
+    // strategies.
+    ScenarioMatrix scenarios(const StrategyList& list, const ScenarioGrid& grid, ScreenStats* stats = nullptr) {
+        StageTimer timer(stats, "scenarios");
+        constexpr size_t ROWS_PER_TASK = 64;
+        constexpr size_t STRATEGIES_PER_TASK = 1024;
+        constexpr uint32_t NONE = UINT32_MAX;
+
+        const ScenarioKernel kernel(grid, spot_);
+        const size_t m = kernel.size();
+        const std::vector<StrategyRecord>& records = list.records();
+
+        std::vector<uint32_t> slot(chain_.size(), NONE);
+        std::vector<uint32_t> rows;
+        for (const StrategyRecord& r : records) {
+            for (size_t l = 0; l < r.leg_count; ++l) {
+                if (slot[r.leg[l]] == NONE) {
+                    slot[r.leg[l]] = uint32_t(rows.size());
+                    rows.push_back(r.leg[l]);
                 }
             }
+        }
 
-            if (!check_range(strategy->max_gain(), c_filter.potential_gain_range) ||
-                !check_range(strategy->max_loss(), c_filter.potential_loss_range) ||
-                !check_range(strategy->rr(), c_filter.rr_range) ||
-                !check_range(strategy->net_delta(), c_filter.net_delta_range) ||
-                !check_range(strategy->net_theta(), c_filter.net_theta_range) ||
-                !check_range(strategy->net_vega(), c_filter.net_vega_range)) {
-                continue;
+        std::vector<double> legs(rows.size() * m);
+        run((rows.size() + ROWS_PER_TASK - 1) / ROWS_PER_TASK, [&](size_t t, size_t) {
+            const size_t end = std::min(rows.size(), (t + 1) * ROWS_PER_TASK);
+            for (size_t i = t * ROWS_PER_TASK; i < end; ++i) {
+                kernel.leg(chain_, rows[i], legs.data() + i * m);
+            }
+        });
+
+        ScenarioMatrix matrix{grid, records.size(), std::vector<double>(records.size() * m, 0.0)};
+        run((records.size() + STRATEGIES_PER_TASK - 1) / STRATEGIES_PER_TASK, [&](size_t t, size_t) {
+            const size_t end = std::min(records.size(), (t + 1) * STRATEGIES_PER_TASK);
+            for (size_t i = t * STRATEGIES_PER_TASK; i < end; ++i) {
+                const StrategyRecord& r = records[i];
+                double* out = matrix.pnl.data() + i * m;
+                for (size_t l = 0; l < r.leg_count; ++l) {
+                    ScenarioKernel::accumulate(out, legs.data() + size_t(slot[r.leg[l]]) * m, r.sign[l] * 100.0, m);
+                }
             }
+        });
+        return matrix;
+    }
+
+    // Generators s_filter enables, in schedule order: the order of their
+    // output in generate() and of ties in top()
+    static std::vector<std::string> enabled_generators(const StrategyFilter& s_filter) {
+        std::vector<std::string> names;
+        auto add = [&](bool enabled, const char* name) {
+            if (enabled) names.push_back(name);
+        };
+        add(s_filter.single_calls, "single_calls");
+        add(s_filter.iron_condors, "iron_condors");
+        add(s_filter.straddles, "straddles");
+        add(s_filter.strangles, "strangles");
+        add(s_filter.verticals, "call_verticals");
+        add(s_filter.verticals, "put_verticals");
+        add(s_filter.butterflies, "call_butterflies");
+        add(s_filter.butterflies, "put_butterflies");
+        add(s_filter.calendars, "call_calendars");
+        add(s_filter.calendars, "put_calendars");
+        add(s_filter.diagonals, "call_diagonals");
+        add(s_filter.diagonals, "put_diagonals");
+        return names;
+    }
+
+    // Every strategy passing all filters, in generator order, handed to emit
+    // on the calling thread
+    void generate(const StrategyFilter& s_filter, const ConfigFilter& c_filter, const StrategySink& emit) {
+        // Option-level filters, expiry grouping and strike sorting, shared by all generators
+        RunArena arena(1);
+        const ChainIndex index(chain_, spot_, c_filter, layout_, arena.shared());
+
+        for (const ScheduledTask& task : schedule(s_filter, index)) {
+            run_task(index, c_filter, task, emit, arena.worker(0), nullptr);
+        }
+    }
+
+private:
+    struct ScheduledTask {
+        const std::string* name;
+        StrategyGenerator* generator;
+        GeneratorTask task;
+    };
+
+    // One GeneratorCounters per task when stats are on, so workers never
+    // share counters; counters[t] is null otherwise
+    class TaskCounters {
+    public:
+        TaskCounters(size_t tasks, const ScreenStats* stats) {
+            if (stats) counters_.resize(tasks);
+        }
+        GeneratorCounters* operator[](size_t t) { return counters_.empty() ? nullptr : &counters_[t]; }
 
-            auto avg_iv = strategy->avg_iv();
-            if (avg_iv.has_value() && !check_range(avg_iv.value(), c_filter.iv_range)) {
-                continue;
+    private:
+        std::vector<GeneratorCounters> counters_;
+    };
+
+    const OptionChain& chain_;
+    double spot_;
+    std::map<std::string, std::unique_ptr<StrategyGenerator>> generators_;
+    std::unique_ptr<WorkStealingPool> pool_;
+    const ChainLayout* layout_ = nullptr;
+
+    size_t workers() const { return pool_ ? pool_->size() : 1; }
+
+    // Every enabled generator's tasks, in serial emission order
+    // With parts = 0, large expiries are split once per worker
+    std::vector<ScheduledTask> schedule(const StrategyFilter& s_filter, const ChainIndex& index, size_t parts = 0) {
+        if (parts == 0) parts = workers();
+        std::vector<ScheduledTask> tasks;
+        for (const std::string& name : enabled_generators(s_filter)) {
+            auto it = generators_.find(name);
+            for (const GeneratorTask& task : it->second->partition(index, parts)) {
+                tasks.push_back({&it->first, it->second.get(), task});
             }
+        }
+        return tasks;
+    }
 
-            filtered.push_back(std::move(strategy));
+    static void run_task(const ChainIndex& index, const ConfigFilter& c_filter, const ScheduledTask& task,
+                         const StrategySink& emit, std::pmr::memory_resource* scratch,
+                         GeneratorCounters* counters) {
+        memory::check_budget();
+        if (!counters) {
+            task.generator->generate_task(index, c_filter, task.task, [&](const StrategyRecord& s) {
+                if (passes_strategy_level_filters(c_filter, s)) emit(s);
+            }, scratch, nullptr);
+            return;
         }
 
-        return filtered;
+        const memory::ThreadScope allocated;
+        auto start = std::chrono::steady_clock::now();
+        task.generator->generate_task(index, c_filter, task.task, [&](const StrategyRecord& s) {
+            StrategyCriterion rejection = strategy_level_rejection(c_filter, s);
+            counters->record(rejection);
+            if (rejection == StrategyCriterion::NONE) emit(s);
+        }, scratch, counters);
+        counters->memory.merge(allocated.counters());
+        counters->tasks += 1;
+        counters->seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Task counters summed per generator, in task order
+    void record_counters(ScreenStats* stats, const std::vector<ScheduledTask>& tasks, TaskCounters& counters) const {
+        if (!stats) return;
+        stats->threads = workers();
+        for (size_t t = 0; t < tasks.size(); ++t) {
+            stats->generator(*tasks[t].name).merge(*counters[t]);
+        }
+    }
+
+    // fn(task, worker) for task in [0, n): on the pool if there is one,
+    // otherwise in order on this thread as worker 0
+    void run(size_t n, const std::function<void(size_t, size_t)>& fn) {
+        if (!pool_) {
+            for (size_t t = 0; t < n; ++t) fn(t, 0);
+            return;
+        }
+
+        std::vector<WorkStealingPool::Task> jobs;
+        jobs.reserve(n);
+        for (size_t t = 0; t < n; ++t) {
+            jobs.push_back([&fn, t](size_t worker) { fn(t, worker); });
+        }
+        pool_->run(jobs);
     }
 };
 
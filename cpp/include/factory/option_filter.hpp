@@ -2,90 +2,111 @@
 #define OPTION_FILTER_HPP
 
 #include "object.hpp"
+#include "chain.hpp"
 #include <vector>
 #include <functional>
 #include <algorithm>
-#include <tuple>
+#include <numeric>
+#include <cstdint>
 
-class OptionFilter {
-public:
-    OptionFilter(std::vector<Option>& universe, double spot)
-        : universe_(universe), spot_(spot) {}
-
-    OptionFilter& filter(std::function<bool(const Option&)> cond) {
-        std::vector<Option> filtered;
-        for (const auto& opt : universe_) {
-            if (cond(opt)) {
-                filtered.push_back(opt);
-            }
-        }
-        universe_ = std::move(filtered);
-        return *this;
-    }
+// Option-level ConfigFilter criteria, in the order they are checked
+enum class OptionCriterion : uint8_t {
+    NONE,  // passes every criterion
+    VOLUME,
+    OI,
+    PRICE,
+    VOLUME_RATIO,
+    SPREAD,
+    EXPIRY,  // expiry or days_to_expiry_range
+    COUNT
+};
 
-    OptionFilter& apply_filter(const ConfigFilter& cfg) {
-        if (cfg.min_volume.has_value()) {
-            filter([&](const Option& o) { 
-                return (o.volume >= cfg.min_volume.value()); 
-            });
-        }
+// Config key of a criterion, e.g. "min_volume"
+const char* option_criterion_name(OptionCriterion criterion);
 
-        if (cfg.min_oi.has_value()) {
-            filter([&](const Option& o) { 
-                return (o.oi >= cfg.min_oi.value()); 
-            });
-        }
+// ===================== COMPILED OPTION FILTER =====================
+// The option-level part of a ConfigFilter reduced to plain bounds, evaluated
+// in one branch-free pass over the chain columns. Expiry-level criteria
+// (expiry, days_to_expiry_range) are resolved once per expiry id.
+struct CompiledOptionFilter {
+    bool check_volume = false;
+    bool check_oi = false;
+    bool check_price = false;
+    bool check_ratio = false;
+    bool check_spread = false;
+    double min_volume = 0.0;
+    double min_oi = 0.0;
+    double min_price = 0.0;
+    double min_ratio = 0.0;
+    double max_ratio = 0.0;
+    double max_spread = 0.0;
 
-        if (cfg.min_price.has_value()) {
-            filter([&](const Option& o) { 
-                return (o.price() >= cfg.min_price.value()); 
-            });
-        }
+    // 1 if rows of that expiry id can pass
+    std::vector<uint8_t> expiry_ok;
 
-        if (cfg.expiry.has_value()) {
-            filter([&](const Option& o) { 
-                return o.expiry == cfg.expiry.value(); 
-            });
-        }
+    CompiledOptionFilter(const ConfigFilter& cfg, const OptionChain& chain);
 
-        if (cfg.days_to_expiry_range.has_value()) {
-            auto range = cfg.days_to_expiry_range.value();
-            auto min_days = std::get<0>(range);
-            auto max_days = std::get<1>(range);
-            filter([min_days, max_days](const Option& o) { 
-                return o.days_to_expiry >= min_days && 
-                       o.days_to_expiry <= max_days; 
-            });
-        }
+    // Numeric bounds only, with no expiry table; for checking quotes before
+    // they are in a chain
+    explicit CompiledOptionFilter(const ConfigFilter& cfg);
 
-        if (cfg.volume_ratio_range.has_value()) {
-            auto range = cfg.volume_ratio_range.value();
-            auto min_ratio = std::get<0>(range);
-            auto max_ratio = std::get<1>(range);
-            filter([min_ratio, max_ratio](const Option& o) { 
-                auto ratio = o.volume_ratio();
-                return ratio.has_value() && 
-                       *ratio >= min_ratio && *ratio <= max_ratio; 
-            });
-        }
+    // Whether rows of an expiry with that many days left can pass
+    static bool expiry_passes(const ConfigFilter& cfg, const std::string& expiry, int days);
 
-        if (cfg.max_bid_ask_spread.has_value()) {
-            filter([&](const Option& o) { 
-                auto spread = o.bid_ask_spread();
-                return spread.has_value() && 
-                       *spread <= cfg.max_bid_ask_spread.value(); 
-            });
-        }
+    // mask[i] = 1 if row i passes every option-level criterion, else 0
+    void evaluate(const OptionChain& chain, uint8_t* mask) const;
+
+    // Same criteria as evaluate() for a single row
+    bool passes(const OptionChain& chain, size_t i) const {
+        return rejection(chain, i) == OptionCriterion::NONE;
+    }
+
+    // First criterion row i fails, or NONE; a skipped expiry comes first
+    OptionCriterion rejection(const OptionChain& chain, size_t i) const;
+
+    // First numeric criterion a quote fails, or NONE; missing bid/ask are NaN
+    OptionCriterion quote_rejection(double volume, double oi, double mid, double bid, double ask) const;
+};
+
+// Narrows a selection of row indices into an OptionChain; the chain itself
+// is never copied or modified.
+class OptionFilter {
+public:
+    OptionFilter(const OptionChain& chain, double spot)
+        : chain_(chain), spot_(spot), selection_(chain.size()) {
+        std::iota(selection_.begin(), selection_.end(), uint32_t(0));
+    }
 
+    OptionFilter& filter(std::function<bool(size_t)> cond) {
+        selection_.erase(
+            std::remove_if(selection_.begin(), selection_.end(),
+                [&](uint32_t i) { return !cond(i); }),
+            selection_.end());
         return *this;
     }
 
-    std::vector<Option>& result() { return universe_; }
+    // All option-level criteria of cfg in a single fused pass
+    OptionFilter& apply_filter(const ConfigFilter& cfg) {
+        CompiledOptionFilter compiled(cfg, chain_);
+        std::vector<uint8_t> mask(chain_.size());
+        compiled.evaluate(chain_, mask.data());
+
+        size_t kept = 0;
+        for (uint32_t i : selection_) {
+            selection_[kept] = i;
+            kept += mask[i];
+        }
+        selection_.resize(kept);
+        return *this;
+    }
+
+    // Selected row indices, in chain order
+    const std::vector<uint32_t>& result() const { return selection_; }
 
 private:
-    std::vector<Option>& universe_;
+    const OptionChain& chain_;
     double spot_;
+    std::vector<uint32_t> selection_;
 };
 
 #endif // OPTION_FILTER_HPP
-
@@ -0,0 +1,26 @@
+#ifndef PARETO_HPP
+#define PARETO_HPP
+
+#include "factory/rank_order.hpp"
+#include "strategy/strategy_class.hpp"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// ===================== PARETO FRONT =====================
+// Skyline of a result set under the keys of a RankOrder spec, e.g.
+// "rr,loss,theta": a strategy is dropped if another is at least as good on
+// every key and better on one, where "good" is the key's rank direction
+// (plain loss smallest first, NaN worst). Strategies equal on every key
+// are all kept.
+//
+// Keys are extracted once into RankValues and sorted best first. Up to
+// three keys are then one sweep over a staircase of the later keys, so
+// O(N log N); four keys check each strategy against the front found so
+// far, O(N * front).
+
+// Indices of the strategies of records on the front of order, ascending;
+// every index if order has no keys
+std::vector<uint32_t> pareto_front(const RankOrder& order, std::span<const StrategyRecord> records);
+
+#endif // PARETO_HPP
@@ -0,0 +1,43 @@
+#ifndef PRICING_HPP
+#define PRICING_HPP
+
+#include "object.hpp"
+#include "chain.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct PricingCounters;
+
+// ===================== PRICING =====================
+// Recomputes IV and greeks of chain rows from their mids, for feeds whose
+// greeks are missing (stored as 0) or stale. Rows are gathered into blocks
+// of PRICING_BLOCK and solved together: Black-Scholes (European, continuous
+// rate, no dividends) with its own branch-free exp and normal CDF, so every
+// step is one vectorized pass over the block (AVX-512/AVX2/baseline).
+//
+// IV starts from the Corrado-Miller approximation and is refined by Newton
+// steps kept inside a shrinking [lo, hi] bracket, bisecting when a step
+// leaves it. A row solves when its mid lies strictly between the no-arbitrage
+// bounds and the model matches it to PRICING_TOLERANCE (relative). A row that
+// does not solve keeps its quoted IV, if any, and gets greeks from that;
+// otherwise it is left as loaded.
+//
+// Greeks are per share in Tradier's units: theta per calendar day, vega and
+// rho per vol or rate point. Years to expiry are days_to_expiry / 365, so
+// rows expiring today (0 days) never solve.
+constexpr size_t PRICING_BLOCK = 256;
+constexpr double PRICING_TOLERANCE = 1e-8;
+
+// Rows config.mode selects: every row (ALL), or rows with no IV or with
+// delta, gamma, theta and vega all zero (MISSING)
+std::vector<uint32_t> pricing_rows(const OptionChain& chain, PricingMode mode);
+
+// Solves and writes iv, delta, gamma, theta, vega and rho of rows
+void price_rows(OptionChain& chain, double spot, const PricingConfig& config, const std::vector<uint32_t>& rows,
+                PricingCounters* counters = nullptr);
+
+// price_rows over pricing_rows(chain, config.mode)
+void price_chain(OptionChain& chain, double spot, const PricingConfig& config, PricingCounters* counters = nullptr);
+
+#endif // PRICING_HPP
@@ -0,0 +1,105 @@
+#ifndef RANK_ORDER_HPP
+#define RANK_ORDER_HPP
+
+#include "strategy/strategy_class.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+// ===================== RANK VALUE =====================
+constexpr size_t MAX_RANK_KEYS = 4;
+
+// One strategy's sort keys under a RankOrder, normalized so that a larger key
+// ranks first and NaN ranks last; keys the order does not use are 0
+struct RankValue {
+    double key[MAX_RANK_KEYS] = {};
+};
+
+// ===================== RANK ORDER =====================
+// Ordering behind StrategyList::rank, TopStrategies and the resident and
+// batch rankings. A spec is a comma-separated list of keys, compared in turn:
+//
+//   key    := factor (('*' | '/') factor)* [':asc' | ':desc']
+//   factor := rr | gain | loss | cost | debit | credit | delta | theta
+//             | vega | iv | liquidity | <number>
+//
+// e.g. "rr", "loss,rr", "rr*liquidity" or "theta/loss:desc". The greeks
+// are also accepted as net_delta, net_theta and net_vega. liquidity is
+// the smallest volume + open interest over a strategy's legs. A key ranks
+// largest first, except plain "loss" which ranks smallest first; reverse =
+// false flips every key. "none" (or "") keeps emission order. An unknown
+// factor or more than MAX_RANK_KEYS keys throws std::invalid_argument.
+class RankOrder {
+public:
+    explicit RankOrder(const std::string& spec, bool reverse = true);
+
+    size_t keys() const { return keys_.size(); }
+
+    // Normalized key k of s
+    double key(size_t k, const StrategyMetrics& s) const {
+        const Key& key = keys_[k];
+        double v = factor(key.factors[0], s);
+        for (size_t f = 1; f < key.factors.size(); ++f) {
+            const double x = factor(key.factors[f], s);
+            v = key.factors[f].divide ? v / x : v * x;
+        }
+        return std::isnan(v) ? -std::numeric_limits<double>::infinity() : v * key.sign;
+    }
+
+    RankValue value(const StrategyMetrics& s) const {
+        RankValue v;
+        for (size_t k = 0; k < keys_.size(); ++k) {
+            v.key[k] = key(k, s);
+        }
+        return v;
+    }
+
+    // True if a ranks strictly ahead of b
+    static bool before(const RankValue& a, const RankValue& b) {
+        for (size_t k = 0; k < MAX_RANK_KEYS; ++k) {
+            if (a.key[k] != b.key[k]) return a.key[k] > b.key[k];
+        }
+        return false;
+    }
+
+private:
+    enum class Column : uint8_t {
+        RR, GAIN, LOSS, COST, DEBIT, CREDIT, DELTA, THETA, VEGA, IV, LIQUIDITY, CONSTANT
+    };
+
+    struct Factor {
+        Column column;
+        bool divide;      // divides the running product instead of multiplying
+        double constant;  // value of a CONSTANT factor
+    };
+
+    struct Key {
+        std::vector<Factor> factors;
+        double sign;  // +1 largest first, -1 smallest first
+    };
+
+    static double factor(const Factor& f, const StrategyMetrics& s) {
+        switch (f.column) {
+            case Column::RR: return s.rr();
+            case Column::GAIN: return s.max_gain;
+            case Column::LOSS: return s.max_loss;
+            case Column::COST: return s.cost();
+            case Column::DEBIT: return s.debit;
+            case Column::CREDIT: return s.credit;
+            case Column::DELTA: return s.net_delta;
+            case Column::THETA: return s.net_theta;
+            case Column::VEGA: return s.net_vega;
+            case Column::IV: return s.iv;
+            case Column::LIQUIDITY: return s.liquidity;
+            case Column::CONSTANT: break;
+        }
+        return f.constant;
+    }
+
+    std::vector<Key> keys_;
+};
+
+#endif // RANK_ORDER_HPP
@@ -0,0 +1,34 @@
+#ifndef RUN_ARENA_HPP
+#define RUN_ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+// ===================== RUN ARENA =====================
+// Monotonic memory for one screening run. The shared arena holds what is
+// built before workers start (the ChainIndex) or after they finish; each
+// worker has its own arena for task buffers and generator scratch, so
+// workers never contend on an allocator. Nothing is freed until the arena
+// is destroyed at the end of the run, in one release per arena.
+class RunArena {
+public:
+    explicit RunArena(size_t workers) {
+        workers_.reserve(workers);
+        for (size_t w = 0; w < workers; ++w) {
+            workers_.push_back(std::make_unique<std::pmr::monotonic_buffer_resource>());
+        }
+    }
+
+    std::pmr::memory_resource* shared() { return &shared_; }
+
+    // Only ever used by worker w's thread
+    std::pmr::memory_resource* worker(size_t w) { return workers_[w].get(); }
+
+private:
+    std::pmr::monotonic_buffer_resource shared_;
+    std::vector<std::unique_ptr<std::pmr::monotonic_buffer_resource>> workers_;
+};
+
+#endif // RUN_ARENA_HPP
@@ -0,0 +1,64 @@
+#ifndef SCENARIO_HPP
+#define SCENARIO_HPP
+
+#include "object.hpp"
+#include "chain.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+class StrategyList;
+
+// ===================== SCENARIO MATRIX =====================
+// P&L of each strategy (rows) under each scenario of a grid (columns), in
+// dollars per strategy like the record metrics: the change in the legs'
+// value from now to the scenario, signed by leg. Under REPRICE "now" is the
+// model value at the current spot and IV, not the mid, so the unshifted
+// scenario is zero. Under GREEKS a leg whose delta, gamma, theta and vega
+// are all 0 (how the loader stores missing greeks) makes its strategies'
+// P&L NaN rather than contributing nothing.
+struct ScenarioMatrix {
+    ScenarioGrid grid;
+    size_t strategies = 0;
+    std::vector<double> pnl;  // strategies x grid.size(), row-major
+
+    size_t scenarios() const { return grid.size(); }
+    const double* row(size_t i) const { return pnl.data() + i * scenarios(); }
+    double at(size_t i, size_t s) const { return pnl[i * scenarios() + s]; }
+
+    // One line per strategy of list (the strategies the matrix was built
+    // for): its rank and name, then one column per scenario, headed
+    // "spot=+0.05;iv=-0.02;days=7"
+    void write_csv(std::FILE* out, const StrategyList& list) const;
+};
+
+// ===================== SCENARIO KERNEL =====================
+// The grid expanded into per-scenario columns (spot move, squared move, vol
+// move, days, shifted spot and its log) once, so valuing a leg under either
+// model is one branch-free pass over them (AVX-512/AVX2/baseline). REPRICE
+// uses the exp and normal CDF of bs_kernel.hpp.
+class ScenarioKernel {
+public:
+    ScenarioKernel(const ScenarioGrid& grid, double spot);
+
+    size_t size() const { return d_spot_.size(); }
+
+    // Per-share change in value of row under every scenario, into out[size()]
+    void leg(const OptionChain& chain, uint32_t row, double* out) const;
+
+    // out[0, n) += weight * leg[0, n)
+    static void accumulate(double* out, const double* leg, double weight, size_t n);
+
+private:
+    ScenarioModel model_;
+    double spot_;
+    std::vector<double> d_spot_;   // spot * shift
+    std::vector<double> d_spot2_;  // its square, halved
+    std::vector<double> d_vol_;    // absolute IV shift
+    std::vector<double> days_;
+    std::vector<double> spot_at_;      // spot + move
+    std::vector<double> log_spot_at_;  // its log
+};
+
+#endif // SCENARIO_HPP
@@ -0,0 +1,149 @@
+#ifndef STRATEGY_LEVEL_FILTER_HPP
+#define STRATEGY_LEVEL_FILTER_HPP
+
+#include "object.hpp"
+#include "strategy/strategy_class.hpp"
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <tuple>
+
+inline bool check_range(double value, const std::optional<std::tuple<double, double>>& range) {
+    if (!range.has_value()) return true;
+
+    // Handle NaN - NaN cannot be in any range
+    if (std::isnan(value)) return false;
+
+    auto [min_val, max_val] = range.value();
+    // Inclusive range check: min_val <= value <= max_val
+    // Infinity values are handled correctly by normal comparison:
+    // - inf <= finite_max is false, so inf outside finite range is correctly excluded
+    // - inf <= inf is true, so inf can be allowed if range includes infinity
+    return value >= min_val && value <= max_val;
+}
+
+// short_delta_range for a leg that is sold (always true if unset)
+inline bool sold_leg_passes(const ConfigFilter& cfg, double delta) {
+    return check_range(std::fabs(delta), cfg.short_delta_range);
+}
+
+// Strategy-level ConfigFilter criteria, in the order they are checked
+enum class StrategyCriterion : uint8_t {
+    NONE,  // passes every criterion
+    DEBIT,
+    CREDIT,
+    GAIN,
+    LOSS,
+    RR,
+    DELTA,
+    THETA,
+    VEGA,
+    IV,
+    COUNT
+};
+
+// Config key of a criterion, e.g. "debit_range"
+inline const char* strategy_criterion_name(StrategyCriterion criterion) {
+    switch (criterion) {
+        case StrategyCriterion::DEBIT: return "debit_range";
+        case StrategyCriterion::CREDIT: return "credit_range";
+        case StrategyCriterion::GAIN: return "potential_gain_range";
+        case StrategyCriterion::LOSS: return "potential_loss_range";
+        case StrategyCriterion::RR: return "rr_range";
+        case StrategyCriterion::DELTA: return "net_delta_range";
+        case StrategyCriterion::THETA: return "net_theta_range";
+        case StrategyCriterion::VEGA: return "net_vega_range";
+        case StrategyCriterion::IV: return "iv_range";
+        case StrategyCriterion::NONE:
+        case StrategyCriterion::COUNT: break;
+    }
+    return "none";
+}
+
+// First strategy-level ConfigFilter criterion the metrics fail, or NONE.
+// Shared by StrategyFactory and generators that filter while enumerating,
+// so both always agree.
+inline StrategyCriterion strategy_level_rejection(const ConfigFilter& c_filter,
+                                                  double debit, double credit,
+                                                  double max_gain, double max_loss, double rr,
+                                                  double net_delta, double net_theta, double net_vega,
+                                                  std::optional<double> avg_iv) {
+    // debit/credit ranges only apply to strategies that actually pay/receive
+    if (c_filter.debit_range.has_value() && debit > 0) {
+        if (!check_range(debit, c_filter.debit_range)) {
+            return StrategyCriterion::DEBIT;
+        }
+    }
+
+    if (c_filter.credit_range.has_value() && credit > 0) {
+        if (!check_range(credit, c_filter.credit_range)) {
+            return StrategyCriterion::CREDIT;
+        }
+    }
+
+    if (!check_range(max_gain, c_filter.potential_gain_range)) return StrategyCriterion::GAIN;
+    if (!check_range(max_loss, c_filter.potential_loss_range)) return StrategyCriterion::LOSS;
+    if (!check_range(rr, c_filter.rr_range)) return StrategyCriterion::RR;
+    if (!check_range(net_delta, c_filter.net_delta_range)) return StrategyCriterion::DELTA;
+    if (!check_range(net_theta, c_filter.net_theta_range)) return StrategyCriterion::THETA;
+    if (!check_range(net_vega, c_filter.net_vega_range)) return StrategyCriterion::VEGA;
+
+    if (avg_iv.has_value() && !check_range(avg_iv.value(), c_filter.iv_range)) {
+        return StrategyCriterion::IV;
+    }
+
+    return StrategyCriterion::NONE;
+}
+
+inline StrategyCriterion strategy_level_rejection(const ConfigFilter& c_filter, const StrategyMetrics& s) {
+    return strategy_level_rejection(c_filter, s.debit, s.credit, s.max_gain, s.max_loss, s.rr(),
+                                    s.net_delta, s.net_theta, s.net_vega, s.avg_iv());
+}
+
+inline bool passes_strategy_level_filters(const ConfigFilter& c_filter,
+                                          double debit, double credit,
+                                          double max_gain, double max_loss, double rr,
+                                          double net_delta, double net_theta, double net_vega,
+                                          std::optional<double> avg_iv) {
+    return strategy_level_rejection(c_filter, debit, credit, max_gain, max_loss, rr,
+                                    net_delta, net_theta, net_vega, avg_iv) == StrategyCriterion::NONE;
+}
+
+inline bool passes_strategy_level_filters(const ConfigFilter& c_filter, const StrategyMetrics& s) {
+    return strategy_level_rejection(c_filter, s) == StrategyCriterion::NONE;
+}
+
+// ===================== COMPILED STRATEGY FILTER =====================
+// The strategy-level ranges of a ConfigFilter as plain bounds, for kernels
+// that evaluate many strategies at once with the semantics above.
+struct CompiledStrategyFilter {
+    struct Range {
+        bool on = false;
+        double lo = 0.0;
+        double hi = 0.0;
+    };
+
+    Range debit, credit, gain, loss, rr, delta, theta, vega, iv;
+
+    explicit CompiledStrategyFilter(const ConfigFilter& cfg) {
+        auto compile = [](const std::optional<std::tuple<double, double>>& range) {
+            Range r;
+            if (range.has_value()) {
+                r.on = true;
+                std::tie(r.lo, r.hi) = range.value();
+            }
+            return r;
+        };
+        debit = compile(cfg.debit_range);
+        credit = compile(cfg.credit_range);
+        gain = compile(cfg.potential_gain_range);
+        loss = compile(cfg.potential_loss_range);
+        rr = compile(cfg.rr_range);
+        delta = compile(cfg.net_delta_range);
+        theta = compile(cfg.net_theta_range);
+        vega = compile(cfg.net_vega_range);
+        iv = compile(cfg.iv_range);
+    }
+};
+
+#endif // STRATEGY_LEVEL_FILTER_HPP
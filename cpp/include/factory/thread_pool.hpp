@@ -0,0 +1,59 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ===================== WORK-STEALING POOL =====================
+// Fixed set of workers, each with its own task deque. A worker pops from the
+// back of its own deque and, once that is empty, steals from the front of
+// the others. The thread calling run() works as worker 0.
+class WorkStealingPool {
+public:
+    using Task = std::function<void(size_t worker)>;
+
+    // threads == 0 uses every hardware thread
+    explicit WorkStealingPool(size_t threads);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Number of workers, including the calling thread
+    size_t size() const { return queues_.size(); }
+
+    // Runs every task and returns once all have finished. The first exception
+    // thrown by a task is rethrown here after the rest have run.
+    void run(const std::vector<Task>& tasks);
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<const Task*> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    uint64_t generation_ = 0;
+    bool stop_ = false;
+    std::atomic<size_t> remaining_{0};
+    std::exception_ptr error_;
+
+    bool pop(size_t worker, const Task*& task);
+    void drain(size_t worker);
+    void worker_loop(size_t worker);
+};
+
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,88 @@
+#ifndef INGEST_HPP
+#define INGEST_HPP
+
+#include "chain.hpp"
+#include "config.hpp"
+#include "factory/factory.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// ===================== INGEST SCREENER =====================
+// Screens a chain while it is still arriving. The input is a stream of
+// Tradier snapshots, one compact JSON document per line, usually one
+// expiration each (tradier.py --stream writes them as it fetches):
+//
+//   {"symbols": ["SPY"], "underlying": {"bid": 571.1, "ask": 571.2}, "chains": {}}
+//   {"symbols": ["SPY"], "chains": {"SPY": {"2025-10-31": [{...}, ...]}}}
+//
+// Every expiry is screened by the single-expiry structures on a worker as
+// soon as it is parsed and spot is known, so parsing and generation overlap
+// the wait for later expiries. Calendars and diagonals pair expiries, so
+// they run once the stream ends, over the assembled chain. The result is
+// that of StrategyFactory::top over the assembled chain, whose expiries are
+// in expiry order.
+class IngestScreener {
+public:
+    // config.threads workers (0 = every hardware thread)
+    explicit IngestScreener(const ScreenerConfig& config);
+    ~IngestScreener();
+
+    IngestScreener(const IngestScreener&) = delete;
+    IngestScreener& operator=(const IngestScreener&) = delete;
+
+    // Parses one line and queues each expiry in it; blank lines are skipped.
+    // The first spot price seen is kept. Throws on malformed JSON, a chain
+    // of another symbol or an expiry that already arrived.
+    void push(std::string_view line);
+
+    // Waits for the queued expiries, screens the cross-expiry structures and
+    // returns the ranked top_n over chain(). Rethrows the first worker
+    // error; throws if no spot price arrived. Call once.
+    StrategyList finish();
+
+    // Assembled chain, complete after finish()
+    const OptionChain& chain() const { return chain_; }
+    std::optional<double> spot() const { return spot_; }
+
+    // Expiries and rows received so far
+    size_t expiries() const { return segments_.size(); }
+    size_t rows() const { return rows_; }
+
+private:
+    // One expiry's rows as a chain of their own, and its screen: the top
+    // of each single-expiry generator, in schedule order
+    struct Segment {
+        OptionChain chain;
+        std::vector<StrategyList> tops;
+    };
+
+    void queue(Segment* segment);
+    void worker_loop();
+
+    ScreenerConfig config_;
+    StrategyFilter per_expiry_;    // config's structures within one expiry
+    StrategyFilter cross_expiry_;  // calendars and diagonals
+
+    std::optional<double> spot_;
+    OptionChain chain_;
+    size_t rows_ = 0;
+    std::vector<std::unique_ptr<Segment>> segments_;
+    std::vector<Segment*> pending_;  // waiting for spot
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<Segment*> queue_;
+    bool closed_ = false;
+    std::exception_ptr error_;
+    std::vector<std::thread> workers_;
+};
+
+#endif // INGEST_HPP
@@ -1,14 +1,54 @@
 #ifndef LOADER_HPP
 #define LOADER_HPP
 
-#include "object.hpp"
+#include "chain.hpp"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <tuple>
 #include <optional>
 #include <stdexcept>
+#include <ctime>
 
-std::tuple<std::vector<Option>, std::optional<double>> load_option_snapshot(const std::string& path);
+struct OptionCounters;
+
+// A Tradier JSON snapshot with its top-level timestamp (seconds since the
+// epoch), if it has one
+struct TradierSnapshot {
+    OptionChain chain;
+    std::optional<double> spot;
+    std::optional<double> timestamp;
+};
+
+TradierSnapshot read_option_snapshot(const std::string& path);
+
+std::tuple<OptionChain, std::optional<double>> load_option_snapshot(const std::string& path);
+
+// Same, keeping only the rows that pass the option-level criteria of filter
+// (min_volume, min_oi, min_price, volume_ratio_range, max_bid_ask_spread,
+// expiry, days_to_expiry_range). Rows are rejected while they are parsed,
+// and expiries failing expiry or days_to_expiry_range are never built.
+// OptionFilter::apply_filter on the result keeps every row. Dropped rows
+// are added to counters if given, rows of skipped expiries as expiry
+// rejections; ChainIndex adds the rest.
+std::tuple<OptionChain, std::optional<double>> load_option_snapshot(const std::string& path,
+                                                                    const ConfigFilter& filter,
+                                                                    OptionCounters* counters = nullptr);
+
+// A Tradier snapshot held in memory, e.g. one line of an ingest stream.
+// Unlike load_option_snapshot, a snapshot without a chain for symbols[0]
+// gives an empty chain of that symbol.
+std::tuple<OptionChain, std::optional<double>> parse_option_snapshot(std::string_view text);
+
+// Binary snapshot if path has SNAPSHOT_EXTENSION, Tradier JSON otherwise
+std::tuple<OptionChain, std::optional<double>> load_snapshot(const std::string& path);
+std::tuple<OptionChain, std::optional<double>> load_snapshot(const std::string& path, const ConfigFilter& filter,
+                                                             OptionCounters* counters = nullptr);
+
+// Whole days from now until the expiry date ("YYYY-MM-DD", local midnight)
+int calculate_days_to_expiry(const std::string& expiry_str);
+// Same, as of a point in time instead of now
+int calculate_days_to_expiry(const std::string& expiry_str, std::time_t as_of);
 
 #endif // LOADER_HPP
 
@@ -0,0 +1,132 @@
+#ifndef MEMORY_HPP
+#define MEMORY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// ===================== MEMORY ACCOUNTING =====================
+// Opt-in heap accounting. The counting allocator (src/memory_hook.cpp,
+// linked into the option_screener executable only) replaces the global
+// operator new/delete; until enable() it only tests a flag per call. Once
+// enabled it counts every allocation, by usable block size, process-wide and
+// per thread, tracks live and peak live bytes, and enforces the budget.
+//
+// Blocks allocated before enable() and freed after it are subtracted from
+// live bytes they were never added to, so live counts are signed and read
+// as relative to the enabling point.
+
+// What a scope allocated. peak_bytes is the highest live heap over the scope:
+// process-wide for stages, and for a thread scope the most its thread held
+// above what it held at the start.
+struct MemoryCounters {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+    uint64_t peak_bytes = 0;
+
+    // Sums allocations and bytes, keeps the higher peak
+    void merge(const MemoryCounters& other) {
+        allocations += other.allocations;
+        bytes += other.bytes;
+        if (other.peak_bytes > peak_bytes) peak_bytes = other.peak_bytes;
+    }
+};
+
+// Thrown by operator new when an allocation would take live bytes over the
+// budget; what() names the stage and sizes without allocating
+class MemoryBudgetExceeded : public std::bad_alloc {
+public:
+    MemoryBudgetExceeded(uint64_t budget, int64_t live, size_t requested, const char* stage);
+    const char* what() const noexcept override { return message_; }
+
+private:
+    char message_[192];
+};
+
+namespace memory {
+
+namespace detail {
+
+struct Tally {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+    int64_t live = 0;
+    int64_t peak = 0;
+};
+
+extern std::atomic<bool> counting;
+
+// Called by the counting allocator with a block's usable size. on_alloc
+// returns false, having counted nothing, if the block would exceed the budget.
+bool on_alloc(size_t bytes);
+void on_free(size_t bytes);
+[[noreturn]] void budget_exceeded(size_t requested);
+void install();
+
+Tally process_tally();
+Tally& thread_tally();
+
+}  // namespace detail
+
+// Whether the counting allocator is linked into this program
+bool available();
+
+// Starts counting; stays on until exit. Throws std::runtime_error if the
+// counting allocator is not available.
+void enable();
+inline bool enabled() { return detail::counting.load(std::memory_order_relaxed); }
+
+// Live-byte limit, 0 = none; enforced once enabled
+void set_budget(uint64_t bytes);
+uint64_t budget();
+
+// Throws MemoryBudgetExceeded if live bytes are over the budget, for callers
+// about to start more work
+void check_budget();
+
+int64_t live_bytes();
+int64_t peak_bytes();
+
+// Process peak resident set size (getrusage), 0 where unsupported
+uint64_t peak_rss_bytes();
+
+// Names the stage a budget failure reports; returns the previous name
+const char* enter_stage(const char* name);
+
+// Process-wide counters from construction to counters(). Scopes on one
+// thread may nest; each sees the peak inside itself.
+class Scope {
+public:
+    Scope();
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    MemoryCounters counters() const;
+
+private:
+    detail::Tally start_;
+    int64_t outer_peak_;
+};
+
+// The current thread's counters from construction to counters()
+class ThreadScope {
+public:
+    ThreadScope();
+    ~ThreadScope();
+
+    ThreadScope(const ThreadScope&) = delete;
+    ThreadScope& operator=(const ThreadScope&) = delete;
+
+    MemoryCounters counters() const;
+
+private:
+    detail::Tally start_;
+    int64_t outer_peak_;
+};
+
+}  // namespace memory
+
+#endif // MEMORY_HPP
@@ -1,17 +1,29 @@
 #ifndef OBJECT_HPP
 #define OBJECT_HPP
 
+#include <cmath>
+#include <cstdint>
 #include <string>
 #include <optional>
 #include <vector>
 #include <tuple>
 
+// ===================== SIDE =====================
+enum class Side : uint8_t {
+    CALL,
+    PUT
+};
+
+inline std::string side_to_string(Side side) {
+    return side == Side::CALL ? "CALL" : "PUT";
+}
+
 // ===================== OPTION =====================
 struct Option {
     std::string symbol;
     std::string expiry;
     double strike;
-    std::string side;  // "CALL" or "PUT"
+    Side side;
 
     double mid;
     double iv;
@@ -28,8 +40,8 @@ struct Option {
     std::optional<double> bid;
     std::optional<double> ask;
 
-    bool is_call() const { return side == "CALL"; }
-    bool is_put() const { return side == "PUT"; }
+    bool is_call() const { return side == Side::CALL; }
+    bool is_put() const { return side == Side::PUT; }
 
     bool is_otm(double spot) const {
         return (is_call() && strike > spot) || (is_put() && strike < spot);
@@ -54,7 +66,7 @@ struct Option {
     }
 
     std::string to_string() const {
-        return side + " " + std::to_string(strike) + " exp=" + expiry + 
+        return side_to_string(side) + " " + std::to_string(strike) + " exp=" + expiry + 
                " mid=" + std::to_string(mid) + " Δ=" + std::to_string(delta);
     }
 };
@@ -75,6 +87,10 @@ struct StrategyFilter {
     bool iron_condors = false;
     bool straddles = false;
     bool strangles = false;
+    bool verticals = false;    // call and put verticals
+    bool butterflies = false;  // call and put butterflies
+    bool calendars = false;    // call and put calendars
+    bool diagonals = false;    // call and put diagonals
 };
 
 // ===================== CONFIG FILTER =====================
@@ -88,6 +104,10 @@ struct ConfigFilter {
     std::optional<std::tuple<double, double>> volume_ratio_range;
     std::optional<double> max_bid_ask_spread;
 
+    // Leg-level filters, answered from the ChainIndex while legs are picked
+    std::optional<std::tuple<double, double>> short_delta_range;  // |delta| of every sold leg
+    std::optional<double> max_wing_width;  // strike distance of a leg placed above or below another
+
     // Strategy-level filters
     std::optional<Direction> direction;
     std::optional<std::tuple<double, double>> debit_range;
@@ -101,5 +121,36 @@ struct ConfigFilter {
     std::optional<std::tuple<double, double>> iv_range;
 };
 
+// ===================== SCENARIO GRID =====================
+enum class ScenarioModel {
+    GREEKS,   // delta, gamma, vega and theta expansion
+    REPRICE   // Black-Scholes (r = 0) at the shifted spot, IV and time
+};
+
+// Every combination of a spot shift, an IV shift and a number of days
+// forward. Scenario s is (spot, iv, days) index in row-major order.
+struct ScenarioGrid {
+    std::vector<double> spot_shifts = {0.0};   // fraction of spot, 0.05 = +5%
+    std::vector<double> iv_shifts = {0.0};     // absolute, 0.02 = +2 vol points
+    std::vector<double> days_forward = {0.0};
+    ScenarioModel model = ScenarioModel::GREEKS;
+
+    size_t size() const { return spot_shifts.size() * iv_shifts.size() * days_forward.size(); }
+};
+
+// Rows the pricing stage recomputes: those loaded without an IV or with no
+// greeks at all (MISSING), or every row (ALL)
+enum class PricingMode {
+    MISSING,
+    ALL
+};
+
+// Optional "pricing" section: IV solved from each row's mid, then
+// Black-Scholes greeks from it, at a continuous risk-free rate
+struct PricingConfig {
+    PricingMode mode = PricingMode::MISSING;
+    double rate = 0.0;
+};
+
 #endif // OBJECT_HPP
 
@@ -0,0 +1,136 @@
+#ifndef RESIDENT_HPP
+#define RESIDENT_HPP
+
+#include "object.hpp"
+#include "chain.hpp"
+#include "config.hpp"
+#include "factory/factory.hpp"
+#include "factory/option_filter.hpp"
+#include "strategy/strategy_class.hpp"
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// ===================== QUOTE UPDATE =====================
+// New quote and/or greeks for one contract; unset fields keep their value.
+// When bid, ask or last change, mid is recomputed the way the loader does:
+// (bid + ask) / 2 if both are known, otherwise last.
+// A contract is named by (expiry, strike, side) only. When several rows share
+// that key (adjusted roots list extra contracts at a strike), an update cannot
+// tell them apart and is counted as ambiguous instead of applied.
+struct QuoteUpdate {
+    std::string expiry;
+    double strike = 0.0;
+    Side side = Side::CALL;
+
+    std::optional<double> bid;
+    std::optional<double> ask;
+    std::optional<double> last;
+    std::optional<double> volume;
+    std::optional<double> oi;
+    std::optional<double> iv;
+    std::optional<double> delta;
+    std::optional<double> gamma;
+    std::optional<double> theta;
+    std::optional<double> vega;
+    std::optional<double> rho;
+};
+
+// One NDJSON line: an update object or an array of them, e.g.
+//   {"expiry": "2025-01-17", "strike": 100, "side": "call", "bid": 1.2, "ask": 1.3, "delta": 0.41}
+std::vector<QuoteUpdate> parse_quote_updates(const std::string& line);
+
+struct RescreenStats {
+    size_t quotes = 0;     // updates applied
+    size_t unknown = 0;    // updates for contracts not in the chain
+    size_t ambiguous = 0;  // updates matching several rows, not applied
+    size_t rescored = 0;   // candidate strategies recomputed
+};
+
+// ===================== RESIDENT SCREENER =====================
+// Long-running screen of one chain. Every strategy the enabled generators
+// can build from the chain's structure (expiry filters, direction, spot) is
+// kept as a candidate, regardless of quote-dependent filters, together with
+// an index from each leg row to the candidates that use it. A batch of quote
+// updates then recomputes only the candidates with a changed leg and moves
+// them within an ordered ranking of the passing ones, so the cost of a tick
+// depends on how many quotes changed, not on the size of the chain.
+//
+// top() always equals a fresh StrategyFactory::top over the current chain.
+// Spot is fixed for the session: OTM splits depend on it, so a new spot
+// needs a new ResidentScreener.
+class ResidentScreener {
+public:
+    ResidentScreener(OptionChain chain, double spot, const ScreenerConfig& config);
+
+    const OptionChain& chain() const { return chain_; }
+    double spot() const { return spot_; }
+
+    size_t candidates() const { return candidates_.size(); }
+    size_t passing() const { return ranking_.size(); }
+    // (expiry, strike, side) keys shared by more than one row
+    size_t ambiguous_contracts() const { return ambiguous_contracts_; }
+
+    // The row of a contract, or nullopt if none or several rows match
+    std::optional<uint32_t> find_row(const std::string& expiry, double strike, Side side) const;
+
+    // Applies every update, then rescores each affected candidate once
+    RescreenStats apply(const std::vector<QuoteUpdate>& updates);
+
+    // Best config.top_n passing strategies; valid until the next apply()
+    StrategyList top() const;
+
+private:
+    struct RankKey {
+        RankValue value;
+        uint32_t id;  // position in generation order, breaks ties
+    };
+
+    struct KeyBetter {
+        bool operator()(const RankKey& a, const RankKey& b) const {
+            if (RankOrder::before(a.value, b.value)) return true;
+            if (RankOrder::before(b.value, a.value)) return false;
+            return a.id < b.id;
+        }
+    };
+
+    void rescore(uint32_t id);
+    bool passes(const StrategyRecord& s) const;
+
+    OptionChain chain_;
+    double spot_;
+    ScreenerConfig config_;
+    CompiledOptionFilter option_filter_;
+
+    // Option-level filter result per row
+    std::vector<uint8_t> row_ok_;
+    // 1 if config.pricing recomputes the row's IV and greeks when its quote changes
+    std::vector<uint8_t> modeled_;
+
+    std::vector<StrategyRecord> candidates_;
+    RankOrder order_;
+    std::vector<RankValue> rank_value_;  // value in ranking_, if ranked_[id]
+    std::vector<uint8_t> ranked_;
+
+    // Candidates using row r: leg_candidates_[leg_offsets_[r], leg_offsets_[r + 1])
+    std::vector<uint32_t> leg_offsets_;
+    std::vector<uint32_t> leg_candidates_;
+
+    // Per-apply deduplication of rows and candidates
+    std::vector<uint32_t> row_stamp_;
+    std::vector<uint32_t> candidate_stamp_;
+    uint32_t epoch_ = 0;
+
+    // Row per contract key, AMBIGUOUS if the key is shared
+    static constexpr uint32_t AMBIGUOUS = std::numeric_limits<uint32_t>::max();
+    std::map<std::tuple<uint16_t, Side, double>, uint32_t> contracts_;
+    size_t ambiguous_contracts_ = 0;
+    std::set<RankKey, KeyBetter> ranking_;
+};
+
+#endif // RESIDENT_HPP
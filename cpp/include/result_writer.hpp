@@ -0,0 +1,150 @@
+#ifndef RESULT_WRITER_HPP
+#define RESULT_WRITER_HPP
+
+#include "chain.hpp"
+#include "strategy/strategy_class.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+// ===================== RESULT FORMATS =====================
+// Machine-readable alternatives to StrategyList::print, streamed row by row
+// through one buffered writer. Legs are written as contracts (side, signed
+// quantity, strike, expiry), so no output needs the chain to be read back.
+//
+//   CSV     one header line, then one line per strategy: symbol, kind,
+//           leg_count, leg1_side, leg1_qty, leg1_strike, leg1_expiry, ...
+//           for MAX_LEGS legs (empty past leg_count), then cost, debit,
+//           credit, max_gain, max_loss, rr, net_delta, net_theta, net_vega,
+//           iv and liquidity. Non-finite values are inf, -inf or nan.
+//   NDJSON  one object per line with the same fields and a "legs" array;
+//           non-finite values (unbounded gain or loss, missing IV) are null.
+//   BINARY  ResultFileHeader, then ResultBinaryRecord until end of file.
+//
+// Numbers are written in their shortest round-trip form.
+enum class ResultFormat {
+    TEXT,  // StrategyList::print
+    CSV,
+    NDJSON,
+    BINARY
+};
+
+// "text", "csv", "ndjson" (or "jsonl") or "binary"; throws std::invalid_argument
+ResultFormat parse_result_format(const std::string& name);
+
+// ===================== BINARY RESULT FORMAT =====================
+// Fixed-size little-endian records, so the file maps directly onto a
+// structured array (e.g. numpy.fromfile with a matching dtype, after
+// skipping the header). Expiries are yyyymmdd integers, 0 if unparsable;
+// the symbol is NUL-padded and truncated to 8 bytes.
+constexpr char RESULT_MAGIC[8] = {'O', 'R', 'E', 'S', 'U', 'L', 'T', '\0'};
+constexpr uint32_t RESULT_VERSION = 1;
+constexpr uint32_t RESULT_BYTE_ORDER = 0x01020304;
+
+struct ResultFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t record_size;  // sizeof(ResultBinaryRecord)
+    uint32_t reserved;
+};
+
+struct ResultBinaryRecord {
+    char symbol[8];
+    uint8_t kind;  // StrategyKind
+    uint8_t leg_count;
+    int8_t qty[MAX_LEGS];
+    uint8_t side[MAX_LEGS];  // 0 = CALL, 1 = PUT
+    uint8_t padding[2];
+    uint32_t expiry[MAX_LEGS];
+    uint32_t padding2;
+    double strike[MAX_LEGS];
+    double debit;
+    double credit;
+    double max_gain;
+    double max_loss;
+    double reward_risk;
+    double net_delta;
+    double net_theta;
+    double net_vega;
+    double iv;
+    double liquidity;
+};
+
+static_assert(sizeof(ResultFileHeader) == 24, "ResultFileHeader layout is part of the format");
+static_assert(sizeof(ResultBinaryRecord) == 152, "ResultBinaryRecord layout is part of the format");
+
+// ===================== RESULT ROW =====================
+// One strategy as written: its metrics and its legs resolved to contracts.
+// Views into the chain (or whatever owns the expiry strings) that must
+// outlive the row.
+struct ResultLeg {
+    Side side;
+    int8_t qty;
+    double strike;
+    std::string_view expiry;
+};
+
+struct ResultRow {
+    std::string_view symbol;
+    StrategyKind kind;
+    uint8_t leg_count;
+    ResultLeg legs[MAX_LEGS];
+    const StrategyMetrics* metrics;
+
+    static ResultRow of(const OptionChain& chain, const StrategyRecord& s, std::string_view symbol);
+};
+
+// ===================== RESULT WRITER =====================
+// Formats rows into a 64 KiB buffer that is written to out whenever the
+// next row might not fit. out is not owned. A write error throws
+// std::runtime_error from the write or flush that hits it; the destructor
+// flushes and ignores errors.
+class ResultWriter {
+public:
+    // format must not be TEXT; a BINARY or CSV writer starts with its header
+    ResultWriter(std::FILE* out, ResultFormat format);
+    ~ResultWriter();
+
+    ResultWriter(const ResultWriter&) = delete;
+    ResultWriter& operator=(const ResultWriter&) = delete;
+
+    void write(const ResultRow& row);
+
+    void write(const OptionChain& chain, const StrategyRecord& s, std::string_view symbol) {
+        write(ResultRow::of(chain, s, symbol));
+    }
+
+    void flush();
+
+    size_t rows() const { return rows_; }
+
+private:
+    static constexpr size_t CAPACITY = 64 * 1024;
+    static constexpr size_t MAX_ROW = 1024;  // a text row's numbers and punctuation, with room to spare
+
+    // Upper bound on the text of row
+    static size_t text_size(const ResultRow& row);
+
+    void write_csv(const ResultRow& row);
+    void write_ndjson(const ResultRow& row);
+    void write_binary(const ResultRow& row);
+
+    void put(char c) { buffer_[size_++] = c; }
+    void put(std::string_view s);
+    void put_number(double v);  // shortest round trip; inf, -inf, nan as such
+    void put_json_number(double v);  // null if not finite
+    void put_integer(int64_t v);
+    void put_bytes(const void* data, size_t n);
+    void reserve(size_t n);  // room for n more bytes
+    void drain();
+
+    std::FILE* out_;
+    ResultFormat format_;
+    std::string buffer_;
+    size_t size_ = 0;
+    size_t rows_ = 0;
+};
+
+#endif // RESULT_WRITER_HPP
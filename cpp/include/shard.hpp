@@ -0,0 +1,134 @@
+#ifndef SHARD_HPP
+#define SHARD_HPP
+
+#include "batch.hpp"
+#include "config.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ===================== SHARDED SCREENING =====================
+// Splits a batch screen across processes or machines. The work is a list of
+// units, the (input, task) pairs of every input's schedule in input order,
+// where a schedule splits large expiries into SHARD_PARTS short-strike
+// ranges whatever the worker's thread count. Shard i of N screens the units
+// u with u % N == i and keeps its top_n, each record tagged with its input
+// and (task, seq) emission position. merge_shards() ranks the union of all
+// N partials by (rank value, input, task, seq): the order the batch and
+// single-file screens use, so the merged ranking does not depend on N.
+//
+// Every shard loads and indexes every input to learn its task count; only
+// generation, which dominates, is split.
+constexpr uint32_t SHARD_PARTS = 64;
+
+// "i/N", 0 <= i < N
+struct ShardSpec {
+    uint32_t index = 0;
+    uint32_t count = 1;
+
+    static ShardSpec parse(const std::string& text);
+};
+
+// One strategy of a partial, with the position merge_shards() breaks ties by
+struct ShardStrategy {
+    uint64_t task;
+    uint64_t seq;
+    ScreenedStrategy strategy;
+};
+
+// What a shard sends back: its top_n over its units, per-input outcomes and
+// its ScreenStats as JSON
+struct ShardPartial {
+    // Every input, screened or not, so the merge can check that all shards
+    // saw the same list and report each failure once
+    struct Input {
+        std::string path;
+        std::string error;  // empty if loaded
+        uint32_t tasks = 0;
+    };
+
+    ShardSpec spec;
+    uint32_t parts = SHARD_PARTS;
+    uint64_t config_hash = 0;
+    uint64_t units = 0;  // units this shard screened
+    std::vector<Input> inputs;
+    std::vector<ShardStrategy> strategies;  // best first
+    std::string stats_json;
+};
+
+// FNV-1a of a config file's bytes; shards of one screen must agree on it
+uint64_t config_fingerprint(const std::string& path);
+
+// Screens spec's units of inputs with config; config.pareto is not supported
+ShardPartial run_shard(const ScreenerConfig& config, const std::vector<std::string>& inputs, ShardSpec spec,
+                       uint64_t config_hash);
+
+// ===================== SHARD FILE FORMAT =====================
+// A partial as one little-endian file (SHARD_EXTENSION):
+//   ShardFileHeader
+//   ShardFileInput[input_count]
+//   ShardFileRecord[record_count], best first
+//   string bytes: paths, errors, symbols, names, expiries and stats JSON,
+//   referenced by (offset, size) from the start of this section
+// Records carry metrics, kind, signs and legs by value, never chain rows, so
+// a partial is independent of the process that wrote it.
+constexpr char SHARD_MAGIC[8] = {'O', 'S', 'H', 'A', 'R', 'D', '\0', '\0'};
+constexpr uint32_t SHARD_VERSION = 1;
+constexpr uint32_t SHARD_BYTE_ORDER = 0x01020304;
+constexpr const char* SHARD_EXTENSION = ".oshard";
+
+struct ShardString {
+    uint32_t offset;
+    uint32_t size;
+};
+
+struct ShardFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t shard_index;
+    uint32_t shard_count;
+    uint32_t parts;
+    uint32_t input_count;
+    uint64_t config_hash;
+    uint64_t units;
+    uint64_t record_count;
+    uint64_t string_bytes;
+    ShardString stats_json;
+};
+
+struct ShardFileInput {
+    ShardString path;
+    ShardString error;
+    uint32_t tasks;
+    uint32_t loaded;
+};
+
+struct ShardFileRecord {
+    uint64_t task;
+    uint64_t seq;
+    StrategyMetrics metrics;
+    uint32_t input;
+    uint8_t kind;
+    uint8_t leg_count;
+    int8_t sign[MAX_LEGS];
+    uint8_t side[MAX_LEGS];
+    uint8_t reserved[2];
+    double strike[MAX_LEGS];
+    ShardString symbol;
+    ShardString name;
+    ShardString expiry[MAX_LEGS];
+};
+
+static_assert(sizeof(ShardFileHeader) == 72, "shard header layout");
+static_assert(sizeof(ShardFileInput) == 24, "shard input layout");
+static_assert(sizeof(ShardFileRecord) == 192, "shard record layout");
+
+void write_shard(const ShardPartial& partial, const std::string& path);
+ShardPartial read_shard(const std::string& path);
+
+// Global ranking of the partials of one screen. Throws unless they have the
+// same shard count, parts, config and inputs and are shards 0..N-1 once each.
+BatchResult merge_shards(const ScreenerConfig& config, const std::vector<ShardPartial>& partials);
+
+#endif // SHARD_HPP
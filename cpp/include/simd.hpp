@@ -0,0 +1,18 @@
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+// Hot loops are written branch-free over contiguous columns so the compiler
+// can vectorize them. SIMD_TARGET_CLONES builds AVX-512 and AVX2 versions of
+// a function next to the baseline one; the best supported version is picked
+// once at load time (GCC/Clang function multi-versioning on x86-64 Linux).
+// Helpers called from such a function are only built for each target when
+// they are inlined into it, which SIMD_INLINE forces.
+#if defined(__x86_64__) && defined(__linux__) && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_TARGET_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#define SIMD_INLINE __attribute__((always_inline)) inline
+#else
+#define SIMD_TARGET_CLONES
+#define SIMD_INLINE inline
+#endif
+
+#endif // SIMD_HPP
@@ -0,0 +1,75 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include "chain.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <tuple>
+#include <optional>
+
+struct OptionCounters;
+
+// ===================== BINARY SNAPSHOT FORMAT =====================
+// Columnar on-disk snapshot written once from a Tradier JSON dump.
+//
+// Layout (little-endian, every section 8-byte aligned):
+//   SnapshotHeader
+//   symbol bytes
+//   expiry offsets  uint32[expiry_count + 1] into the expiry bytes
+//   expiry bytes
+//   one column per SnapshotColumn, row_count entries each
+//
+// Missing bid/ask are stored as NaN. days_to_expiry is not stored because it
+// depends on the load time; it is computed once per expiry when loading.
+constexpr char SNAPSHOT_MAGIC[8] = {'O', 'S', 'N', 'A', 'P', '\0', '\0', '\0'};
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+constexpr uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+constexpr const char* SNAPSHOT_EXTENSION = ".osnap";
+
+enum SnapshotColumn : uint32_t {
+    COL_STRIKE,
+    COL_MID,
+    COL_IV,
+    COL_VOLUME,
+    COL_OI,
+    COL_BID,
+    COL_ASK,
+    COL_DELTA,
+    COL_GAMMA,
+    COL_THETA,
+    COL_VEGA,
+    COL_RHO,
+    COL_EXPIRY_ID,  // uint16
+    COL_SIDE,       // uint8, 0 = CALL, 1 = PUT
+    COL_COUNT
+};
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t row_count;
+    uint32_t expiry_count;
+    uint32_t has_spot;
+    uint32_t symbol_size;
+    double spot;
+    uint64_t symbol_offset;
+    uint64_t expiry_offsets_offset;
+    uint64_t expiry_bytes_offset;
+    uint64_t column_offset[COL_COUNT];
+};
+
+void write_binary_snapshot(const std::string& path,
+                           const OptionChain& chain,
+                           std::optional<double> spot);
+
+std::tuple<OptionChain, std::optional<double>> load_binary_snapshot(const std::string& path);
+
+// Only the rows passing the option-level criteria of filter, as with
+// load_option_snapshot(path, filter); dropped expiries leave the table
+std::tuple<OptionChain, std::optional<double>> load_binary_snapshot(const std::string& path,
+                                                                    const ConfigFilter& filter,
+                                                                    OptionCounters* counters = nullptr);
+
+#endif // SNAPSHOT_HPP
@@ -0,0 +1,134 @@
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include "factory/option_filter.hpp"
+#include "factory/strategy_level_filter.hpp"
+#include "memory.hpp"
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ===================== SCREEN STATS =====================
+// Optional instrumentation of one screening run. Everything that records
+// into it takes a ScreenStats* (or counters*) that is null when stats are
+// off, so a disabled run only pays a pointer test per stage or task.
+// Rejections are attributed to the first criterion a candidate fails, in
+// the order the filters check them. With memory set, stages and generator
+// tasks also record what they allocated (see memory.hpp).
+
+// Option-level filter outcome over every chain row
+struct OptionCounters {
+    uint64_t rows = 0;
+    uint64_t passed = 0;
+    uint64_t rejected[size_t(OptionCriterion::COUNT)] = {};
+};
+
+// Pricing stage outcome over the rows its mode selected: IV solved from the
+// mid, quoted IV kept (no usable mid) with greeks recomputed, or left as
+// loaded (rows = solved + quoted + failed)
+struct PricingCounters {
+    uint64_t rows = 0;
+    uint64_t solved = 0;
+    uint64_t quoted = 0;
+    uint64_t failed = 0;
+};
+
+// One generator's work. candidates were built and checked against the
+// strategy-level filters (candidates = passed + every rejected count);
+// pruned combos were skipped by metric bounds without being built.
+struct GeneratorCounters {
+    uint64_t tasks = 0;
+    double seconds = 0.0;  // summed over tasks, so thread-seconds when parallel
+    uint64_t candidates = 0;
+    uint64_t pruned = 0;
+    uint64_t passed = 0;
+    uint64_t rejected[size_t(StrategyCriterion::COUNT)] = {};
+    MemoryCounters memory;  // summed over tasks; peak_bytes is the largest task's
+
+    // Counts one checked candidate
+    void record(StrategyCriterion outcome) {
+        ++candidates;
+        if (outcome == StrategyCriterion::NONE) ++passed;
+        else ++rejected[size_t(outcome)];
+    }
+
+    void merge(const GeneratorCounters& other);
+};
+
+class ScreenStats {
+public:
+    // Stages keep the order of their first record; repeated names accumulate
+    void add_stage(const std::string& name, double seconds);
+    void add_stage_memory(const std::string& name, const MemoryCounters& counters);
+
+    OptionCounters& options() { return options_; }
+    // Listed in the JSON once used
+    PricingCounters& pricing() {
+        priced_ = true;
+        return pricing_;
+    }
+    GeneratorCounters& generator(const std::string& name);
+
+    size_t threads = 1;
+    // Record per-stage and per-generator memory; needs memory::enabled()
+    bool memory = false;
+
+    // One JSON object: threads, stages (seconds), options, pricing (if
+    // used), generators and, with memory, a memory section
+    std::string to_json(int indent = -1) const;
+
+private:
+    std::vector<std::pair<std::string, double>> stages_;
+    std::vector<std::pair<std::string, MemoryCounters>> stage_memory_;
+    OptionCounters options_;
+    PricingCounters pricing_;
+    bool priced_ = false;
+    std::vector<std::pair<std::string, GeneratorCounters>> generators_;
+};
+
+// Adds the wall time from construction to destruction as a stage of stats,
+// and its allocations when stats->memory is set; with memory accounting on
+// it also names the stage a budget failure reports. Does nothing when stats
+// is null and accounting is off.
+class StageTimer {
+public:
+    StageTimer(ScreenStats* stats, const char* name)
+        : stats_(stats), name_(name) {
+        if (memory::enabled()) {
+            staged_ = true;
+            outer_stage_ = memory::enter_stage(name);
+        }
+        if (stats_) {
+            if (stats_->memory && staged_) memory_.emplace();
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~StageTimer() {
+        if (stats_) {
+            stats_->add_stage(name_, elapsed());
+            if (memory_) stats_->add_stage_memory(name_, memory_->counters());
+        }
+        if (staged_) memory::enter_stage(outer_stage_);
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+    double elapsed() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+private:
+    ScreenStats* stats_;
+    const char* name_;
+    std::chrono::steady_clock::time_point start_;
+    bool staged_ = false;
+    const char* outer_stage_ = nullptr;
+    std::optional<memory::Scope> memory_;
+};
+
+#endif // STATS_HPP
@@ -0,0 +1,91 @@
+#ifndef COMBO_KERNEL_HPP
+#define COMBO_KERNEL_HPP
+
+#include "object.hpp"
+#include "chain.hpp"
+#include "factory/strategy_level_filter.hpp"
+#include "stats.hpp"
+#include "strategy/strategy_class.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+// ===================== COMBO KERNEL =====================
+// Metrics of a block of same-shaped strategies in one branch-free pass that
+// vectorizes across combos. The first `fixed` legs are shared by the whole
+// block (rows[l][0]); combo i takes rows[l][i] for every later leg. All
+// combos have the kind and leg signs of the block. The operations match the
+// make_* builders one for one, in leg order, and the kernel is built
+// without FMA contraction, so its metrics are bit-identical to theirs.
+struct ComboBlock {
+    StrategyKind kind;
+    uint8_t leg_count;
+    uint8_t fixed;
+    int8_t sign[MAX_LEGS];
+    const uint32_t* rows[MAX_LEGS];
+    size_t count;
+};
+
+// Output arrays with room for at least the block's count
+struct ComboMetrics {
+    double* debit;
+    double* credit;
+    double* max_gain;
+    double* max_loss;
+    double* reward_risk;
+    double* net_delta;
+    double* net_theta;
+    double* net_vega;
+    double* iv;
+    double* liquidity;
+    uint8_t* pass;  // 1 if the combo passes every strategy-level range
+};
+
+// Kinds whose metrics the kernel computes; the time spreads price their back
+// leg with Black-Scholes and are only built by their scalar builders
+constexpr bool kernel_supports(StrategyKind kind) {
+    return kind != StrategyKind::CALENDAR && kind != StrategyKind::DIAGONAL;
+}
+
+// Dispatched at load time to the AVX-512, AVX2 or baseline build
+void evaluate_combos(const OptionChain& chain, const ComboBlock& block,
+                     const CompiledStrategyFilter& filter, const ComboMetrics& out);
+
+// ===================== COMBO EVALUATOR =====================
+// Runs the kernel for one generator task and hands the combos passing the
+// strategy-level filters to emit as records, in combo order. Output arrays
+// come from the task's scratch arena and are reused across calls. Rejected
+// combos are recorded in a non-null counters.
+class ComboEvaluator {
+public:
+    static constexpr size_t BLOCK = 1024;
+
+    ComboEvaluator(const OptionChain& chain, StrategyKind kind, std::span<const int8_t> signs,
+                   const ConfigFilter& cfg, const std::function<void(const StrategyRecord&)>& emit,
+                   std::pmr::memory_resource* scratch, GeneratorCounters* counters = nullptr);
+
+    // Every combo of the fixed leading legs with varying[l][i] for the
+    // remaining legs, i in [0, count)
+    void run(std::span<const uint32_t> fixed, std::span<const uint32_t* const> varying, size_t count);
+
+private:
+    // Criterion that rejected combo i of the last block
+    void record_rejection(size_t i);
+
+    const OptionChain& chain_;
+    const ConfigFilter& cfg_;
+    const CompiledStrategyFilter filter_;
+    const std::function<void(const StrategyRecord&)>& emit_;
+    GeneratorCounters* counters_;
+    StrategyKind kind_;
+    uint8_t leg_count_ = 0;
+    int8_t sign_[MAX_LEGS] = {};
+
+    std::pmr::vector<double> columns_;  // one BLOCK-long array per metric
+    std::pmr::vector<uint8_t> pass_;
+};
+
+#endif // COMBO_KERNEL_HPP
@@ -2,244 +2,510 @@
 #define GENERATOR_CLASS_HPP
 
 #include "object.hpp"
-#include "factory/option_filter.hpp"
+#include "chain.hpp"
+#include "factory/chain_index.hpp"
 #include "strategy/strategy_class.hpp"
+#include "strategy/combo_kernel.hpp"
+#include "factory/strategy_level_filter.hpp"
+#include "stats.hpp"
 #include <vector>
 #include <memory>
-#include <map>
 #include <algorithm>
 #include <string>
+#include <functional>
+#include <memory_resource>
+#include <array>
+#include <optional>
+#include <span>
 
 // ===================== STRATEGY GENERATORS =====================
+// Generators read candidates from the run's shared ChainIndex; option-level
+// filtering, expiry grouping and strike sorting have already been done.
+// Each strategy is handed to the sink as soon as it is built, so callers
+// decide whether to keep it.
+using StrategySink = std::function<void(const StrategyRecord&)>;
+
+// An independent piece of one generator's work: leg 0 candidates [begin, end)
+// of index.expiries()[expiry], i.e. positions in its calls or puts
+// (index.rows()[begin, end) for single calls).
+struct GeneratorTask {
+    size_t expiry;
+    size_t begin;
+    size_t end;
+};
+
 class StrategyGenerator {
 public:
-    StrategyGenerator(const std::vector<Option>& options, double spot)
-        : options_(options), spot_(spot) {}
     virtual ~StrategyGenerator() = default;
 
-    virtual std::vector<std::unique_ptr<Strategy>> generate(const ConfigFilter& cfg) = 0;
-
-protected:
-    const std::vector<Option>& options_;
-    double spot_;
-};
-
-// ===================== SINGLE CALLS GENERATOR =====================
-class SingleCallsGenerator : public StrategyGenerator {
-public:
-    using StrategyGenerator::StrategyGenerator;
-
-    std::vector<std::unique_ptr<Strategy>> generate(const ConfigFilter& cfg) override {
-        std::vector<Option> opts = OptionFilter(
-            const_cast<std::vector<Option>&>(options_), spot_
-        ).apply_filter(cfg).result();
-
-        // Filter to only calls and OTM
-        std::vector<Option> filtered_opts;
-        for (const auto& opt : opts) {
-            if (opt.is_call() && opt.is_otm(spot_)) {
-                filtered_opts.push_back(opt);
-            }
+    // Tasks whose outputs, concatenated in order, are exactly generate()'s
+    // output. parts hints how many pieces the caller can run in parallel;
+    // the default is one task per expiry.
+    virtual std::vector<GeneratorTask> partition(const ChainIndex& index, size_t parts) const {
+        std::vector<GeneratorTask> tasks;
+        for (size_t e = 0; e < index.expiries().size(); ++e) {
+            tasks.push_back({e, 0, index.expiries()[e].calls.size()});
         }
+        return tasks;
+    }
 
-        std::string direction_str = direction_to_string(cfg.direction.value());
-        std::string action = (direction_str == "SHORT") ? "SELL" : "BUY";
-
-        std::vector<std::unique_ptr<Strategy>> strategies;
-        for (const auto& opt : filtered_opts) {
-            strategies.push_back(
-                std::make_unique<SingleLeg>(opt, action, direction_str)
-            );
+    // Temporaries that live for one task are allocated from scratch, which
+    // is only ever used by the calling thread. Generators that filter while
+    // enumerating record what they reject or prune in a non-null counters;
+    // emitted strategies are left to the caller to count.
+    virtual void generate_task(const ChainIndex& index, const ConfigFilter& cfg, const GeneratorTask& task,
+                               const StrategySink& emit, std::pmr::memory_resource* scratch,
+                               GeneratorCounters* counters) = 0;
+
+    void generate(const ChainIndex& index, const ConfigFilter& cfg, const StrategySink& emit) {
+        for (const GeneratorTask& task : partition(index, 1)) {
+            generate_task(index, cfg, task, emit, std::pmr::get_default_resource(), nullptr);
         }
+    }
 
+    // Every generated strategy, in emission order
+    std::vector<StrategyRecord> collect(const ChainIndex& index, const ConfigFilter& cfg) {
+        std::vector<StrategyRecord> strategies;
+        generate(index, cfg, [&](const StrategyRecord& s) { strategies.push_back(s); });
         return strategies;
     }
 };
 
-// ===================== IRON CONDORS GENERATOR =====================
-class IronCondorsGenerator : public StrategyGenerator {
-public:
-    using StrategyGenerator::StrategyGenerator;
+// ===================== COMBO ENGINE =====================
+// Generic generator over a structure type S, which lists its legs in
+// enumeration order as constexpr LegRules. Leg l is picked from the calls or
+// puts of an expiry slice, sorted by strike, within a strike range fixed by
+// spot or by an earlier leg; every rule is a compile-time constant, so each
+// structure compiles to its own nest of loops. The leg-level filters narrow
+// those ranges further: max_wing_width bounds ABOVE and BELOW legs, and a
+// sold leg is picked only from its slice's short range. The last leg's range is
+// handed over whole: to the combo kernel, which evaluates and filters it in
+// one pass, or to S::build one row at a time for kinds the kernel does not
+// cover.
+//
+// S provides:
+//   KIND, LEGS (std::array<LegRule, N>), DIRECTED (SHORT negates every sign)
+//   build(chain, rows, direction) -> StrategyRecord, rows in leg order
+// and optionally:
+//   ALL_ROWS   single-leg structures that scan index.rows() in chain order
+//   partition(index, parts), replacing one task per expiry
+//   Pruner, constructed per task as Pruner(chain, slice, cfg, scratch), with
+//     empty() (nothing to generate) and check<L>(rows, pos, end, counters),
+//     called once leg L < N - 1 is picked at rows[L] = candidates[pos]
+enum class StrikeRule : uint8_t {
+    ANY,     // every strike
+    OTM,     // calls above spot, puts below spot
+    ABOVE,   // strike > strike of leg ref
+    BELOW,   // strike < strike of leg ref
+    EQUAL,   // strike == strike of leg ref
+    SAME,    // the row of leg ref itself, not every row at its strike
+    MIRROR,  // strike == 2 * strike of leg ref - strike of leg ref2 (equal wings)
+};
 
-    std::vector<std::unique_ptr<Strategy>> generate(const ConfigFilter& cfg) override {
-        std::vector<Option> opts = OptionFilter(
-            const_cast<std::vector<Option>&>(options_), spot_
-        ).apply_filter(cfg).result();
+struct LegRule {
+    Side side;
+    StrikeRule strike = StrikeRule::ANY;
+    uint8_t ref = 0;
+    uint8_t ref2 = 0;
+    bool later_expiry = false;  // from any slice after leg 0's instead of leg 0's own
+    int8_t sign = 1;            // quantity when LONG
+};
 
-        std::string direction_str = direction_to_string(cfg.direction.value());
+// What a Pruner decides for a picked leg
+enum class LegStep : uint8_t {
+    KEEP,  // go on to the next leg
+    SKIP,  // no combination through this pick can pass
+    STOP,  // nor through any later candidate of this leg
+};
 
-        // Group by expiry
-        std::map<std::string, std::vector<Option>> expiry_map;
-        for (const auto& opt : opts) {
-            expiry_map[opt.expiry].push_back(opt);
-        }
+// S::Pruner, or a stand-in that is never called
+struct NoPruner {};
 
-        std::vector<std::unique_ptr<Strategy>> strategies;
-        for (auto& [expiry, chain] : expiry_map) {
-            std::vector<Option> calls, puts;
-            for (const auto& opt : chain) {
-                if (opt.is_call()) calls.push_back(opt);
-                if (opt.is_put()) puts.push_back(opt);
-            }
+template <class S>
+struct PrunerOf {
+    using type = NoPruner;
+};
 
-            std::sort(calls.begin(), calls.end(), 
-                [](const Option& a, const Option& b) { return a.strike < b.strike; });
-            std::sort(puts.begin(), puts.end(), 
-                [](const Option& a, const Option& b) { return a.strike < b.strike; });
+template <class S>
+    requires requires { typename S::Pruner; }
+struct PrunerOf<S> {
+    using type = typename S::Pruner;
+};
 
-            // Short calls are above spot
-            std::vector<Option> short_calls;
-            for (const auto& c : calls) {
-                if (c.strike > spot_) {
-                    short_calls.push_back(c);
-                }
-            }
+template <class S>
+class ComboGenerator : public StrategyGenerator {
+public:
+    std::vector<GeneratorTask> partition(const ChainIndex& index, size_t parts) const override;
 
-            // Short puts are below spot
-            std::vector<Option> short_puts;
-            for (const auto& p : puts) {
-                if (p.strike < spot_) {
-                    short_puts.push_back(p);
-                }
-            }
+    void generate_task(const ChainIndex& index, const ConfigFilter& cfg, const GeneratorTask& task,
+                       const StrategySink& emit, std::pmr::memory_resource* scratch,
+                       GeneratorCounters* counters) override;
 
-            // Generate iron condor combinations
-            for (const auto& short_call : short_calls) {
-                // Buy calls above short call
-                std::vector<Option> buy_calls;
-                for (const auto& c : calls) {
-                    if (c.strike > short_call.strike) {
-                        buy_calls.push_back(c);
-                    }
-                }
+private:
+    static constexpr size_t LEGS = S::LEGS.size();
+    static constexpr bool ALL_ROWS = requires { S::ALL_ROWS; };
+    static constexpr bool PRUNED = requires { typename S::Pruner; };
+    static constexpr bool KERNEL = kernel_supports(S::KIND) && !ALL_ROWS;
+    static_assert(!ALL_ROWS || LEGS == 1, "ALL_ROWS is for single-leg structures");
+    static_assert(!S::LEGS[0].later_expiry, "leg 0 sets the expiry");
 
-                for (const auto& buy_call : buy_calls) {
-                    for (const auto& short_put : short_puts) {
-                        // Buy puts below short put
-                        std::vector<Option> buy_puts;
-                        for (const auto& p : puts) {
-                            if (p.strike < short_put.strike) {
-                                buy_puts.push_back(p);
-                            }
-                        }
-
-                        for (const auto& buy_put : buy_puts) {
-                            strategies.push_back(
-                                std::make_unique<IronCondor>(
-                                    short_call, buy_call, short_put, buy_put, direction_str
-                                )
-                            );
-                        }
-                    }
-                }
-            }
-        }
+    template <class Pruner>
+    struct Run;
 
-        return strategies;
+    static const std::pmr::vector<uint32_t>& candidates(const ExpirySlice& slice, Side side) {
+        return side == Side::CALL ? slice.calls : slice.puts;
     }
 };
 
-// ===================== STRADDLES GENERATOR =====================
-class StraddlesGenerator : public StrategyGenerator {
-public:
-    using StrategyGenerator::StrategyGenerator;
+// Per-task state: the legs picked so far and where the last one goes
+template <class S>
+template <class Pruner>
+struct ComboGenerator<S>::Run {
+    const ChainIndex& index;
+    const OptionChain& chain;
+    const GeneratorTask& task;
+    const StrategySink& emit;
+    Pruner* pruner;
+    GeneratorCounters* counters;
+    Direction direction;
+    std::optional<ComboEvaluator> evaluator;
+    uint32_t rows[LEGS] = {};
+
+    // Leg-level filters
+    const ConfigFilter* cfg = nullptr;
+    bool sold[LEGS] = {};
+    std::pmr::vector<uint32_t> kept{};  // a sold last leg's candidates on a side that is not delta-monotone
+
+    // Candidate positions of leg L in a sorted side of slice
+    template <size_t L>
+    std::pair<size_t, size_t> range(const ExpirySlice& slice, const std::pmr::vector<uint32_t>& sorted) const {
+        constexpr LegRule rule = S::LEGS[L];
+        const double* strike = chain.strike.data();
+        auto lower = [&](double value) {
+            return size_t(std::partition_point(sorted.begin(), sorted.end(),
+                [&](uint32_t r) { return strike[r] < value; }) - sorted.begin());
+        };
+        auto upper = [&](double value) {
+            return size_t(std::partition_point(sorted.begin(), sorted.end(),
+                [&](uint32_t r) { return strike[r] <= value; }) - sorted.begin());
+        };
+
+        if constexpr (rule.strike == StrikeRule::ANY) {
+            return {0, sorted.size()};
+        } else if constexpr (rule.strike == StrikeRule::OTM) {
+            if constexpr (rule.side == Side::CALL) return {slice.otm_call_begin, sorted.size()};
+            else return {0, slice.otm_put_end};
+        } else if constexpr (rule.strike == StrikeRule::ABOVE) {
+            const double k = strike[rows[rule.ref]];
+            if (!cfg->max_wing_width.has_value()) return {upper(k), sorted.size()};
+            const double far = k + cfg->max_wing_width.value();
+            return {upper(k), upper(far + 1e-6 * std::max(1.0, std::fabs(far)))};
+        } else if constexpr (rule.strike == StrikeRule::BELOW) {
+            const double k = strike[rows[rule.ref]];
+            if (!cfg->max_wing_width.has_value()) return {0, lower(k)};
+            const double far = k - cfg->max_wing_width.value();
+            return {lower(far - 1e-6 * std::max(1.0, std::fabs(far))), lower(k)};
+        } else if constexpr (rule.strike == StrikeRule::EQUAL) {
+            const double k = strike[rows[rule.ref]];
+            return {lower(k), upper(k)};
+        } else if constexpr (rule.strike == StrikeRule::SAME) {
+            // Adjusted roots can list several contracts at one strike
+            const uint32_t row = rows[rule.ref];
+            for (size_t p = lower(strike[row]); p < sorted.size() && strike[sorted[p]] == strike[row]; ++p) {
+                if (sorted[p] == row) return {p, p + 1};
+            }
+            return {0, 0};
+        } else {
+            // Strikes are decimal prices, so the mirrored wing is matched
+            // with a small tolerance
+            const double k = 2.0 * strike[rows[rule.ref]] - strike[rows[rule.ref2]];
+            const double tolerance = 1e-6 * std::max(1.0, std::fabs(k));
+            return {lower(k - tolerance), upper(k + tolerance)};
+        }
+    }
 
-    std::vector<std::unique_ptr<Strategy>> generate(const ConfigFilter& cfg) override {
-        std::vector<Option> opts = OptionFilter(
-            const_cast<std::vector<Option>&>(options_), spot_
-        ).apply_filter(cfg).result();
+    template <size_t L>
+    void leg() {
+        if constexpr (S::LEGS[L].later_expiry) {
+            for (size_t e = task.expiry + 1; e < index.expiries().size(); ++e) {
+                pick<L>(index.expiries()[e]);
+            }
+        } else {
+            pick<L>(index.expiries()[task.expiry]);
+        }
+    }
 
-        std::string direction_str = direction_to_string(cfg.direction.value());
+    template <size_t L>
+    void pick(const ExpirySlice& slice) {
+        constexpr LegRule rule = S::LEGS[L];
+        const auto& sorted = candidates(slice, rule.side);
+        auto [begin, end] = range<L>(slice, sorted);
+        if constexpr (L == 0) {
+            begin = std::max(begin, task.begin);
+            end = std::min(end, task.end);
+        }
+        bool check_delta = false;
+        if (sold[L] && cfg->short_delta_range.has_value()) {
+            const auto [short_begin, short_end] = slice.short_range(rule.side);
+            begin = std::max(begin, short_begin);
+            end = std::min(end, short_end);
+            check_delta = !slice.delta_monotone(rule.side);
+        }
+        if (begin >= end) return;
 
-        // Group by expiry
-        std::map<std::string, std::vector<Option>> expiry_map;
-        for (const auto& opt : opts) {
-            expiry_map[opt.expiry].push_back(opt);
+        if constexpr (L + 1 == LEGS) {
+            if (check_delta) {
+                kept.clear();
+                for (size_t k = begin; k < end; ++k) {
+                    if (sold_leg_passes(*cfg, chain.delta[sorted[k]])) kept.push_back(sorted[k]);
+                }
+                if (!kept.empty()) last(kept.data(), kept.size());
+            } else {
+                last(sorted.data() + begin, end - begin);
+            }
+        } else {
+            for (size_t k = begin; k < end; ++k) {
+                if (check_delta && !sold_leg_passes(*cfg, chain.delta[sorted[k]])) continue;
+                rows[L] = sorted[k];
+                if constexpr (PRUNED) {
+                    LegStep step = pruner->template check<L>(rows, k, end, counters);
+                    if (step == LegStep::STOP) break;
+                    if (step == LegStep::SKIP) continue;
+                }
+                leg<L + 1>();
+            }
         }
+    }
 
-        std::vector<std::unique_ptr<Strategy>> strategies;
-        for (auto& [expiry, chain] : expiry_map) {
-            std::vector<Option> calls, puts;
-            for (const auto& opt : chain) {
-                if (opt.is_call()) calls.push_back(opt);
-                if (opt.is_put()) puts.push_back(opt);
+    // Every combination of rows[0, LEGS - 1) with a last leg in candidates
+    void last(const uint32_t* candidates, size_t count) {
+        if constexpr (KERNEL) {
+            const uint32_t* varying[1] = {candidates};
+            evaluator->run(std::span<const uint32_t>(rows, LEGS - 1), varying, count);
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                rows[LEGS - 1] = candidates[i];
+                emit(S::build(chain, rows, direction));
             }
+        }
+    }
 
-            std::sort(calls.begin(), calls.end(), 
-                [](const Option& a, const Option& b) { return a.strike < b.strike; });
-            std::sort(puts.begin(), puts.end(), 
-                [](const Option& a, const Option& b) { return a.strike < b.strike; });
-
-            // Find call and put at same strike
-            for (const auto& call : calls) {
-                for (const auto& put : puts) {
-                    if (call.strike == put.strike) {
-                        strategies.push_back(
-                            std::make_unique<Straddle>(call, put, direction_str)
-                        );
-                    }
-                }
+    // ALL_ROWS: leg 0's side and moneyness over index.rows()[task.begin, task.end)
+    void scan_rows() {
+        constexpr LegRule rule = S::LEGS[0];
+        static_assert(rule.strike == StrikeRule::ANY || rule.strike == StrikeRule::OTM);
+        for (size_t k = task.begin; k < task.end; ++k) {
+            const uint32_t i = index.rows()[k];
+            if (chain.side[i] != rule.side) continue;
+            if constexpr (rule.strike == StrikeRule::OTM) {
+                const bool otm = rule.side == Side::CALL ? chain.strike[i] > index.spot()
+                                                         : chain.strike[i] < index.spot();
+                if (!otm) continue;
             }
+            if (sold[0] && !sold_leg_passes(*cfg, chain.delta[i])) continue;
+            rows[0] = i;
+            emit(S::build(chain, rows, direction));
         }
+    }
+};
 
-        return strategies;
+template <class S>
+std::vector<GeneratorTask> ComboGenerator<S>::partition(const ChainIndex& index, size_t parts) const {
+    if constexpr (requires { S::partition(index, parts); }) {
+        return S::partition(index, parts);
+    } else if constexpr (ALL_ROWS) {
+        return {{0, 0, index.rows().size()}};
+    } else {
+        std::vector<GeneratorTask> tasks;
+        for (size_t e = 0; e < index.expiries().size(); ++e) {
+            tasks.push_back({e, 0, candidates(index.expiries()[e], S::LEGS[0].side).size()});
+        }
+        return tasks;
+    }
+}
+
+template <class S>
+void ComboGenerator<S>::generate_task(const ChainIndex& index, const ConfigFilter& cfg, const GeneratorTask& task,
+                                      const StrategySink& emit, std::pmr::memory_resource* scratch,
+                                      GeneratorCounters* counters) {
+    const OptionChain& chain = index.chain();
+    const Direction direction = S::DIRECTED ? cfg.direction.value() : Direction::LONG;
+    std::array<int8_t, LEGS> signs;
+    for (size_t l = 0; l < LEGS; ++l) {
+        signs[l] = direction == Direction::SHORT ? -S::LEGS[l].sign : S::LEGS[l].sign;
+    }
+    auto leg_filters = [&](auto& run) {
+        run.cfg = &cfg;
+        run.kept = std::pmr::vector<uint32_t>(scratch);
+        for (size_t l = 0; l < LEGS; ++l) run.sold[l] = signs[l] < 0;
+    };
+
+    if constexpr (ALL_ROWS) {
+        Run<NoPruner> run{index, chain, task, emit, nullptr, counters, direction, std::nullopt};
+        leg_filters(run);
+        run.scan_rows();
+        return;
+    } else {
+        using Pruner = typename PrunerOf<S>::type;
+        std::optional<Pruner> pruner;
+        if constexpr (PRUNED) {
+            pruner.emplace(chain, index.expiries()[task.expiry], cfg, scratch);
+            if (pruner->empty()) return;
+        }
+
+        Run<Pruner> run{index, chain, task, emit, pruner ? &*pruner : nullptr, counters, direction, std::nullopt};
+        leg_filters(run);
+        if constexpr (KERNEL) {
+            run.evaluator.emplace(chain, S::KIND, signs, cfg, emit, scratch, counters);
+        }
+        run.template leg<0>();
+    }
+}
+
+// ===================== STRUCTURES =====================
+// Leg signs are for LONG; SHORT negates them in DIRECTED structures.
+struct SingleCall {
+    static constexpr StrategyKind KIND = StrategyKind::SINGLE_LEG;
+    static constexpr std::array<LegRule, 1> LEGS = {{{Side::CALL, StrikeRule::OTM}}};
+    static constexpr bool DIRECTED = true;
+    static constexpr bool ALL_ROWS = true;
+
+    static StrategyRecord build(const OptionChain& chain, const uint32_t* rows, Direction direction) {
+        return make_single_leg(chain, rows[0], direction != Direction::SHORT);
     }
 };
 
-// ===================== STRANGLES GENERATOR =====================
-class StranglesGenerator : public StrategyGenerator {
-public:
-    using StrategyGenerator::StrategyGenerator;
+// Short call, buy call above it, short put, buy put below it; always sold.
+// Strategy-level filters are pushed into the enumeration: interval bounds
+// on each metric over a whole wing range let the Pruner skip (short call,
+// buy call) and (short call, buy call, short put) prefixes that cannot
+// contain a passing condor.
+struct IronCondor {
+    static constexpr StrategyKind KIND = StrategyKind::IRON_CONDOR;
+    static constexpr std::array<LegRule, 4> LEGS = {{
+        {Side::CALL, StrikeRule::OTM, 0, 0, false, -1},
+        {Side::CALL, StrikeRule::ABOVE, 0, 0, false, 1},
+        {Side::PUT, StrikeRule::OTM, 0, 0, false, -1},
+        {Side::PUT, StrikeRule::BELOW, 2, 0, false, 1},
+    }};
+    static constexpr bool DIRECTED = false;
+
+    static StrategyRecord build(const OptionChain& chain, const uint32_t* rows, Direction) {
+        return make_iron_condor(chain, rows[0], rows[1], rows[2], rows[3]);
+    }
 
-    std::vector<std::unique_ptr<Strategy>> generate(const ConfigFilter& cfg) override {
-        std::vector<Option> opts = OptionFilter(
-            const_cast<std::vector<Option>&>(options_), spot_
-        ).apply_filter(cfg).result();
+    // Large expiries are split into short-call ranges of similar size
+    static std::vector<GeneratorTask> partition(const ChainIndex& index, size_t parts);
 
-        std::string direction_str = direction_to_string(cfg.direction.value());
+    class Pruner;
+};
 
-        // Group by expiry
-        std::map<std::string, std::vector<Option>> expiry_map;
-        for (const auto& opt : opts) {
-            expiry_map[opt.expiry].push_back(opt);
-        }
+// Call and put at the same strike
+struct Straddle {
+    static constexpr StrategyKind KIND = StrategyKind::STRADDLE;
+    static constexpr std::array<LegRule, 2> LEGS = {{
+        {Side::CALL, StrikeRule::ANY},
+        {Side::PUT, StrikeRule::EQUAL, 0},
+    }};
+    static constexpr bool DIRECTED = true;
+
+    static StrategyRecord build(const OptionChain& chain, const uint32_t* rows, Direction direction) {
+        return make_straddle(chain, rows[0], rows[1], direction);
+    }
+};
 
-        std::vector<std::unique_ptr<Strategy>> strategies;
-        for (auto& [expiry, chain] : expiry_map) {
-            // OTM calls (strike > spot)
-            std::vector<Option> calls;
-            for (const auto& opt : chain) {
-                if (opt.is_call() && opt.strike > spot_) {
-                    calls.push_back(opt);
-                }
-            }
+// OTM call + OTM put
+struct Strangle {
+    static constexpr StrategyKind KIND = StrategyKind::STRANGLE;
+    static constexpr std::array<LegRule, 2> LEGS = {{
+        {Side::CALL, StrikeRule::OTM},
+        {Side::PUT, StrikeRule::OTM},
+    }};
+    static constexpr bool DIRECTED = true;
+
+    static StrategyRecord build(const OptionChain& chain, const uint32_t* rows, Direction direction) {
+        return make_strangle(chain, rows[0], rows[1], direction);
+    }
+};
 
-            // OTM puts (strike < spot)
-            std::vector<Option> puts;
-            for (const auto& opt : chain) {
-                if (opt.is_put() && opt.strike < spot_) {
-                    puts.push_back(opt);
-                }
-            }
+// LONG buys the near strike and sells one further out: bull call spreads,
+// bear put spreads; SHORT gives the credit spreads
+template <Side SIDE>
+struct Vertical {
+    static constexpr StrategyKind KIND = StrategyKind::VERTICAL;
+    static constexpr std::array<LegRule, 2> LEGS = {{
+        {SIDE, StrikeRule::ANY, 0, 0, false, 1},
+        {SIDE, SIDE == Side::CALL ? StrikeRule::ABOVE : StrikeRule::BELOW, 0, 0, false, -1},
+    }};
+    static constexpr bool DIRECTED = true;
+
+    static StrategyRecord build(const OptionChain& chain, const uint32_t* rows, Direction direction) {
+        return make_vertical(chain, rows[0], rows[1], direction);
+    }
+};
 
-            std::sort(calls.begin(), calls.end(), 
-                [](const Option& a, const Option& b) { return a.strike < b.strike; });
-            std::sort(puts.begin(), puts.end(), 
-                [](const Option& a, const Option& b) { return a.strike < b.strike; });
-
-            // Generate strangle combinations: OTM call + OTM put
-            for (const auto& call : calls) {
-                for (const auto& put : puts) {
-                    strategies.push_back(
-                        std::make_unique<Strangle>(call, put, direction_str)
-                    );
-                }
-            }
-        }
+// Low wing, body sold twice, high wing at the same distance; LONG buys the wings
+template <Side SIDE>
+struct Butterfly {
+    static constexpr StrategyKind KIND = StrategyKind::BUTTERFLY;
+    static constexpr std::array<LegRule, 4> LEGS = {{
+        {SIDE, StrikeRule::ANY, 0, 0, false, 1},
+        {SIDE, StrikeRule::ABOVE, 0, 0, false, -1},
+        {SIDE, StrikeRule::SAME, 1, 0, false, -1},
+        {SIDE, StrikeRule::MIRROR, 1, 0, false, 1},
+    }};
+    static constexpr bool DIRECTED = true;
+
+    static StrategyRecord build(const OptionChain& chain, const uint32_t* rows, Direction direction) {
+        return make_butterfly(chain, rows[0], rows[1], rows[3], direction);
+    }
+};
 
-        return strategies;
+// Sell front, buy the same strike in a later expiry; always bought
+template <Side SIDE>
+struct Calendar {
+    static constexpr StrategyKind KIND = StrategyKind::CALENDAR;
+    static constexpr std::array<LegRule, 2> LEGS = {{
+        {SIDE, StrikeRule::ANY, 0, 0, false, -1},
+        {SIDE, StrikeRule::EQUAL, 0, 0, true, 1},
+    }};
+    static constexpr bool DIRECTED = false;
+
+    static StrategyRecord build(const OptionChain& chain, const uint32_t* rows, Direction) {
+        return make_calendar(chain, rows[0], rows[1]);
     }
 };
 
-#endif // GENERATOR_CLASS_HPP
+// Sell front, buy a later expiry at a strike closer to the money; always bought
+template <Side SIDE>
+struct Diagonal {
+    static constexpr StrategyKind KIND = StrategyKind::DIAGONAL;
+    static constexpr std::array<LegRule, 2> LEGS = {{
+        {SIDE, StrikeRule::ANY, 0, 0, false, -1},
+        {SIDE, SIDE == Side::CALL ? StrikeRule::BELOW : StrikeRule::ABOVE, 0, 0, true, 1},
+    }};
+    static constexpr bool DIRECTED = false;
+
+    static StrategyRecord build(const OptionChain& chain, const uint32_t* rows, Direction) {
+        return make_diagonal(chain, rows[0], rows[1]);
+    }
+};
 
+// ===================== GENERATORS =====================
+using SingleCallsGenerator = ComboGenerator<SingleCall>;
+using IronCondorsGenerator = ComboGenerator<IronCondor>;
+using StraddlesGenerator = ComboGenerator<Straddle>;
+using StranglesGenerator = ComboGenerator<Strangle>;
+using CallVerticalsGenerator = ComboGenerator<Vertical<Side::CALL>>;
+using PutVerticalsGenerator = ComboGenerator<Vertical<Side::PUT>>;
+using CallButterfliesGenerator = ComboGenerator<Butterfly<Side::CALL>>;
+using PutButterfliesGenerator = ComboGenerator<Butterfly<Side::PUT>>;
+using CallCalendarsGenerator = ComboGenerator<Calendar<Side::CALL>>;
+using PutCalendarsGenerator = ComboGenerator<Calendar<Side::PUT>>;
+using CallDiagonalsGenerator = ComboGenerator<Diagonal<Side::CALL>>;
+using PutDiagonalsGenerator = ComboGenerator<Diagonal<Side::PUT>>;
+
+// The condor Pruner lives in generator_class.cpp, which instantiates it
+extern template class ComboGenerator<IronCondor>;
+
+#endif // GENERATOR_CLASS_HPP
@@ -2,277 +2,265 @@
 #define STRATEGY_CLASS_HPP
 
 #include "object.hpp"
-#include <vector>
-#include <memory>
+#include "chain.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <string>
 #include <limits>
 #include <optional>
-
-// ===================== BASE STRATEGY =====================
-class Strategy {
-public:
-    std::string direction;  // "LONG" or "SHORT"
-
-    Strategy(const std::string& dir) : direction(dir) {}
-    virtual ~Strategy() = default;
-
-    virtual std::vector<Option> legs() const = 0;
-    virtual double debit() const = 0;
-    virtual double credit() const = 0;
-    virtual double max_gain() const = 0;
-    virtual double max_loss() const = 0;
-    virtual std::string pretty() const = 0;
+#include <initializer_list>
+#include <utility>
+
+// ===================== STRATEGY METRICS =====================
+// Every value filters and rankings read, computed once when a record is
+// built; accessors only read stored doubles.
+struct StrategyMetrics {
+    double debit;
+    double credit;
+    double max_gain;
+    double max_loss;
+    double reward_risk;  // max_gain / max_loss, inf if max_loss <= 0
+    double net_delta;
+    double net_theta;
+    double net_vega;
+    double iv;  // mean IV over legs with iv > 0, NaN if none
+    double liquidity;  // smallest volume + open interest over the legs
 
     double cost() const {
-        return debit() - credit();
+        return debit - credit;
     }
 
     double rr() const {
-        double loss = max_loss();
-        return loss > 0 ? (max_gain() / loss) : std::numeric_limits<double>::infinity();
-    }
-
-    double net_delta() const {
-        double total = 0.0;
-        for (const auto& [leg, qty] : signed_legs()) {
-            total += leg.delta * 100.0 * qty;
-        }
-        return total;
-    }
-
-    double net_theta() const {
-        double total = 0.0;
-        for (const auto& [leg, qty] : signed_legs()) {
-            total += leg.theta * 100.0 * qty;
-        }
-        return total;
-    }
-
-    double net_vega() const {
-        double total = 0.0;
-        for (const auto& [leg, qty] : signed_legs()) {
-            total += leg.vega * 100.0 * qty;
-        }
-        return total;
+        return reward_risk;
     }
 
     std::optional<double> avg_iv() const {
-        std::vector<double> ivs;
-        for (const auto& [leg, qty] : signed_legs()) {
-            if (leg.iv > 0) {
-                ivs.push_back(leg.iv);
-            }
-        }
-        if (ivs.empty()) return std::nullopt;
-        
-        double sum = 0.0;
-        for (double iv : ivs) sum += iv;
-        return sum / ivs.size();
-    }
-
-    virtual std::string leg_sign(const Option& leg) const = 0;
-
-protected:
-    std::vector<std::pair<Option, int>> signed_legs() const {
-        std::vector<std::pair<Option, int>> result;
-        for (const Option& leg : legs()) {
-            int qty = (leg_sign(leg) == "BUY") ? 1 : -1;
-            result.emplace_back(leg, qty);
-        }
-        return result;
+        if (std::isnan(iv)) return std::nullopt;
+        return iv;
     }
 };
 
-// ===================== SINGLE LEG =====================
-class SingleLeg : public Strategy {
-public:
-    SingleLeg(const Option& opt, const std::string& action, const std::string& direction)
-        : Strategy(direction), opt_(opt), action_(action) {}
-
-    std::vector<Option> legs() const override {
-        return {opt_};
-    }
-
-    std::string leg_sign(const Option& leg) const override {
-        return action_;
-    }
-
-    double debit() const override {
-        return action_ == "BUY" ? opt_.price() * 100.0 : 0.0;
-    }
-
-    double credit() const override {
-        return action_ == "SELL" ? opt_.price() * 100.0 : 0.0;
-    }
-
-    double max_gain() const override {
-        if (opt_.is_call()) {
-            return std::numeric_limits<double>::infinity();
-        }
-        return opt_.strike * 100.0 - cost();
-    }
-
-    double max_loss() const override {
-        return cost();
-    }
-
-    std::string pretty() const override {
-        return "Single " + action_ + " " + opt_.side + "@" + std::to_string(opt_.strike) + 
-               " exp " + opt_.expiry;
-    }
-
-private:
-    Option opt_;
-    std::string action_;  // "BUY" or "SELL"
+// ===================== STRATEGY RECORD =====================
+// A strategy as plain data: leg rows into the OptionChain it was built from,
+// each with +1 (BUY) or -1 (SELL), and its metrics. Records are stored by
+// value; only pretty() needs the chain. A leg sold twice (a butterfly body)
+// is stored as two legs on the same row.
+enum class StrategyKind : uint8_t {
+    SINGLE_LEG,
+    IRON_CONDOR,
+    STRADDLE,
+    STRANGLE,
+    VERTICAL,
+    BUTTERFLY,
+    CALENDAR,
+    DIAGONAL
 };
 
-// ===================== IRON CONDOR =====================
-class IronCondor : public Strategy {
-public:
-    IronCondor(const Option& sc, const Option& bc, const Option& sp, const Option& bp, const std::string& direction)
-        : Strategy(direction), sc_(sc), bc_(bc), sp_(sp), bp_(bp) {}
-
-    std::vector<Option> legs() const override {
-        return {sc_, bc_, sp_, bp_};
-    }
+// Lowercase snake_case name, e.g. "iron_condor"
+const char* strategy_kind_name(StrategyKind kind);
 
-    std::string leg_sign(const Option& leg) const override {
-        // Check if leg is short call or short put
-        if ((leg.expiry == sc_.expiry && leg.strike == sc_.strike && leg.is_call()) ||
-            (leg.expiry == sp_.expiry && leg.strike == sp_.strike && leg.is_put())) {
-            return "SELL";
-        }
-        return "BUY";
-    }
+constexpr size_t MAX_LEGS = 4;
 
-    double debit() const override {
-        return (bc_.price() + bp_.price()) * 100.0;
-    }
+struct StrategyRecord : StrategyMetrics {
+    StrategyKind kind;
+    uint8_t leg_count;
+    int8_t sign[MAX_LEGS];
+    uint32_t leg[MAX_LEGS];
 
-    double credit() const override {
-        return (sc_.price() + sp_.price()) * 100.0;
-    }
+    const StrategyMetrics& metrics() const { return *this; }
 
-    double width() const {
-        return (bc_.strike - sc_.strike) * 100.0;
-    }
-
-    double max_gain() const override {
-        return credit();
-    }
-
-    double max_loss() const override {
-        return width() - credit();
-    }
-
-    std::string pretty() const override {
-        return "IC C:" + std::to_string(sc_.strike) + "/" + std::to_string(bc_.strike) + 
-               " P:" + std::to_string(sp_.strike) + "/" + std::to_string(bp_.strike) + 
-               " exp " + sc_.expiry;
-    }
-
-private:
-    Option sc_;  // Short call
-    Option bc_;  // Buy call
-    Option sp_;  // Short put
-    Option bp_;  // Buy put
+    std::string pretty(const OptionChain& chain) const;
 };
 
-// ===================== STRADDLE =====================
-class Straddle : public Strategy {
-public:
-    Straddle(const Option& call, const Option& put, const std::string& direction)
-        : Strategy(direction), call_(call), put_(put) {}
-
-    std::vector<Option> legs() const override {
-        return {call_, put_};
-    }
-
-    std::string leg_sign(const Option& leg) const override {
-        return direction == "LONG" ? "BUY" : "SELL";
-    }
-
-    double debit() const override {
-        double total = (call_.price() + put_.price()) * 100.0;
-        return direction == "LONG" ? total : 0.0;
-    }
-
-    double credit() const override {
-        double total = (call_.price() + put_.price()) * 100.0;
-        return direction == "SHORT" ? total : 0.0;
-    }
-
-    double max_gain() const override {
-        if (direction == "LONG") {
-            return std::numeric_limits<double>::infinity();
+namespace detail {
+
+// Legs with zeroed metrics; net greeks and IV follow from the legs
+inline StrategyRecord make_record(const OptionChain& chain, StrategyKind kind,
+                                  std::initializer_list<std::pair<uint32_t, int>> legs) {
+    StrategyRecord r{};
+    r.kind = kind;
+    r.leg_count = 0;
+
+    double iv_sum = 0.0;
+    size_t iv_count = 0;
+    r.liquidity = std::numeric_limits<double>::infinity();
+    for (const auto& [row, qty] : legs) {
+        r.leg[r.leg_count] = row;
+        r.sign[r.leg_count] = static_cast<int8_t>(qty);
+        ++r.leg_count;
+
+        r.net_delta += chain.delta[row] * 100.0 * qty;
+        r.net_theta += chain.theta[row] * 100.0 * qty;
+        r.net_vega += chain.vega[row] * 100.0 * qty;
+        if (chain.iv[row] > 0) {
+            iv_sum += chain.iv[row];
+            ++iv_count;
         }
-        return credit();
+        const double leg_liquidity = chain.volume[row] + chain.oi[row];
+        r.liquidity = leg_liquidity < r.liquidity ? leg_liquidity : r.liquidity;
     }
+    r.iv = iv_count > 0 ? iv_sum / iv_count : std::numeric_limits<double>::quiet_NaN();
+    return r;
+}
 
-    double max_loss() const override {
-        if (direction == "LONG") {
-            return cost();
-        }
-        return std::numeric_limits<double>::infinity();
-    }
+// Derived metrics, once max_gain and max_loss are set
+inline StrategyRecord& finish(StrategyRecord& r) {
+    r.reward_risk = r.max_loss > 0 ? (r.max_gain / r.max_loss) : std::numeric_limits<double>::infinity();
+    return r;
+}
 
-    std::string pretty() const override {
-        return "Straddle " + direction + " C:" + std::to_string(call_.strike) + 
-               " P:" + std::to_string(put_.strike) + " exp " + call_.expiry;
-    }
-
-private:
-    Option call_;
-    Option put_;
-};
+}  // namespace detail
 
-// ===================== STRANGLE =====================
-class Strangle : public Strategy {
-public:
-    Strangle(const Option& call, const Option& put, const std::string& direction)
-        : Strategy(direction), call_(call), put_(put) {}
-
-    std::vector<Option> legs() const override {
-        return {call_, put_};
-    }
-
-    std::string leg_sign(const Option& leg) const override {
-        return direction == "LONG" ? "BUY" : "SELL";
-    }
-
-    double debit() const override {
-        double total = (call_.price() + put_.price()) * 100.0;
-        return direction == "LONG" ? total : 0.0;
-    }
-
-    double credit() const override {
-        double total = (call_.price() + put_.price()) * 100.0;
-        return direction == "SHORT" ? total : 0.0;
-    }
-
-    double max_gain() const override {
-        if (direction == "LONG") {
-            return std::numeric_limits<double>::infinity();
-        }
-        return credit();
-    }
-
-    double max_loss() const override {
-        if (direction == "LONG") {
-            return cost();
-        }
-        return std::numeric_limits<double>::infinity();
-    }
-
-    std::string pretty() const override {
-        return "Strangle " + direction + " C:" + std::to_string(call_.strike) + 
-               " P:" + std::to_string(put_.strike) + " exp " + call_.expiry;
-    }
+// ===================== SINGLE LEG =====================
+inline StrategyRecord make_single_leg(const OptionChain& chain, uint32_t row, bool buy) {
+    StrategyRecord r = detail::make_record(chain, StrategyKind::SINGLE_LEG, {{row, buy ? 1 : -1}});
+    r.debit = buy ? chain.price(row) * 100.0 : 0.0;
+    r.credit = buy ? 0.0 : chain.price(row) * 100.0;
+    r.max_gain = chain.is_call(row) ? std::numeric_limits<double>::infinity()
+                                    : chain.strike[row] * 100.0 - r.cost();
+    r.max_loss = r.cost();
+    return detail::finish(r);
+}
 
-private:
-    Option call_;
-    Option put_;
-};
+// ===================== IRON CONDOR =====================
+// Short call, buy call, short put, buy put
+inline StrategyRecord make_iron_condor(const OptionChain& chain, uint32_t sc, uint32_t bc, uint32_t sp, uint32_t bp) {
+    StrategyRecord r = detail::make_record(chain, StrategyKind::IRON_CONDOR, {{sc, -1}, {bc, 1}, {sp, -1}, {bp, 1}});
+    r.debit = (chain.price(bc) + chain.price(bp)) * 100.0;
+    r.credit = (chain.price(sc) + chain.price(sp)) * 100.0;
+    r.max_gain = r.credit;
+    r.max_loss = (chain.strike[bc] - chain.strike[sc]) * 100.0 - r.credit;
+    return detail::finish(r);
+}
+
+// ===================== STRADDLE / STRANGLE =====================
+// Both legs bought (LONG) or sold (SHORT)
+inline StrategyRecord make_call_put_pair(const OptionChain& chain, StrategyKind kind,
+                                         uint32_t call, uint32_t put, Direction direction) {
+    const bool is_long = direction == Direction::LONG;
+    const int qty = is_long ? 1 : -1;
+    StrategyRecord r = detail::make_record(chain, kind, {{call, qty}, {put, qty}});
+
+    double total = (chain.price(call) + chain.price(put)) * 100.0;
+    r.debit = is_long ? total : 0.0;
+    r.credit = is_long ? 0.0 : total;
+    r.max_gain = is_long ? std::numeric_limits<double>::infinity() : r.credit;
+    r.max_loss = is_long ? r.cost() : std::numeric_limits<double>::infinity();
+    return detail::finish(r);
+}
+
+inline StrategyRecord make_straddle(const OptionChain& chain, uint32_t call, uint32_t put, Direction direction) {
+    return make_call_put_pair(chain, StrategyKind::STRADDLE, call, put, direction);
+}
+
+inline StrategyRecord make_strangle(const OptionChain& chain, uint32_t call, uint32_t put, Direction direction) {
+    return make_call_put_pair(chain, StrategyKind::STRANGLE, call, put, direction);
+}
+
+// ===================== VERTICAL / BUTTERFLY =====================
+// Same side and expiry. LONG buys leg `near` and pays a debit (bull call,
+// bear put, long butterfly); SHORT is the mirror image for a credit. Either
+// way the payoff moves across one strike width, |strike[far] - strike[near]|.
+namespace detail {
+
+inline StrategyRecord& finish_spread(const OptionChain& chain, StrategyRecord& r, uint32_t near, uint32_t far,
+                                     bool is_long) {
+    const double width = std::fabs(chain.strike[far] - chain.strike[near]) * 100.0;
+    r.max_gain = is_long ? width - r.cost() : -r.cost();
+    r.max_loss = is_long ? r.cost() : width + r.cost();
+    return finish(r);
+}
+
+}  // namespace detail
+
+// Buys near and sells far when LONG
+inline StrategyRecord make_vertical(const OptionChain& chain, uint32_t near, uint32_t far, Direction direction) {
+    const int qty = direction == Direction::LONG ? 1 : -1;
+    StrategyRecord r = detail::make_record(chain, StrategyKind::VERTICAL, {{near, qty}, {far, -qty}});
+    r.debit = (qty > 0 ? chain.price(near) : chain.price(far)) * 100.0;
+    r.credit = (qty > 0 ? chain.price(far) : chain.price(near)) * 100.0;
+    return detail::finish_spread(chain, r, near, far, qty > 0);
+}
+
+// Wings low and high, body twice in the middle; LONG buys the wings
+inline StrategyRecord make_butterfly(const OptionChain& chain, uint32_t low, uint32_t body, uint32_t high,
+                                     Direction direction) {
+    const int qty = direction == Direction::LONG ? 1 : -1;
+    StrategyRecord r = detail::make_record(chain, StrategyKind::BUTTERFLY,
+                                           {{low, qty}, {body, -qty}, {body, -qty}, {high, qty}});
+    const double wings = chain.price(low) + chain.price(high);
+    const double bodies = chain.price(body) + chain.price(body);
+    r.debit = (qty > 0 ? wings : bodies) * 100.0;
+    r.credit = (qty > 0 ? bodies : wings) * 100.0;
+    return detail::finish_spread(chain, r, low, body, qty > 0);
+}
+
+// ===================== CALENDAR / DIAGONAL =====================
+// Sells front and buys back, same side, back in a later expiry; a calendar
+// has equal strikes, a diagonal buys back at a strike closer to the money
+// (lower for calls, higher for puts), so at most the debit is lost. Max
+// gain is an estimate: back's Black-Scholes value (r = 0, its own IV) with
+// spot at front's strike when front expires, less the debit.
+namespace detail {
+
+inline double black_scholes(bool call, double spot, double strike, double years, double vol) {
+    const double intrinsic = std::max(call ? spot - strike : strike - spot, 0.0);
+    if (!(years > 0) || !(vol > 0) || !(spot > 0) || !(strike > 0)) return intrinsic;
+
+    const double sd = vol * std::sqrt(years);
+    const double d1 = (std::log(spot / strike) + 0.5 * sd * sd) / sd;
+    const double d2 = d1 - sd;
+    auto cdf = [](double x) { return 0.5 * std::erfc(-x / std::sqrt(2.0)); };
+    return call ? spot * cdf(d1) - strike * cdf(d2) : strike * cdf(-d2) - spot * cdf(-d1);
+}
+
+}  // namespace detail
+
+inline StrategyRecord make_time_spread(const OptionChain& chain, StrategyKind kind, uint32_t front, uint32_t back) {
+    StrategyRecord r = detail::make_record(chain, kind, {{front, -1}, {back, 1}});
+    r.debit = chain.price(back) * 100.0;
+    r.credit = chain.price(front) * 100.0;
+
+    const double years = (chain.days_to_expiry(back) - chain.days_to_expiry(front)) / 365.0;
+    const double back_value = detail::black_scholes(chain.is_call(back), chain.strike[front], chain.strike[back],
+                                                    years, chain.iv[back]);
+    r.max_gain = back_value * 100.0 - r.cost();
+    r.max_loss = r.cost();
+    return detail::finish(r);
+}
+
+inline StrategyRecord make_calendar(const OptionChain& chain, uint32_t front, uint32_t back) {
+    return make_time_spread(chain, StrategyKind::CALENDAR, front, back);
+}
+
+inline StrategyRecord make_diagonal(const OptionChain& chain, uint32_t front, uint32_t back) {
+    return make_time_spread(chain, StrategyKind::DIAGONAL, front, back);
+}
+
+// ===================== REBUILD =====================
+// r's kind and legs with every metric recomputed from the chain's current
+// columns, exactly as the original builder computed them
+inline StrategyRecord rebuild_record(const OptionChain& chain, const StrategyRecord& r) {
+    switch (r.kind) {
+        case StrategyKind::SINGLE_LEG:
+            return make_single_leg(chain, r.leg[0], r.sign[0] > 0);
+        case StrategyKind::IRON_CONDOR:
+            return make_iron_condor(chain, r.leg[0], r.leg[1], r.leg[2], r.leg[3]);
+        case StrategyKind::STRADDLE:
+        case StrategyKind::STRANGLE:
+            return make_call_put_pair(chain, r.kind, r.leg[0], r.leg[1],
+                                      r.sign[0] > 0 ? Direction::LONG : Direction::SHORT);
+        case StrategyKind::VERTICAL:
+            return make_vertical(chain, r.leg[0], r.leg[1], r.sign[0] > 0 ? Direction::LONG : Direction::SHORT);
+        case StrategyKind::BUTTERFLY:
+            return make_butterfly(chain, r.leg[0], r.leg[1], r.leg[3],
+                                  r.sign[0] > 0 ? Direction::LONG : Direction::SHORT);
+        case StrategyKind::CALENDAR:
+        case StrategyKind::DIAGONAL:
+            return make_time_spread(chain, r.kind, r.leg[0], r.leg[1]);
+    }
+    return r;
+}
 
 #endif // STRATEGY_CLASS_HPP
-
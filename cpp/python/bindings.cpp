@@ -0,0 +1,292 @@
+#include "loader.hpp"
+#include "config.hpp"
+#include "result_writer.hpp"
+#include "factory/factory.hpp"
+#include "factory/chain_index.hpp"
+#include "factory/pricing.hpp"
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+// ===================== PYTHON MODULE =====================
+// option_screener_cpp: load, filter, generate and rank with the C++ engine
+// from Python. Results stay in C++: every column a Chain or Strategies
+// exposes is a read-only NumPy view over the C++ storage (strided over the
+// StrategyRecord array for strategies), kept alive by the owning object, so
+// no per-row Python objects are made. The GIL is released while loading,
+// filtering, generating and ranking.
+
+namespace {
+
+// A loaded chain; results that index its rows share ownership of it
+struct Chain {
+    OptionChain chain;
+    std::optional<double> spot;
+
+    double require_spot() const {
+        if (!spot.has_value()) {
+            throw std::runtime_error("Chain has no spot price");
+        }
+        return spot.value();
+    }
+};
+
+struct Strategies {
+    std::shared_ptr<const Chain> chain;
+    StrategyList list;
+};
+
+// Read-only array over the elements of type T at first, shape and strides
+// (in bytes) as NumPy takes them
+template <typename T>
+py::array view(const T* first, std::vector<py::ssize_t> shape, std::vector<py::ssize_t> strides, py::handle owner) {
+    py::array array(py::dtype::of<T>(), std::move(shape), std::move(strides), first, owner);
+    array.attr("setflags")("write"_a = false);
+    return array;
+}
+
+template <typename T>
+py::array column_view(const std::vector<T>& column, py::handle owner) {
+    return view(column.data(), {py::ssize_t(column.size())}, {py::ssize_t(sizeof(T))}, owner);
+}
+
+// One metric of every record of self, e.g. &StrategyMetrics::debit
+template <typename T>
+py::array record_view(py::object self, T StrategyMetrics::*field) {
+    const auto& records = self.cast<const Strategies&>().list.records();
+    const T* first = records.empty() ? nullptr : &(records.front().*field);
+    return view(first, {py::ssize_t(records.size())}, {py::ssize_t(sizeof(StrategyRecord))}, self);
+}
+
+// Leg field of every record as a (count, MAX_LEGS) array
+template <typename T>
+py::array leg_view(py::object self, T (StrategyRecord::*field)[MAX_LEGS]) {
+    const auto& records = self.cast<const Strategies&>().list.records();
+    const T* first = records.empty() ? nullptr : &(records.front().*field)[0];
+    return view(first, {py::ssize_t(records.size()), py::ssize_t(MAX_LEGS)},
+                {py::ssize_t(sizeof(StrategyRecord)), py::ssize_t(sizeof(T))}, self);
+}
+
+// Enum-typed column as its underlying integer
+template <typename Enum>
+py::array enum_view(const Enum* first, size_t count, size_t stride, py::handle owner) {
+    using Int = std::underlying_type_t<Enum>;
+    return view(reinterpret_cast<const Int*>(first), {py::ssize_t(count)}, {py::ssize_t(stride)}, owner);
+}
+
+Strategies derive(const Strategies& s, StrategyList list) {
+    return Strategies{s.chain, std::move(list)};
+}
+
+StrategyFactory make_factory(const Chain& c, const ScreenerConfig& config, std::optional<size_t> threads) {
+    return StrategyFactory(c.chain, c.require_spot(), threads.value_or(config.threads));
+}
+
+}  // namespace
+
+PYBIND11_MODULE(option_screener_cpp, m) {
+    m.doc() = "C++ option screening engine: load, filter, generate and rank";
+
+    py::class_<Chain, std::shared_ptr<Chain>>(m, "Chain")
+        .def_property_readonly("symbol", [](const Chain& c) { return c.chain.symbol; })
+        .def_property_readonly("spot", [](const Chain& c) { return c.spot; })
+        .def_property_readonly("expiries", [](const Chain& c) { return c.chain.expiries; })
+        .def_property_readonly("expiry_days", [](const Chain& c) { return c.chain.expiry_days; })
+        .def("__len__", [](const Chain& c) { return c.chain.size(); })
+        .def_property_readonly("strike", [](py::object self) { return column_view(self.cast<const Chain&>().chain.strike, self); })
+        .def_property_readonly("mid", [](py::object self) { return column_view(self.cast<const Chain&>().chain.mid, self); })
+        .def_property_readonly("iv", [](py::object self) { return column_view(self.cast<const Chain&>().chain.iv, self); })
+        .def_property_readonly("volume", [](py::object self) { return column_view(self.cast<const Chain&>().chain.volume, self); })
+        .def_property_readonly("oi", [](py::object self) { return column_view(self.cast<const Chain&>().chain.oi, self); })
+        .def_property_readonly("bid", [](py::object self) { return column_view(self.cast<const Chain&>().chain.bid, self); })
+        .def_property_readonly("ask", [](py::object self) { return column_view(self.cast<const Chain&>().chain.ask, self); })
+        .def_property_readonly("delta", [](py::object self) { return column_view(self.cast<const Chain&>().chain.delta, self); })
+        .def_property_readonly("gamma", [](py::object self) { return column_view(self.cast<const Chain&>().chain.gamma, self); })
+        .def_property_readonly("theta", [](py::object self) { return column_view(self.cast<const Chain&>().chain.theta, self); })
+        .def_property_readonly("vega", [](py::object self) { return column_view(self.cast<const Chain&>().chain.vega, self); })
+        .def_property_readonly("rho", [](py::object self) { return column_view(self.cast<const Chain&>().chain.rho, self); })
+        .def_property_readonly("expiry_id", [](py::object self) { return column_view(self.cast<const Chain&>().chain.expiry_id, self); })
+        .def_property_readonly("side", [](py::object self) {  // 0 = call, 1 = put
+            const OptionChain& chain = self.cast<const Chain&>().chain;
+            return enum_view(chain.side.data(), chain.size(), sizeof(Side), self);
+        });
+
+    py::class_<ScreenerConfig>(m, "Config")
+        .def_static("from_file", &ConfigLoader::load, "path"_a)
+        .def_static("from_json", &ConfigLoader::parse, "text"_a)
+        .def_readwrite("rank_key", &ScreenerConfig::rank_key)
+        .def_readwrite("top_n", &ScreenerConfig::top_n)
+        .def_readwrite("pareto", &ScreenerConfig::pareto)
+        .def_readwrite("threads", &ScreenerConfig::threads);
+
+    py::class_<Strategies>(m, "Strategies")
+        .def("__len__", [](const Strategies& s) { return s.list.size(); })
+        .def_property_readonly("chain", [](const Strategies& s) { return std::const_pointer_cast<Chain>(s.chain); })
+        .def("rank", [](const Strategies& s, const std::string& key, bool reverse) {
+                 py::gil_scoped_release release;
+                 return derive(s, s.list.rank(key, reverse));
+             }, "key"_a = "rr", "reverse"_a = true)
+        .def("top", [](const Strategies& s, size_t n) { return derive(s, s.list.top(n)); }, "n"_a = 10)
+        .def("pareto", [](const Strategies& s, const std::string& spec) {
+                 py::gil_scoped_release release;
+                 return derive(s, s.list.pareto(spec));
+             }, "spec"_a, "The strategies no other beats on every metric of spec, e.g. \"rr,loss,theta\"")
+        .def("ranked_top", [](const Strategies& s, const std::string& key, size_t n, bool reverse) {
+                 py::gil_scoped_release release;
+                 return derive(s, s.list.ranked_top(key, n, reverse));
+             }, "key"_a, "n"_a, "reverse"_a = true)
+        .def("names", [](const Strategies& s) {
+                 std::vector<std::string> names;
+                 names.reserve(s.list.size());
+                 for (const StrategyRecord& r : s.list.records()) names.push_back(r.pretty(s.chain->chain));
+                 return names;
+             }, "pretty() of every strategy; the one call that builds per-row objects")
+        .def("write", [](const Strategies& s, const std::string& path, const std::string& format) {
+                 const ResultFormat f = parse_result_format(format);
+                 py::gil_scoped_release release;
+                 std::FILE* out = std::fopen(path.c_str(), "wb");
+                 if (!out) throw std::runtime_error("Cannot open output file: " + path);
+                 try {
+                     ResultWriter writer(out, f);
+                     s.list.write(writer);
+                     writer.flush();
+                 } catch (...) {
+                     std::fclose(out);
+                     throw;
+                 }
+                 std::fclose(out);
+             }, "path"_a, "format"_a = "csv")
+        .def_property_readonly("kind", [](py::object self) {  // StrategyKind, see KINDS
+            const auto& records = self.cast<const Strategies&>().list.records();
+            return enum_view(records.empty() ? nullptr : &records.front().kind, records.size(),
+                             sizeof(StrategyRecord), self);
+        })
+        .def_property_readonly("leg_count", [](py::object self) {
+            const auto& records = self.cast<const Strategies&>().list.records();
+            return view(records.empty() ? nullptr : &records.front().leg_count, {py::ssize_t(records.size())},
+                        {py::ssize_t(sizeof(StrategyRecord))}, self);
+        })
+        .def_property_readonly("legs", [](py::object self) { return leg_view(self, &StrategyRecord::leg); })
+        .def_property_readonly("signs", [](py::object self) { return leg_view(self, &StrategyRecord::sign); })
+        .def_property_readonly("debit", [](py::object self) { return record_view(self, &StrategyMetrics::debit); })
+        .def_property_readonly("credit", [](py::object self) { return record_view(self, &StrategyMetrics::credit); })
+        .def_property_readonly("max_gain", [](py::object self) { return record_view(self, &StrategyMetrics::max_gain); })
+        .def_property_readonly("max_loss", [](py::object self) { return record_view(self, &StrategyMetrics::max_loss); })
+        .def_property_readonly("rr", [](py::object self) { return record_view(self, &StrategyMetrics::reward_risk); })
+        .def_property_readonly("net_delta", [](py::object self) { return record_view(self, &StrategyMetrics::net_delta); })
+        .def_property_readonly("net_theta", [](py::object self) { return record_view(self, &StrategyMetrics::net_theta); })
+        .def_property_readonly("net_vega", [](py::object self) { return record_view(self, &StrategyMetrics::net_vega); })
+        .def_property_readonly("iv", [](py::object self) { return record_view(self, &StrategyMetrics::iv); })
+        .def_property_readonly("liquidity", [](py::object self) { return record_view(self, &StrategyMetrics::liquidity); });
+
+    // Names of StrategyKind values, indexed by Strategies.kind
+    py::list kinds;
+    for (uint8_t k = 0; k <= uint8_t(StrategyKind::DIAGONAL); ++k) {
+        kinds.append(strategy_kind_name(StrategyKind(k)));
+    }
+    m.attr("KINDS") = kinds;
+
+    m.def("load", [](const std::string& path) {
+              auto [chain, spot] = load_snapshot(path);
+              return std::make_shared<Chain>(Chain{std::move(chain), spot});
+          }, "path"_a, py::call_guard<py::gil_scoped_release>(),
+          "Load a Tradier JSON chain or binary snapshot");
+    m.def("load", [](const std::string& path, const ScreenerConfig& config) {
+              auto [chain, spot] = load_snapshot(path, config.config_filter);
+              if (config.pricing.has_value() && spot.has_value()) price_chain(chain, spot.value(), *config.pricing);
+              return std::make_shared<Chain>(Chain{std::move(chain), spot});
+          }, "path"_a, "config"_a, py::call_guard<py::gil_scoped_release>(),
+          "Load only the options passing the config's option-level filters, then apply its pricing section");
+
+    m.def("filter", [](const Chain& c, const ScreenerConfig& config) {
+              // Rows are copied out of the index once, into storage the array owns
+              auto rows = std::make_unique<std::vector<uint32_t>>();
+              {
+                  py::gil_scoped_release release;
+                  const ChainIndex index(c.chain, c.require_spot(), config.config_filter);
+                  rows->assign(index.rows().begin(), index.rows().end());
+              }
+              py::capsule owner(rows.get(), [](void* p) { delete static_cast<std::vector<uint32_t>*>(p); });
+              const std::vector<uint32_t>& column = *rows.release();
+              return column_view(column, owner);
+          }, "chain"_a, "config"_a,
+          "Chain rows passing the option-level filters, as a uint32 array");
+
+    m.def("generate", [](std::shared_ptr<Chain> c, const ScreenerConfig& config, std::optional<size_t> threads) {
+              StrategyList list = [&] {
+                  py::gil_scoped_release release;
+                  StrategyFactory factory = make_factory(*c, config, threads);
+                  return factory.generate(config.strategy_filter, config.config_filter);
+              }();
+              return Strategies{std::move(c), std::move(list)};
+          }, "chain"_a, "config"_a, "threads"_a = py::none(),
+          "Every strategy passing the config's filters, in generation order");
+
+    m.def("screen", [](std::shared_ptr<Chain> c, const ScreenerConfig& config, std::optional<size_t> threads) {
+              StrategyList list = [&] {
+                  py::gil_scoped_release release;
+                  StrategyFactory factory = make_factory(*c, config, threads);
+                  if (!config.pareto.empty()) {
+                      return factory.pareto_top(config.strategy_filter, config.config_filter, config.pareto,
+                                                config.rank_key, config.top_n);
+                  }
+                  return factory.top(config.strategy_filter, config.config_filter, config.rank_key, config.top_n);
+              }();
+              return Strategies{std::move(c), std::move(list)};
+          }, "chain"_a, "config"_a, "threads"_a = py::none(),
+          "The config's ranked top_n, streamed through a bounded heap");
+
+    m.def("page", [](std::shared_ptr<Chain> c, const ScreenerConfig& config, size_t size,
+                     std::optional<std::string> after, std::optional<size_t> threads) {
+              if (!config.pareto.empty()) {
+                  throw std::invalid_argument("page does not apply with ranking.pareto");
+              }
+              std::optional<PageCursor> cursor;
+              if (after.has_value()) cursor = PageCursor::parse(*after);
+              StrategyPage page = [&] {
+                  py::gil_scoped_release release;
+                  StrategyFactory factory = make_factory(*c, config, threads);
+                  return factory.page(config.strategy_filter, config.config_filter, config.rank_key, size, cursor);
+              }();
+              std::optional<std::string> next;
+              if (page.next.has_value()) next = page.next->to_string();
+              return py::make_tuple(Strategies{std::move(c), std::move(page.strategies)}, next);
+          }, "chain"_a, "config"_a, "size"_a, "after"_a = py::none(), "threads"_a = py::none(),
+          "The next size strategies of the config's ranking after the token `after` (from the first if None), "
+          "as (strategies, token of the next page or None); pages in turn make up screen()'s ranking");
+
+    m.def("scenarios", [](const Strategies& s, std::vector<double> spot_shifts, std::vector<double> iv_shifts,
+                          std::vector<double> days_forward, const std::string& model, size_t threads) {
+              ScenarioGrid grid{std::move(spot_shifts), std::move(iv_shifts), std::move(days_forward)};
+              if (model == "reprice") {
+                  grid.model = ScenarioModel::REPRICE;
+              } else if (model != "greeks") {
+                  throw std::invalid_argument("model must be \"greeks\" or \"reprice\"");
+              }
+              auto matrix = std::make_unique<ScenarioMatrix>();
+              {
+                  py::gil_scoped_release release;
+                  StrategyFactory factory(s.chain->chain, s.chain->require_spot(), threads);
+                  *matrix = factory.scenarios(s.list, grid);
+              }
+              const py::ssize_t rows = py::ssize_t(matrix->strategies);
+              const py::ssize_t cols = py::ssize_t(matrix->scenarios());
+              const double* first = matrix->pnl.data();
+              py::capsule owner(matrix.release(), [](void* p) { delete static_cast<ScenarioMatrix*>(p); });
+              return view(first, {rows, cols}, {cols * py::ssize_t(sizeof(double)), py::ssize_t(sizeof(double))},
+                          owner);
+          }, "strategies"_a, "spot_shifts"_a = std::vector<double>{0.0}, "iv_shifts"_a = std::vector<double>{0.0},
+          "days_forward"_a = std::vector<double>{0.0}, "model"_a = "greeks", "threads"_a = 1,
+          "P&L of every strategy (rows) under every (spot shift, IV shift, days forward) scenario "
+          "(columns, in that nesting order), as a float64 array");
+}
@@ -0,0 +1,35 @@
+#include "loader.hpp"
+#include "snapshot.hpp"
+#include <iostream>
+#include <filesystem>
+
+int main(int argc, char* argv[]) {
+    try {
+        if (argc < 2) {
+            std::cerr << "Usage: " << argv[0] << " <data.json> [output" << SNAPSHOT_EXTENSION << "]" << std::endl;
+            return 1;
+        }
+
+        std::string input_path = argv[1];
+        std::string output_path;
+        if (argc > 2) {
+            output_path = argv[2];
+        } else {
+            output_path = std::filesystem::path(input_path).replace_extension(SNAPSHOT_EXTENSION).string();
+        }
+
+        if (!std::filesystem::exists(input_path)) {
+            std::cerr << "Error: Data file not found: " << input_path << std::endl;
+            return 1;
+        }
+
+        auto [chain, spot] = load_option_snapshot(input_path);
+        write_binary_snapshot(output_path, chain, spot);
+
+        std::cout << "Wrote " << chain.size() << " options to " << output_path << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
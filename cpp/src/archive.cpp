@@ -0,0 +1,556 @@
+#include "archive.hpp"
+#include "loader.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+
+constexpr double POW10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8};
+constexpr uint8_t MAX_DECIMALS = 8;
+
+uint64_t align8(uint64_t n) {
+    return (n + 7) & ~uint64_t(7);
+}
+
+bool structure_column(uint32_t col) {
+    return col == COL_STRIKE || col == COL_EXPIRY_ID || col == COL_SIDE;
+}
+
+void put_bytes(std::string& out, const void* data, size_t n) {
+    out.append(static_cast<const char*>(data), n);
+}
+
+void pad8(std::string& out) {
+    out.resize(align8(out.size()), '\0');
+}
+
+void put_varint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(char(uint8_t(v) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(char(v));
+}
+
+uint64_t zigzag(int64_t v) {
+    return (uint64_t(v) << 1) ^ uint64_t(v >> 63);
+}
+
+int64_t unzigzag(uint64_t v) {
+    return int64_t(v >> 1) ^ -int64_t(v & 1);
+}
+
+// q with q / 10^decimals == v exactly, if there is one of at most 53 bits
+std::optional<int64_t> scaled(double v, uint8_t decimals) {
+    if (!std::isfinite(v) || (v == 0.0 && std::signbit(v))) return std::nullopt;
+    const double x = std::nearbyint(v * POW10[decimals]);
+    if (std::fabs(x) > 9007199254740992.0) return std::nullopt;
+    if (x / POW10[decimals] != v) return std::nullopt;
+    return int64_t(x);
+}
+
+// Header and payload of one column, in the smaller exact encoding
+void put_column(std::string& out, const double* v, size_t n) {
+    bool has_missing = false;
+    for (size_t i = 0; i < n; ++i) {
+        has_missing |= std::isnan(v[i]);
+    }
+
+    std::optional<uint8_t> decimals;
+    for (uint8_t d = 0; d <= MAX_DECIMALS && !decimals; ++d) {
+        bool exact = true;
+        for (size_t i = 0; i < n && exact; ++i) {
+            exact = std::isnan(v[i]) || scaled(v[i], d).has_value();
+        }
+        if (exact) decimals = d;
+    }
+
+    std::string payload;
+    ArchiveColumnHeader header{};
+    if (decimals) {
+        header.encoding = ENC_SCALED;
+        header.decimals = *decimals;
+        header.has_missing = has_missing ? 1 : 0;
+        if (has_missing) {
+            payload.assign((n + 7) / 8, '\0');
+            for (size_t i = 0; i < n; ++i) {
+                if (std::isnan(v[i])) payload[i / 8] = char(uint8_t(payload[i / 8]) | (1u << (i % 8)));
+            }
+        }
+        int64_t previous = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (std::isnan(v[i])) continue;
+            const int64_t q = *scaled(v[i], *decimals);
+            put_varint(payload, zigzag(q - previous));
+            previous = q;
+        }
+    }
+    if (!decimals || payload.size() >= n * sizeof(double)) {
+        header = ArchiveColumnHeader{};
+        header.encoding = ENC_RAW;
+        payload.assign(reinterpret_cast<const char*>(v), n * sizeof(double));
+    }
+
+    header.bytes = payload.size();
+    put_bytes(out, &header, sizeof(header));
+    out += payload;
+    pad8(out);
+}
+
+[[noreturn]] void corrupt(const std::string& path) {
+    throw std::runtime_error("Corrupt archive: " + path);
+}
+
+// Bounds-checked reads from one block's bytes
+class BlockReader {
+public:
+    BlockReader(const char* data, uint64_t size, const std::string& path)
+        : data_(data), size_(size), path_(path) {}
+
+    const char* take(uint64_t bytes) {
+        if (bytes > size_ - pos_) corrupt(path_);
+        const char* p = data_ + pos_;
+        pos_ += bytes;
+        return p;
+    }
+
+    void align() { pos_ = std::min(align8(pos_), size_); }
+
+    template <typename T>
+    T get() {
+        T v;
+        std::memcpy(&v, take(sizeof(T)), sizeof(T));
+        return v;
+    }
+
+    // Next column into out[0, n), or skipped if out is null
+    void column(double* out, size_t n) {
+        const auto header = get<ArchiveColumnHeader>();
+        const char* payload = take(header.bytes);
+        align();
+        if (!out) return;
+
+        if (header.encoding == ENC_RAW) {
+            if (header.bytes != n * sizeof(double)) corrupt(path_);
+            std::memcpy(out, payload, header.bytes);
+            return;
+        }
+        if (header.encoding != ENC_SCALED || header.decimals > MAX_DECIMALS) corrupt(path_);
+
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(payload);
+        const uint8_t* end = p + header.bytes;
+        const uint8_t* missing = nullptr;
+        if (header.has_missing) {
+            if (uint64_t(end - p) < (n + 7) / 8) corrupt(path_);
+            missing = p;
+            p += (n + 7) / 8;
+        }
+        const double scale = POW10[header.decimals];
+        int64_t q = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (missing && (missing[i / 8] >> (i % 8)) & 1) {
+                out[i] = std::numeric_limits<double>::quiet_NaN();
+                continue;
+            }
+            uint64_t v = 0;
+            for (unsigned shift = 0;; shift += 7) {
+                if (p == end || shift > 63) corrupt(path_);
+                const uint8_t byte = *p++;
+                v |= uint64_t(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) break;
+            }
+            q += unzigzag(v);
+            out[i] = double(q) / scale;
+        }
+    }
+
+private:
+    const char* data_;
+    uint64_t size_;
+    uint64_t pos_ = 0;
+    const std::string& path_;
+};
+
+// The block at offset of an archive's bytes, checked against the file
+BlockReader open_block(const char* data, uint64_t size, uint64_t offset, const std::string& path,
+                       ArchiveBlockHeader& header) {
+    if (offset > size || size - offset < sizeof(ArchiveBlockHeader)) corrupt(path);
+    std::memcpy(&header, data + offset, sizeof(header));
+    if (header.block_bytes < sizeof(header) || header.block_bytes > size - offset) corrupt(path);
+    BlockReader reader(data + offset, header.block_bytes, path);
+    reader.take(sizeof(header));
+    return reader;
+}
+
+// A quote column of chain, in SnapshotColumn order
+std::vector<double>& quote_column(OptionChain& chain, uint32_t col) {
+    switch (col) {
+        case COL_MID: return chain.mid;
+        case COL_IV: return chain.iv;
+        case COL_VOLUME: return chain.volume;
+        case COL_OI: return chain.oi;
+        case COL_BID: return chain.bid;
+        case COL_ASK: return chain.ask;
+        case COL_DELTA: return chain.delta;
+        case COL_GAMMA: return chain.gamma;
+        case COL_THETA: return chain.theta;
+        case COL_VEGA: return chain.vega;
+        default: return chain.rho;
+    }
+}
+
+const std::vector<double>& quote_column(const OptionChain& chain, uint32_t col) {
+    return quote_column(const_cast<OptionChain&>(chain), col);
+}
+
+// Decodes the rest of a block: its expiry table and structure columns, if
+// it has them, into structure, and its quote columns into quotes. Either
+// may be null to pass over those columns.
+void read_columns(BlockReader& reader, const ArchiveBlockHeader& header, OptionChain* structure,
+                  OptionChain* quotes, const std::string& path) {
+    const size_t n = header.row_count;
+    if (header.has_structure) {
+        std::vector<uint32_t> offsets(size_t(header.expiry_count) + 1);
+        std::memcpy(offsets.data(), reader.take(offsets.size() * sizeof(uint32_t)), offsets.size() * sizeof(uint32_t));
+        const char* bytes = reader.take(offsets.back());
+        reader.align();
+        if (structure) {
+            structure->expiries.clear();
+            for (uint32_t e = 0; e < header.expiry_count; ++e) {
+                if (offsets[e] > offsets[e + 1]) corrupt(path);
+                structure->expiries.emplace_back(bytes + offsets[e], offsets[e + 1] - offsets[e]);
+            }
+            structure->strike.resize(n);
+            structure->expiry_id.resize(n);
+            structure->side.resize(n);
+        }
+    } else if (structure) {
+        corrupt(path);
+    }
+
+    std::vector<double> values;
+    for (uint32_t col = 0; col < COL_COUNT; ++col) {
+        if (!structure_column(col)) {
+            std::vector<double>* column = quotes ? &quote_column(*quotes, col) : nullptr;
+            if (column) column->resize(n);
+            reader.column(column ? column->data() : nullptr, n);
+            continue;
+        }
+        if (!header.has_structure) continue;
+        if (!structure || col == COL_STRIKE) {
+            reader.column(structure ? structure->strike.data() : nullptr, n);
+            continue;
+        }
+        values.resize(n);
+        reader.column(values.data(), n);
+        for (size_t i = 0; i < n; ++i) {
+            const double v = values[i];
+            if (col == COL_EXPIRY_ID) {
+                if (!(v >= 0 && v < header.expiry_count)) corrupt(path);
+                structure->expiry_id[i] = uint16_t(v);
+            } else {
+                if (v != 0 && v != 1) corrupt(path);
+                structure->side[i] = static_cast<Side>(uint8_t(v));
+            }
+        }
+    }
+}
+
+}  // namespace
+
+// ===================== ARCHIVE WRITER =====================
+
+ArchiveWriter::ArchiveWriter(const std::string& path) : path_(path) {
+    const bool exists = std::filesystem::exists(path) && std::filesystem::file_size(path) > 0;
+    if (!exists) {
+        file_ = std::fopen(path.c_str(), "w+b");
+        if (!file_) throw std::runtime_error("Cannot create archive: " + path);
+        ArchiveHeader header{};
+        std::memcpy(header.magic, ARCHIVE_MAGIC, sizeof(header.magic));
+        header.version = ARCHIVE_VERSION;
+        header.byte_order = ARCHIVE_BYTE_ORDER;
+        if (std::fwrite(&header, sizeof(header), 1, file_) != 1) {
+            std::fclose(file_);
+            file_ = nullptr;
+            throw std::runtime_error("Failed to write archive: " + path);
+        }
+        end_ = sizeof(header);
+        dirty_ = true;
+        return;
+    }
+
+    // The committed index, read through a reader before reopening for writing
+    uint64_t footer_offset;
+    {
+        ArchiveReader reader(path);
+        symbols_ = reader.symbols();
+        entries_ = reader.entries();
+        footer_offset = reader.footer_offset();
+    }
+    file_ = std::fopen(path.c_str(), "r+b");
+    if (!file_) throw std::runtime_error("Cannot open archive for appending: " + path);
+
+    // Anything past the committed footer is left from an unfinished append
+    end_ = footer_offset + sizeof(ArchiveFooter);
+}
+
+ArchiveWriter::~ArchiveWriter() {
+    try {
+        close();
+    } catch (const std::exception&) {
+        // Callers that care about errors close explicitly
+    }
+}
+
+uint32_t ArchiveWriter::symbol_id(const std::string& symbol) {
+    for (size_t s = 0; s < symbols_.size(); ++s) {
+        if (symbols_[s] == symbol) return uint32_t(s);
+    }
+    symbols_.push_back(symbol);
+    return uint32_t(symbols_.size() - 1);
+}
+
+const ArchiveWriter::Structure* ArchiveWriter::latest_structure(uint32_t symbol) {
+    auto it = latest_.find(symbol);
+    if (it != latest_.end()) return &it->second;
+
+    // First append of a symbol already in the archive: its latest entry
+    const ArchiveEntry* latest = nullptr;
+    for (const ArchiveEntry& entry : entries_) {
+        if (entry.symbol_id == symbol && (!latest || entry.timestamp >= latest->timestamp)) latest = &entry;
+    }
+    if (!latest) return nullptr;
+
+    ArchiveBlockHeader header;
+    if (std::fseek(file_, long(latest->structure_offset), SEEK_SET) != 0 ||
+        std::fread(&header, sizeof(header), 1, file_) != 1) {
+        corrupt(path_);
+    }
+    std::string bytes(header.block_bytes, '\0');
+    if (header.block_bytes < sizeof(header) || std::fseek(file_, long(latest->structure_offset), SEEK_SET) != 0 ||
+        std::fread(bytes.data(), 1, bytes.size(), file_) != bytes.size()) {
+        corrupt(path_);
+    }
+    BlockReader reader = open_block(bytes.data(), bytes.size(), 0, path_, header);
+    OptionChain chain;
+    read_columns(reader, header, &chain, nullptr, path_);
+
+    Structure& s = latest_[symbol];
+    s.timestamp = latest->timestamp;
+    s.offset = latest->structure_offset;
+    s.expiries = std::move(chain.expiries);
+    s.strike = std::move(chain.strike);
+    s.expiry_id = std::move(chain.expiry_id);
+    s.side = std::move(chain.side);
+    return &s;
+}
+
+size_t ArchiveWriter::append(const OptionChain& chain, std::optional<double> spot, double timestamp) {
+    if (!file_) throw std::runtime_error("Archive is closed: " + path_);
+    if (chain.symbol.empty()) throw std::runtime_error("Cannot archive a chain without a symbol");
+    const size_t n = chain.size();
+    const uint32_t symbol = symbol_id(chain.symbol);
+
+    const Structure* latest = latest_structure(symbol);
+    const bool shared = latest && latest->expiries == chain.expiries && latest->expiry_id == chain.expiry_id &&
+                        latest->side == chain.side && latest->strike.size() == n &&
+                        std::memcmp(latest->strike.data(), chain.strike.data(), n * sizeof(double)) == 0;
+
+    ArchiveBlockHeader header{};
+    header.row_count = uint32_t(n);
+    header.expiry_count = uint32_t(chain.expiries.size());
+    header.has_spot = spot.has_value() ? 1 : 0;
+    header.has_structure = shared ? 0 : 1;
+    header.spot = spot.value_or(0.0);
+    header.timestamp = timestamp;
+
+    std::string block;
+    put_bytes(block, &header, sizeof(header));
+    if (!shared) {
+        std::vector<uint32_t> offsets{0};
+        std::string bytes;
+        for (const std::string& e : chain.expiries) {
+            bytes += e;
+            offsets.push_back(uint32_t(bytes.size()));
+        }
+        put_bytes(block, offsets.data(), offsets.size() * sizeof(uint32_t));
+        block += bytes;
+        pad8(block);
+    }
+
+    std::vector<double> values(n);
+    for (uint32_t col = 0; col < COL_COUNT; ++col) {
+        if (structure_column(col)) {
+            if (shared) continue;
+            if (col == COL_STRIKE) {
+                put_column(block, chain.strike.data(), n);
+                continue;
+            }
+            for (size_t i = 0; i < n; ++i) {
+                values[i] = col == COL_EXPIRY_ID ? double(chain.expiry_id[i]) : double(uint8_t(chain.side[i]));
+            }
+            put_column(block, values.data(), n);
+        } else {
+            put_column(block, quote_column(chain, col).data(), n);
+        }
+    }
+
+    header.block_bytes = block.size();
+    std::memcpy(block.data(), &header, sizeof(header));
+
+    const uint64_t offset = end_;
+    if (std::fseek(file_, long(offset), SEEK_SET) != 0 || std::fwrite(block.data(), 1, block.size(), file_) != block.size()) {
+        throw std::runtime_error("Failed to write archive: " + path_);
+    }
+    end_ += block.size();
+    dirty_ = true;
+
+    const uint64_t structure = shared ? latest->offset : offset;
+    entries_.push_back(ArchiveEntry{timestamp, offset, structure, symbol, uint32_t(n)});
+    if (!shared) {
+        Structure& s = latest_[symbol];
+        s.offset = offset;
+        s.expiries = chain.expiries;
+        s.strike = chain.strike;
+        s.expiry_id = chain.expiry_id;
+        s.side = chain.side;
+    }
+    latest_[symbol].timestamp = timestamp;
+    return block.size();
+}
+
+void ArchiveWriter::close() {
+    if (!file_) return;
+    std::FILE* file = file_;
+    file_ = nullptr;
+    if (!dirty_) {
+        if (std::fclose(file) != 0) throw std::runtime_error("Failed to write archive: " + path_);
+        return;
+    }
+
+    std::stable_sort(entries_.begin(), entries_.end(), [&](const ArchiveEntry& a, const ArchiveEntry& b) {
+        if (a.symbol_id != b.symbol_id) return symbols_[a.symbol_id] < symbols_[b.symbol_id];
+        return a.timestamp < b.timestamp;
+    });
+
+    std::string index;
+    for (const std::string& symbol : symbols_) {
+        const uint32_t size = uint32_t(symbol.size());
+        put_bytes(index, &size, sizeof(size));
+        index += symbol;
+    }
+    pad8(index);
+    put_bytes(index, entries_.data(), entries_.size() * sizeof(ArchiveEntry));
+
+    ArchiveFooter footer{};
+    footer.index_offset = end_;
+    const uint64_t footer_offset = end_ + index.size();
+    footer.entry_count = uint32_t(entries_.size());
+    footer.symbol_count = uint32_t(symbols_.size());
+    footer.version = ARCHIVE_VERSION;
+    footer.byte_order = ARCHIVE_BYTE_ORDER;
+    std::memcpy(footer.magic, ARCHIVE_MAGIC, sizeof(footer.magic));
+    put_bytes(index, &footer, sizeof(footer));
+
+    // The blocks, index and footer reach the disk before the header names
+    // the new footer, so a crash in between leaves the old index in force
+    auto sync = [&] { return std::fflush(file) == 0 && ::fsync(::fileno(file)) == 0; };
+    const bool ok = std::fseek(file, long(end_), SEEK_SET) == 0 &&
+                    std::fwrite(index.data(), 1, index.size(), file) == index.size() &&
+                    sync() &&
+                    std::fseek(file, long(offsetof(ArchiveHeader, footer_offset)), SEEK_SET) == 0 &&
+                    std::fwrite(&footer_offset, sizeof(footer_offset), 1, file) == 1 &&
+                    sync() &&
+                    ::ftruncate(::fileno(file), off_t(footer_offset + sizeof(footer))) == 0;
+    const bool closed = std::fclose(file) == 0;
+    if (!ok || !closed) {
+        throw std::runtime_error("Failed to write archive: " + path_);
+    }
+}
+
+// ===================== ARCHIVE READER =====================
+
+ArchiveReader::ArchiveReader(const std::string& path) : file_(path), path_(path) {
+    const char* data = file_.data();
+    const uint64_t size = file_.size();
+    ArchiveHeader header;
+    if (size < sizeof(header)) throw std::runtime_error("Not an option archive: " + path);
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, ARCHIVE_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Not an option archive: " + path);
+    }
+    if (header.version != ARCHIVE_VERSION || header.byte_order != ARCHIVE_BYTE_ORDER) {
+        throw std::runtime_error("Unsupported archive version or byte order: " + path);
+    }
+    if (header.footer_offset == 0) {
+        throw std::runtime_error("Archive has no index yet (its first append did not finish): " + path);
+    }
+    if (header.footer_offset < sizeof(header) || header.footer_offset > size ||
+        size - header.footer_offset < sizeof(ArchiveFooter)) {
+        corrupt(path);
+    }
+
+    // The footer the header names; bytes after it are ignored
+    ArchiveFooter footer;
+    std::memcpy(&footer, data + header.footer_offset, sizeof(footer));
+    if (std::memcmp(footer.magic, ARCHIVE_MAGIC, sizeof(footer.magic)) != 0 ||
+        footer.version != ARCHIVE_VERSION || footer.byte_order != ARCHIVE_BYTE_ORDER) {
+        corrupt(path);
+    }
+    if (footer.index_offset < sizeof(header) || footer.index_offset > header.footer_offset) corrupt(path);
+    footer_offset_ = header.footer_offset;
+
+    BlockReader index(data + footer.index_offset, header.footer_offset - footer.index_offset, path);
+    for (uint32_t s = 0; s < footer.symbol_count; ++s) {
+        const auto length = index.get<uint32_t>();
+        symbols_.emplace_back(index.take(length), length);
+    }
+    index.align();
+    entries_.resize(footer.entry_count);
+    std::memcpy(entries_.data(), index.take(entries_.size() * sizeof(ArchiveEntry)),
+                entries_.size() * sizeof(ArchiveEntry));
+    for (const ArchiveEntry& entry : entries_) {
+        if (entry.symbol_id >= symbols_.size()) corrupt(path);
+    }
+}
+
+bool ArchiveReader::read(size_t e, ArchiveSnapshot& into) const {
+    const ArchiveEntry& entry = entries_.at(e);
+    const char* data = file_.data();
+    OptionChain& chain = into.chain;
+
+    ArchiveBlockHeader header;
+    BlockReader reader = open_block(data, file_.size(), entry.block_offset, path_, header);
+    const size_t n = header.row_count;
+
+    const bool reused = into.structure_offset == entry.structure_offset && chain.symbol == symbols_[entry.symbol_id] &&
+                        chain.size() == n;
+    if (!reused && !header.has_structure) {
+        ArchiveBlockHeader structure_header;
+        BlockReader structure = open_block(data, file_.size(), entry.structure_offset, path_, structure_header);
+        if (structure_header.row_count != n) corrupt(path_);
+        read_columns(structure, structure_header, &chain, nullptr, path_);
+    }
+    // This block's own structure is passed over if already loaded
+    read_columns(reader, header, header.has_structure && !reused ? &chain : nullptr, &chain, path_);
+    chain.symbol = symbols_[entry.symbol_id];
+
+    // Days to expiry as of the snapshot
+    const std::time_t as_of = std::time_t(header.timestamp);
+    chain.expiry_days.clear();
+    for (const std::string& expiry : chain.expiries) {
+        chain.expiry_days.push_back(calculate_days_to_expiry(expiry, as_of));
+    }
+
+    into.spot = header.has_spot ? std::make_optional(header.spot) : std::nullopt;
+    into.timestamp = header.timestamp;
+    into.structure_offset = entry.structure_offset;
+    return reused;
+}
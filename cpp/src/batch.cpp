@@ -0,0 +1,150 @@
+#include "batch.hpp"
+#include "loader.hpp"
+#include "snapshot.hpp"
+#include "factory/factory.hpp"
+#include "factory/pricing.hpp"
+#include "factory/thread_pool.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+std::vector<std::string> list_batch_inputs(const std::string& path) {
+    std::vector<std::string> inputs;
+
+    if (fs::is_directory(path)) {
+        for (const auto& entry : fs::directory_iterator(path)) {
+            if (!entry.is_regular_file()) continue;
+            auto ext = entry.path().extension();
+            if (ext == ".json" || ext == SNAPSHOT_EXTENSION) {
+                inputs.push_back(entry.path().string());
+            }
+        }
+        std::sort(inputs.begin(), inputs.end());
+        return inputs;
+    }
+
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open batch manifest: " + path);
+    }
+
+    const fs::path base = fs::path(path).parent_path();
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') continue;
+        size_t last = line.find_last_not_of(" \t\r");
+
+        fs::path entry(line.substr(first, last - first + 1));
+        inputs.push_back((entry.is_absolute() ? entry : base / entry).string());
+    }
+    return inputs;
+}
+
+BatchResult run_batch(const ScreenerConfig& config, const std::vector<std::string>& inputs) {
+    const RankOrder order(config.rank_key);
+    auto ranks_before = [&](const ScreenedStrategy& a, const ScreenedStrategy& b) {
+        RankValue va = order.value(a.record);
+        RankValue vb = order.value(b.record);
+        if (RankOrder::before(va, vb)) return true;
+        if (RankOrder::before(vb, va)) return false;
+        return a.input < b.input;
+    };
+
+    BatchResult result;
+    std::vector<std::optional<std::string>> errors(inputs.size());
+    std::mutex mutex;
+
+    std::vector<WorkStealingPool::Task> tasks;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        tasks.push_back([&, i](size_t) {
+            std::vector<ScreenedStrategy> screened;
+            try {
+                auto [chain, spot] = load_snapshot(inputs[i], config.config_filter);
+                if (!spot.has_value()) {
+                    throw std::runtime_error("Could not determine spot price");
+                }
+                if (config.pricing.has_value()) price_chain(chain, spot.value(), *config.pricing);
+
+                StrategyFactory factory(chain, spot.value());
+                StrategyList top =
+                    config.pareto.empty()
+                        ? factory.top(config.strategy_filter, config.config_filter, config.rank_key, config.top_n)
+                        : factory.pareto_top(config.strategy_filter, config.config_filter, config.pareto,
+                                             config.rank_key, config.top_n);
+
+                std::string symbol = chain.symbol.empty() ? fs::path(inputs[i]).stem().string() : chain.symbol;
+                for (const StrategyRecord& s : top.records()) {
+                    ScreenedStrategy& out = screened.emplace_back(ScreenedStrategy{i, symbol, s.pretty(chain), s, {}});
+                    for (size_t l = 0; l < s.leg_count; ++l) {
+                        out.legs[l] = {chain.side[s.leg[l]], chain.strike[s.leg[l]], chain.expiry(s.leg[l])};
+                    }
+                }
+            } catch (const std::exception& e) {
+                std::lock_guard<std::mutex> lock(mutex);
+                errors[i] = e.what();
+                return;
+            }
+
+            // Both lists are ranked, so one merge keeps the combined top_n
+            std::lock_guard<std::mutex> lock(mutex);
+            ++result.screened;
+            std::vector<ScreenedStrategy> merged;
+            merged.reserve(result.strategies.size() + screened.size());
+            std::merge(std::make_move_iterator(result.strategies.begin()), std::make_move_iterator(result.strategies.end()),
+                       std::make_move_iterator(screened.begin()), std::make_move_iterator(screened.end()),
+                       std::back_inserter(merged), ranks_before);
+            if (merged.size() > config.top_n) {
+                merged.resize(config.top_n);
+            }
+            result.strategies = std::move(merged);
+        });
+    }
+
+    WorkStealingPool pool(config.threads);
+    pool.run(tasks);
+
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (errors[i].has_value()) {
+            result.failures.push_back({inputs[i], errors[i].value()});
+        }
+    }
+    return result;
+}
+
+void BatchResult::print() const {
+    if (strategies.empty()) {
+        std::cout << "No strategies found." << std::endl;
+        return;
+    }
+
+    print_strategy_header(true);
+    for (size_t i = 0; i < strategies.size(); ++i) {
+        print_strategy_row(i, strategies[i].name, strategies[i].record, strategies[i].symbol.c_str());
+    }
+}
+
+void BatchResult::write(ResultWriter& writer) const {
+    for (const ScreenedStrategy& s : strategies) {
+        writer.write(s.row());
+    }
+}
+
+ResultRow ScreenedStrategy::row() const {
+    ResultRow row{};
+    row.symbol = symbol;
+    row.kind = record.kind;
+    row.leg_count = record.leg_count;
+    for (size_t l = 0; l < record.leg_count; ++l) {
+        row.legs[l] = {legs[l].side, record.sign[l], legs[l].strike, legs[l].expiry};
+    }
+    row.metrics = &record.metrics();
+    return row;
+}
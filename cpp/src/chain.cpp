@@ -0,0 +1,93 @@
+#include "chain.hpp"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+void OptionChain::reserve(size_t n) {
+    strike.reserve(n);
+    mid.reserve(n);
+    iv.reserve(n);
+    volume.reserve(n);
+    oi.reserve(n);
+    bid.reserve(n);
+    ask.reserve(n);
+    delta.reserve(n);
+    gamma.reserve(n);
+    theta.reserve(n);
+    vega.reserve(n);
+    rho.reserve(n);
+    expiry_id.reserve(n);
+    side.reserve(n);
+}
+
+uint16_t OptionChain::intern_expiry(const std::string& expiry, int days_to_expiry) {
+    // Rows arrive grouped by expiry, so the last entry is the usual hit
+    for (size_t e = expiries.size(); e-- > 0;) {
+        if (expiries[e] == expiry) {
+            return static_cast<uint16_t>(e);
+        }
+    }
+    if (expiries.size() > std::numeric_limits<uint16_t>::max()) {
+        throw std::runtime_error("Too many expiries in chain for " + symbol);
+    }
+    expiries.push_back(expiry);
+    expiry_days.push_back(days_to_expiry);
+    return static_cast<uint16_t>(expiries.size() - 1);
+}
+
+std::optional<uint16_t> OptionChain::find_expiry(const std::string& expiry) const {
+    for (size_t e = 0; e < expiries.size(); ++e) {
+        if (expiries[e] == expiry) {
+            return static_cast<uint16_t>(e);
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<uint16_t> OptionChain::expiry_order() const {
+    std::vector<uint16_t> order(expiries.size());
+    std::iota(order.begin(), order.end(), uint16_t(0));
+    std::sort(order.begin(), order.end(),
+        [&](uint16_t a, uint16_t b) { return expiries[a] < expiries[b]; });
+    return order;
+}
+
+void OptionChain::push_back(const Option& opt) {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    strike.push_back(opt.strike);
+    mid.push_back(opt.mid);
+    iv.push_back(opt.iv);
+    volume.push_back(opt.volume);
+    oi.push_back(opt.oi);
+    bid.push_back(opt.bid.value_or(nan));
+    ask.push_back(opt.ask.value_or(nan));
+    delta.push_back(opt.delta);
+    gamma.push_back(opt.gamma);
+    theta.push_back(opt.theta);
+    vega.push_back(opt.vega);
+    rho.push_back(opt.rho);
+    expiry_id.push_back(intern_expiry(opt.expiry, opt.days_to_expiry));
+    side.push_back(opt.side);
+}
+
+Option OptionChain::option(size_t i) const {
+    Option opt;
+    opt.symbol = symbol;
+    opt.expiry = expiry(i);
+    opt.strike = strike[i];
+    opt.side = side[i];
+    opt.mid = mid[i];
+    opt.iv = iv[i];
+    opt.volume = volume[i];
+    opt.oi = oi[i];
+    opt.delta = delta[i];
+    opt.gamma = gamma[i];
+    opt.theta = theta[i];
+    opt.vega = vega[i];
+    opt.rho = rho[i];
+    opt.days_to_expiry = days_to_expiry(i);
+    opt.bid = std::isnan(bid[i]) ? std::nullopt : std::make_optional(bid[i]);
+    opt.ask = std::isnan(ask[i]) ? std::nullopt : std::make_optional(ask[i]);
+    return opt;
+}
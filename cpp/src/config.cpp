@@ -1,4 +1,6 @@
 #include "config.hpp"
+#include "factory/rank_order.hpp"
+#include <cmath>
 #include <fstream>
 #include <json.hpp>
 #include <sstream>
@@ -13,7 +15,7 @@ static Direction string_to_direction(const std::string& str) {
     return Direction::SHORT;
 }
 
-ConfigFilter ConfigLoader::load_from_json(const std::string& path) {
+static json read_config_json(const std::string& path) {
     std::ifstream file(path);
     if (!file.is_open()) {
         throw std::runtime_error("Cannot open config file: " + path);
@@ -21,7 +23,11 @@ ConfigFilter ConfigLoader::load_from_json(const std::string& path) {
 
     json config_json;
     file >> config_json;
-    
+    return config_json;
+}
+
+// Sections are taken by value so that operator[] can default missing keys to null
+static ConfigFilter parse_config_filter(json config_json) {
     // Get config_filter section
     json config = config_json["config_filter"];
 
@@ -43,6 +49,22 @@ ConfigFilter ConfigLoader::load_from_json(const std::string& path) {
     }
     cfg.max_bid_ask_spread = config["max_bid_ask_spread"].is_null() ? std::nullopt : std::make_optional(config["max_bid_ask_spread"].get<double>());
 
+    // Leg-level filters
+    if (!config["short_delta_range"].is_null()) {
+        auto range = config["short_delta_range"];
+        cfg.short_delta_range = std::make_tuple(range[0].get<double>(), range[1].get<double>());
+        auto [lo, hi] = cfg.short_delta_range.value();
+        if (!(lo >= 0.0 && lo <= hi)) {
+            throw std::runtime_error("Invalid \"short_delta_range\" in config: expected 0 <= min <= max (absolute delta)");
+        }
+    }
+    if (!config["max_wing_width"].is_null()) {
+        cfg.max_wing_width = config["max_wing_width"].get<double>();
+        if (!(cfg.max_wing_width.value() > 0.0)) {
+            throw std::runtime_error("Invalid \"max_wing_width\" in config: must be positive");
+        }
+    }
+
     // Strategy-level filters
     cfg.direction = config["direction"].is_null() ? std::nullopt : std::make_optional(string_to_direction(config["direction"].get<std::string>()));
     
@@ -86,15 +108,7 @@ ConfigFilter ConfigLoader::load_from_json(const std::string& path) {
     return cfg;
 }
 
-StrategyFilter ConfigLoader::load_strategy_filter_from_json(const std::string& path) {
-    std::ifstream file(path);
-    if (!file.is_open()) {
-        throw std::runtime_error("Cannot open config file: " + path);
-    }
-
-    json config_json;
-    file >> config_json;
-
+static StrategyFilter parse_strategy_filter(json config_json) {
     json sf = config_json["strategy_filter"];
     
     StrategyFilter s_filter;
@@ -102,7 +116,138 @@ StrategyFilter ConfigLoader::load_strategy_filter_from_json(const std::string& p
     s_filter.iron_condors = sf["iron_condors"].get<bool>();
     s_filter.straddles = sf["straddles"].get<bool>();
     s_filter.strangles = sf["strangles"].get<bool>();
+    // Added after the original four, so older configs may leave them out
+    s_filter.verticals = sf.value("verticals", false);
+    s_filter.butterflies = sf.value("butterflies", false);
+    s_filter.calendars = sf.value("calendars", false);
+    s_filter.diagonals = sf.value("diagonals", false);
 
     return s_filter;
 }
 
+static size_t parse_threads(const json& config_json) {
+    if (!config_json.contains("threads") || config_json["threads"].is_null()) {
+        return 1;
+    }
+    int threads = config_json["threads"].get<int>();
+    if (threads < 0) {
+        throw std::runtime_error("Invalid \"threads\" in config: " + std::to_string(threads));
+    }
+    return static_cast<size_t>(threads);
+}
+
+static uint64_t parse_memory_budget(const json& config_json) {
+    if (!config_json.contains("memory_budget_mb") || config_json["memory_budget_mb"].is_null()) {
+        return 0;
+    }
+    double mib = config_json["memory_budget_mb"].get<double>();
+    if (!(mib > 0)) {
+        throw std::runtime_error("Invalid \"memory_budget_mb\" in config: must be positive");
+    }
+    return static_cast<uint64_t>(mib * 1024.0 * 1024.0);
+}
+
+static ScenarioGrid parse_scenarios(const json& sc) {
+    ScenarioGrid grid;
+    auto axis = [&](const char* name, std::vector<double>& values) {
+        if (!sc.contains(name)) return;
+        values = sc[name].get<std::vector<double>>();
+        if (values.empty()) {
+            throw std::runtime_error(std::string("Empty \"scenarios.") + name + "\" in config");
+        }
+    };
+    axis("spot_shifts", grid.spot_shifts);
+    axis("iv_shifts", grid.iv_shifts);
+    axis("days_forward", grid.days_forward);
+    for (double days : grid.days_forward) {
+        if (!(days >= 0)) {
+            throw std::runtime_error("Invalid \"scenarios.days_forward\" in config: " + std::to_string(days));
+        }
+    }
+
+    const std::string model = sc.value("model", "greeks");
+    if (model == "greeks") {
+        grid.model = ScenarioModel::GREEKS;
+    } else if (model == "reprice") {
+        grid.model = ScenarioModel::REPRICE;
+    } else {
+        throw std::runtime_error("Invalid \"scenarios.model\" in config: " + model + " (greeks or reprice)");
+    }
+    return grid;
+}
+
+static PricingConfig parse_pricing(const json& pc) {
+    PricingConfig pricing;
+    const std::string mode = pc.value("recompute", "missing");
+    if (mode == "missing") {
+        pricing.mode = PricingMode::MISSING;
+    } else if (mode == "all") {
+        pricing.mode = PricingMode::ALL;
+    } else {
+        throw std::runtime_error("Invalid \"pricing.recompute\" in config: " + mode + " (missing or all)");
+    }
+    if (pc.contains("rate") && !pc["rate"].is_null()) {
+        pricing.rate = pc["rate"].get<double>();
+        if (!std::isfinite(pricing.rate)) {
+            throw std::runtime_error("Invalid \"pricing.rate\" in config");
+        }
+    }
+    return pricing;
+}
+
+static ScreenerConfig parse_screener_config(json config_json) {
+    ScreenerConfig config;
+    config.strategy_filter = parse_strategy_filter(config_json);
+    config.config_filter = parse_config_filter(config_json);
+
+    json ranking = config_json["ranking"];
+    config.rank_key = ranking["key"].get<std::string>();
+    try {
+        RankOrder validate(config.rank_key);
+    } catch (const std::invalid_argument& e) {
+        throw std::runtime_error(std::string("Invalid \"ranking.key\" in config: ") + e.what());
+    }
+    config.top_n = ranking["top_n"].get<size_t>();
+    config.pareto = ranking.value("pareto", "");
+    try {
+        RankOrder validate(config.pareto);
+    } catch (const std::invalid_argument& e) {
+        throw std::runtime_error(std::string("Invalid \"ranking.pareto\" in config: ") + e.what());
+    }
+
+    config.threads = parse_threads(config_json);
+    config.memory_budget = parse_memory_budget(config_json);
+    if (config_json.contains("scenarios") && !config_json["scenarios"].is_null()) {
+        config.scenarios = parse_scenarios(config_json["scenarios"]);
+    }
+    if (config_json.contains("pricing") && !config_json["pricing"].is_null()) {
+        config.pricing = parse_pricing(config_json["pricing"]);
+    }
+    return config;
+}
+
+ScreenerConfig ConfigLoader::load(const std::string& path) {
+    return parse_screener_config(read_config_json(path));
+}
+
+ScreenerConfig ConfigLoader::parse(const std::string& text) {
+    json config_json;
+    try {
+        config_json = json::parse(text);
+    } catch (const json::parse_error& e) {
+        throw std::runtime_error(std::string("Invalid config JSON: ") + e.what());
+    }
+    return parse_screener_config(config_json);
+}
+
+ConfigFilter ConfigLoader::load_from_json(const std::string& path) {
+    return parse_config_filter(read_config_json(path));
+}
+
+StrategyFilter ConfigLoader::load_strategy_filter_from_json(const std::string& path) {
+    return parse_strategy_filter(read_config_json(path));
+}
+
+size_t ConfigLoader::load_threads_from_json(const std::string& path) {
+    return parse_threads(read_config_json(path));
+}
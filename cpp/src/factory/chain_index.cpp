@@ -0,0 +1,175 @@
+#include "factory/chain_index.hpp"
+#include "factory/option_filter.hpp"
+#include <algorithm>
+#include <cmath>
+
+// ===================== EXPIRY SLICE =====================
+
+ExpirySlice::Range ExpirySlice::strike_range(const OptionChain& chain, Side s, double lo, double hi) const {
+    const auto& rows = side(s);
+    auto below = [&](uint32_t row, double value) { return chain.strike[row] < value; };
+    auto above = [&](double value, uint32_t row) { return value < chain.strike[row]; };
+    const size_t begin = std::lower_bound(rows.begin(), rows.end(), lo, below) - rows.begin();
+    const size_t end = std::upper_bound(rows.begin() + begin, rows.end(), hi, above) - rows.begin();
+    return {begin, std::max(begin, end)};
+}
+
+ExpirySlice::Range ExpirySlice::moneyness_range(const OptionChain& chain, Side s, double spot, double lo,
+                                                double hi) const {
+    return strike_range(chain, s, lo * spot, hi * spot);
+}
+
+ExpirySlice::Range ExpirySlice::delta_range(const OptionChain& chain, Side s, double lo, double hi) const {
+    const auto& rows = side(s);
+    auto in_range = [&](uint32_t row) {
+        const double d = std::fabs(chain.delta[row]);
+        return d >= lo && d <= hi;
+    };
+
+    if (delta_monotone(s)) {
+        // Calls run from high |delta| to low, puts from low to high
+        auto before = [&](uint32_t row) {
+            const double d = std::fabs(chain.delta[row]);
+            return s == Side::CALL ? d > hi : d < lo;
+        };
+        auto inside = [&](uint32_t row) {
+            const double d = std::fabs(chain.delta[row]);
+            return s == Side::CALL ? d >= lo : d <= hi;
+        };
+        const size_t begin = std::partition_point(rows.begin(), rows.end(), before) - rows.begin();
+        const size_t end = std::partition_point(rows.begin() + begin, rows.end(), inside) - rows.begin();
+        return {begin, end};
+    }
+
+    size_t begin = rows.size(), end = 0;
+    for (size_t k = 0; k < rows.size(); ++k) {
+        if (!in_range(rows[k])) continue;
+        begin = std::min(begin, k);
+        end = k + 1;
+    }
+    return begin < end ? Range{begin, end} : Range{0, 0};
+}
+
+// ===================== CHAIN LAYOUT =====================
+
+ChainLayout::ChainLayout(const OptionChain& chain) {
+    std::vector<Expiry> by_id(chain.expiries.size());
+    for (size_t e = 0; e < by_id.size(); ++e) {
+        by_id[e].expiry_id = uint16_t(e);
+    }
+    for (uint32_t i = 0; i < chain.size(); ++i) {
+        Expiry& expiry = by_id[chain.expiry_id[i]];
+        (chain.is_call(i) ? expiry.calls : expiry.puts).push_back(i);
+    }
+
+    auto by_strike = [&](uint32_t a, uint32_t b) { return chain.strike[a] < chain.strike[b]; };
+    for (uint16_t id : chain.expiry_order()) {
+        Expiry& expiry = by_id[id];
+        if (expiry.calls.empty() && expiry.puts.empty()) continue;
+        std::stable_sort(expiry.calls.begin(), expiry.calls.end(), by_strike);
+        std::stable_sort(expiry.puts.begin(), expiry.puts.end(), by_strike);
+        expiries.push_back(std::move(expiry));
+    }
+}
+
+ChainIndex::ChainIndex(const OptionChain& chain, double spot, const ConfigFilter& cfg, const ChainLayout* layout,
+                       std::pmr::memory_resource* resource, ScreenStats* stats)
+    : chain_(chain), spot_(spot), rows_(resource), expiries_(resource) {
+    {
+        StageTimer timer(stats, "option_filter");
+        OptionFilter filter(chain, spot);
+        filter.apply_filter(cfg);
+        rows_.assign(filter.result().begin(), filter.result().end());
+    }
+
+    // A separate row-by-row pass, so the fused filter stays branch-free
+    if (stats) {
+        CompiledOptionFilter compiled(cfg, chain);
+        OptionCounters& counters = stats->options();
+        counters.rows += chain.size();
+        counters.passed += rows_.size();
+        for (size_t i = 0; i < chain.size(); ++i) {
+            OptionCriterion criterion = compiled.rejection(chain, i);
+            if (criterion != OptionCriterion::NONE) ++counters.rejected[size_t(criterion)];
+        }
+    }
+
+    StageTimer timer(stats, "chain_index");
+
+    auto strike_less = [&](uint32_t row, double value) { return chain.strike[row] < value; };
+    auto less_strike = [&](double value, uint32_t row) { return value < chain.strike[row]; };
+    auto monotone = [&](const std::pmr::vector<uint32_t>& rows, bool increasing) {
+        for (size_t k = 1; k < rows.size(); ++k) {
+            const double prev = std::fabs(chain.delta[rows[k - 1]]);
+            const double next = std::fabs(chain.delta[rows[k]]);
+            if (!(increasing ? prev <= next : prev >= next)) return false;
+        }
+        return true;
+    };
+    auto split_otm = [&](ExpirySlice& slice) {
+        slice.otm_call_begin = std::upper_bound(slice.calls.begin(), slice.calls.end(), spot, less_strike)
+                             - slice.calls.begin();
+        slice.otm_put_end = std::lower_bound(slice.puts.begin(), slice.puts.end(), spot, strike_less)
+                          - slice.puts.begin();
+
+        slice.calls_delta_monotone = monotone(slice.calls, false);
+        slice.puts_delta_monotone = monotone(slice.puts, true);
+        if (cfg.short_delta_range.has_value()) {
+            auto [lo, hi] = cfg.short_delta_range.value();
+            slice.short_calls = slice.delta_range(chain, Side::CALL, lo, hi);
+            slice.short_puts = slice.delta_range(chain, Side::PUT, lo, hi);
+        } else {
+            slice.short_calls = {0, slice.calls.size()};
+            slice.short_puts = {0, slice.puts.size()};
+        }
+    };
+
+    if (layout) {
+        // A sorted order filtered in place is the sorted order of the
+        // filtered rows, since the sort is stable
+        std::pmr::vector<uint8_t> pass(chain.size(), 0, resource);
+        for (uint32_t i : rows_) pass[i] = 1;
+        for (const ChainLayout::Expiry& expiry : layout->expiries) {
+            ExpirySlice slice{expiry.expiry_id, std::pmr::vector<uint32_t>(resource),
+                              std::pmr::vector<uint32_t>(resource), 0, 0};
+            for (uint32_t i : expiry.calls) {
+                if (pass[i]) slice.calls.push_back(i);
+            }
+            for (uint32_t i : expiry.puts) {
+                if (pass[i]) slice.puts.push_back(i);
+            }
+            if (slice.calls.empty() && slice.puts.empty()) continue;
+            split_otm(slice);
+            expiries_.push_back(std::move(slice));
+        }
+        return;
+    }
+
+    std::pmr::vector<ExpirySlice> by_id(resource);
+    by_id.reserve(chain.expiries.size());
+    for (size_t e = 0; e < chain.expiries.size(); ++e) {
+        by_id.push_back(ExpirySlice{uint16_t(e), std::pmr::vector<uint32_t>(resource),
+                                    std::pmr::vector<uint32_t>(resource), 0, 0});
+    }
+    for (uint32_t i : rows_) {
+        ExpirySlice& slice = by_id[chain.expiry_id[i]];
+        if (chain.is_call(i)) {
+            slice.calls.push_back(i);
+        } else {
+            slice.puts.push_back(i);
+        }
+    }
+
+    auto by_strike = [&](uint32_t a, uint32_t b) { return chain.strike[a] < chain.strike[b]; };
+
+    for (uint16_t id : chain.expiry_order()) {
+        ExpirySlice& slice = by_id[id];
+        if (slice.calls.empty() && slice.puts.empty()) continue;
+
+        std::stable_sort(slice.calls.begin(), slice.calls.end(), by_strike);
+        std::stable_sort(slice.puts.begin(), slice.puts.end(), by_strike);
+
+        split_otm(slice);
+        expiries_.push_back(std::move(slice));
+    }
+}
@@ -1,5 +1,70 @@
 #include "factory/factory.hpp"
 #include <limits>
+#include <cstring>
+#include <stdexcept>
 
 // Implementation mostly in header
 
+// ===================== PAGE CURSORS =====================
+// A token is the bit patterns of the rank keys, task and seq as fixed-width
+// hex words, so values round-trip exactly.
+
+namespace {
+
+constexpr size_t CURSOR_WORDS = MAX_RANK_KEYS + 2;
+constexpr size_t WORD_DIGITS = 16;
+
+uint64_t key_bits(double key) {
+    uint64_t bits;
+    std::memcpy(&bits, &key, sizeof bits);
+    return bits;
+}
+
+double bits_key(uint64_t bits) {
+    double key;
+    std::memcpy(&key, &bits, sizeof key);
+    return key;
+}
+
+}  // namespace
+
+std::string PageCursor::to_string() const {
+    uint64_t words[CURSOR_WORDS];
+    for (size_t k = 0; k < MAX_RANK_KEYS; ++k) words[k] = key_bits(value.key[k]);
+    words[MAX_RANK_KEYS] = task;
+    words[MAX_RANK_KEYS + 1] = seq;
+
+    static const char digits[] = "0123456789abcdef";
+    std::string token(CURSOR_WORDS * WORD_DIGITS, '0');
+    for (size_t w = 0; w < CURSOR_WORDS; ++w) {
+        for (size_t d = 0; d < WORD_DIGITS; ++d) {
+            token[w * WORD_DIGITS + d] = digits[(words[w] >> (4 * (WORD_DIGITS - 1 - d))) & 0xf];
+        }
+    }
+    return token;
+}
+
+PageCursor PageCursor::parse(const std::string& token) {
+    if (token.size() != CURSOR_WORDS * WORD_DIGITS) {
+        throw std::runtime_error("invalid page cursor '" + token + "'");
+    }
+    uint64_t words[CURSOR_WORDS] = {};
+    for (size_t i = 0; i < token.size(); ++i) {
+        const char c = token[i];
+        uint64_t digit;
+        if (c >= '0' && c <= '9') {
+            digit = uint64_t(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            digit = uint64_t(c - 'a' + 10);
+        } else {
+            throw std::runtime_error("invalid page cursor '" + token + "'");
+        }
+        words[i / WORD_DIGITS] = (words[i / WORD_DIGITS] << 4) | digit;
+    }
+
+    PageCursor cursor;
+    for (size_t k = 0; k < MAX_RANK_KEYS; ++k) cursor.value.key[k] = bits_key(words[k]);
+    cursor.task = words[MAX_RANK_KEYS];
+    cursor.seq = words[MAX_RANK_KEYS + 1];
+    return cursor;
+}
@@ -1,4 +1,121 @@
 #include "factory/option_filter.hpp"
+#include "simd.hpp"
+#include <cmath>
+#include <tuple>
 
-// Implementation is mostly in header
+const char* option_criterion_name(OptionCriterion criterion) {
+    switch (criterion) {
+        case OptionCriterion::VOLUME: return "min_volume";
+        case OptionCriterion::OI: return "min_oi";
+        case OptionCriterion::PRICE: return "min_price";
+        case OptionCriterion::VOLUME_RATIO: return "volume_ratio_range";
+        case OptionCriterion::SPREAD: return "max_bid_ask_spread";
+        case OptionCriterion::EXPIRY: return "expiry";
+        case OptionCriterion::NONE:
+        case OptionCriterion::COUNT: break;
+    }
+    return "none";
+}
 
+CompiledOptionFilter::CompiledOptionFilter(const ConfigFilter& cfg, const OptionChain& chain)
+    : CompiledOptionFilter(cfg) {
+    expiry_ok.resize(chain.expiries.size());
+    for (size_t e = 0; e < chain.expiries.size(); ++e) {
+        expiry_ok[e] = expiry_passes(cfg, chain.expiries[e], chain.expiry_days[e]);
+    }
+}
+
+CompiledOptionFilter::CompiledOptionFilter(const ConfigFilter& cfg) {
+    if (cfg.min_volume.has_value()) {
+        check_volume = true;
+        min_volume = cfg.min_volume.value();
+    }
+    if (cfg.min_oi.has_value()) {
+        check_oi = true;
+        min_oi = cfg.min_oi.value();
+    }
+    if (cfg.min_price.has_value()) {
+        check_price = true;
+        min_price = cfg.min_price.value();
+    }
+    if (cfg.volume_ratio_range.has_value()) {
+        check_ratio = true;
+        std::tie(min_ratio, max_ratio) = cfg.volume_ratio_range.value();
+    }
+    if (cfg.max_bid_ask_spread.has_value()) {
+        check_spread = true;
+        max_spread = cfg.max_bid_ask_spread.value();
+    }
+}
+
+bool CompiledOptionFilter::expiry_passes(const ConfigFilter& cfg, const std::string& expiry, int days) {
+    if (cfg.expiry.has_value() && expiry != cfg.expiry.value()) {
+        return false;
+    }
+    if (cfg.days_to_expiry_range.has_value()) {
+        auto [min_days, max_days] = cfg.days_to_expiry_range.value();
+        if (days < min_days || days > max_days) {
+            return false;
+        }
+    }
+    return true;
+}
+
+SIMD_TARGET_CLONES
+void CompiledOptionFilter::evaluate(const OptionChain& chain, uint8_t* __restrict mask) const {
+    const size_t n = chain.size();
+    const double* __restrict volume = chain.volume.data();
+    const double* __restrict oi = chain.oi.data();
+    const double* __restrict mid = chain.mid.data();
+    const double* __restrict bid = chain.bid.data();
+    const double* __restrict ask = chain.ask.data();
+
+    // Numeric criteria: no branches, so the loop vectorizes. A disabled
+    // criterion always passes; NaN fails every enabled comparison, which
+    // also rejects missing bid/ask for the spread and oi == 0 for the ratio.
+    const bool v_on = check_volume, o_on = check_oi, p_on = check_price;
+    const bool r_on = check_ratio, s_on = check_spread;
+    const double v_min = min_volume, o_min = min_oi, p_min = min_price;
+    const double r_min = min_ratio, r_max = max_ratio, s_max = max_spread;
+    for (size_t i = 0; i < n; ++i) {
+        double price = mid[i] > 0.0 ? mid[i] : 0.0;
+        double ratio = volume[i] / oi[i];
+        double spread = std::fabs(ask[i] - bid[i]);
+
+        bool keep = (!v_on | (volume[i] >= v_min)) &
+                    (!o_on | (oi[i] >= o_min)) &
+                    (!p_on | (price >= p_min)) &
+                    (!r_on | ((oi[i] > 0.0) & (ratio >= r_min) & (ratio <= r_max))) &
+                    (!s_on | (spread <= s_max));
+        mask[i] = keep;
+    }
+
+    // Expiry-level criteria, one table lookup per row
+    const uint16_t* __restrict expiry_id = chain.expiry_id.data();
+    const uint8_t* __restrict ok = expiry_ok.data();
+    for (size_t i = 0; i < n; ++i) {
+        mask[i] &= ok[expiry_id[i]];
+    }
+}
+
+OptionCriterion CompiledOptionFilter::rejection(const OptionChain& chain, size_t i) const {
+    // A row of a skipped expiry counts as an expiry rejection whatever its quotes
+    if (!expiry_ok[chain.expiry_id[i]]) return OptionCriterion::EXPIRY;
+    return quote_rejection(chain.volume[i], chain.oi[i], chain.mid[i], chain.bid[i], chain.ask[i]);
+}
+
+OptionCriterion CompiledOptionFilter::quote_rejection(double volume, double oi, double mid, double bid,
+                                                      double ask) const {
+    double price = mid > 0.0 ? mid : 0.0;
+    double ratio = volume / oi;
+    double spread = std::fabs(ask - bid);
+
+    if (check_volume && !(volume >= min_volume)) return OptionCriterion::VOLUME;
+    if (check_oi && !(oi >= min_oi)) return OptionCriterion::OI;
+    if (check_price && !(price >= min_price)) return OptionCriterion::PRICE;
+    if (check_ratio && !(oi > 0.0 && ratio >= min_ratio && ratio <= max_ratio)) {
+        return OptionCriterion::VOLUME_RATIO;
+    }
+    if (check_spread && !(spread <= max_spread)) return OptionCriterion::SPREAD;
+    return OptionCriterion::NONE;
+}
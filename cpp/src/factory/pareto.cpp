@@ -0,0 +1,100 @@
+#include "factory/pareto.hpp"
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <numeric>
+
+namespace {
+
+// Maxima of the points (a, b) inserted so far: a ascending, b descending
+class Staircase {
+public:
+    // True if an inserted point is at least (a, b) on both keys
+    bool covers(double a, double b) const {
+        auto it = steps_.lower_bound(a);
+        return it != steps_.end() && it->second >= b;
+    }
+
+    void insert(double a, double b) {
+        if (covers(a, b)) return;
+        auto it = steps_.upper_bound(a);
+        while (it != steps_.begin()) {
+            auto prev = std::prev(it);
+            if (prev->second > b) break;
+            it = steps_.erase(prev);
+        }
+        steps_[a] = b;
+    }
+
+private:
+    std::map<double, double> steps_;
+};
+
+bool dominates(const RankValue& a, const RankValue& b, size_t keys) {
+    bool better = false;
+    for (size_t k = 0; k < keys; ++k) {
+        if (a.key[k] < b.key[k]) return false;
+        better |= a.key[k] > b.key[k];
+    }
+    return better;
+}
+
+}  // namespace
+
+std::vector<uint32_t> pareto_front(const RankOrder& order, std::span<const StrategyRecord> records) {
+    const size_t keys = order.keys();
+    std::vector<uint32_t> idx(records.size());
+    std::iota(idx.begin(), idx.end(), uint32_t(0));
+    if (keys == 0 || records.empty()) return idx;
+
+    std::vector<RankValue> values(records.size());
+    for (size_t i = 0; i < records.size(); ++i) {
+        values[i] = order.value(records[i]);
+    }
+    // Best first, lexicographically: nothing is dominated by a later point
+    std::sort(idx.begin(), idx.end(), [&](uint32_t a, uint32_t b) {
+        if (RankOrder::before(values[a], values[b])) return true;
+        if (RankOrder::before(values[b], values[a])) return false;
+        return a < b;
+    });
+
+    std::vector<uint32_t> front;
+    if (keys == 1) {
+        for (uint32_t i : idx) {
+            if (values[i].key[0] != values[idx[0]].key[0]) break;
+            front.push_back(i);
+        }
+    } else if (keys <= 3) {
+        // An earlier point in sorted order is at least as good on the first
+        // key, so it dominates a later one iff it differs and is at least as
+        // good on the other keys: a staircase query. Identical points sit
+        // together and are checked as one, before any of them is inserted.
+        Staircase earlier;
+        for (size_t begin = 0; begin < idx.size();) {
+            const RankValue& v = values[idx[begin]];
+            size_t end = begin + 1;
+            while (end < idx.size() && !RankOrder::before(v, values[idx[end]])) ++end;
+
+            const double second = keys == 3 ? v.key[2] : 0.0;
+            if (!earlier.covers(v.key[1], second)) {
+                front.insert(front.end(), idx.begin() + begin, idx.begin() + end);
+            }
+            earlier.insert(v.key[1], second);
+            begin = end;
+        }
+    } else {
+        for (uint32_t i : idx) {
+            bool dominated = false;
+            for (uint32_t f : front) {
+                if (dominates(values[f], values[i], keys)) {
+                    dominated = true;
+                    break;
+                }
+            }
+            if (!dominated) front.push_back(i);
+        }
+    }
+
+    std::sort(front.begin(), front.end());
+    return front;
+}
@@ -0,0 +1,252 @@
+#include "factory/pricing.hpp"
+#include "factory/bs_kernel.hpp"
+#include "simd.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+namespace {
+
+constexpr size_t MAX_ITERATIONS = 64;
+constexpr double MIN_VOL = 1e-4;
+constexpr double MAX_VOL = 10.0;
+constexpr double INITIAL_VOL = 0.3;  // when Corrado-Miller has no real root
+constexpr double PI = 3.14159265358979323846;
+constexpr double INV_SQRT_2PI = 0.39894228040143267794;
+
+using detail::norm_cdf;
+
+// Rows being solved or valued, one column per input
+struct Block {
+    uint32_t row[PRICING_BLOCK];
+    alignas(64) double years[PRICING_BLOCK];
+    alignas(64) double sqrt_t[PRICING_BLOCK];
+    alignas(64) double discounted[PRICING_BLOCK];  // strike * e^(-rate * years)
+    alignas(64) double log_forward[PRICING_BLOCK];  // ln(spot / discounted)
+    alignas(64) double phi[PRICING_BLOCK];  // +1 call, -1 put
+    alignas(64) double price[PRICING_BLOCK];
+    alignas(64) double vol[PRICING_BLOCK];
+    alignas(64) double lo[PRICING_BLOCK];
+    alignas(64) double hi[PRICING_BLOCK];
+    alignas(64) double error[PRICING_BLOCK];  // |model - price| / price at vol
+    size_t size = 0;
+};
+
+// One safeguarded Newton step of every row; a row already within
+// PRICING_TOLERANCE keeps its vol. error is measured before the step.
+SIMD_TARGET_CLONES
+void newton_step(Block& b, double spot) {
+    for (size_t i = 0; i < b.size; ++i) {
+        const double vol = b.vol[i];
+        const double sd = vol * b.sqrt_t[i];
+        const double d1 = b.log_forward[i] / sd + 0.5 * sd;
+        const double d2 = d1 - sd;
+        double g1, g2;
+        const double n1 = norm_cdf(b.phi[i] * d1, g1);
+        const double n2 = norm_cdf(b.phi[i] * d2, g2);
+        const double model = b.phi[i] * (spot * n1 - b.discounted[i] * n2);
+        const double vega = spot * g1 * INV_SQRT_2PI * b.sqrt_t[i];
+
+        const double diff = model - b.price[i];
+        const double error = std::fabs(diff) / b.price[i];
+        const bool done = error < PRICING_TOLERANCE;
+        const bool high = diff > 0.0;
+        const double lo = high ? b.lo[i] : vol;
+        const double hi = high ? vol : b.hi[i];
+        const double newton = vol - diff / vega;
+        const bool inside = newton > lo && newton < hi;
+
+        b.lo[i] = lo;
+        b.hi[i] = hi;
+        b.vol[i] = done ? vol : (inside ? newton : 0.5 * (lo + hi));
+        b.error[i] = error;
+    }
+}
+
+struct Greeks {
+    alignas(64) double delta[PRICING_BLOCK];
+    alignas(64) double gamma[PRICING_BLOCK];
+    alignas(64) double theta[PRICING_BLOCK];
+    alignas(64) double vega[PRICING_BLOCK];
+    alignas(64) double rho[PRICING_BLOCK];
+};
+
+SIMD_TARGET_CLONES
+void greeks(const Block& b, double spot, double rate, Greeks& out) {
+    for (size_t i = 0; i < b.size; ++i) {
+        const double vol = b.vol[i];
+        const double sd = vol * b.sqrt_t[i];
+        const double d1 = b.log_forward[i] / sd + 0.5 * sd;
+        const double d2 = d1 - sd;
+        double g1, g2;
+        const double n1 = norm_cdf(b.phi[i] * d1, g1);
+        const double n2 = norm_cdf(b.phi[i] * d2, g2);
+        const double pdf = g1 * INV_SQRT_2PI;
+        out.delta[i] = b.phi[i] * n1;
+        out.gamma[i] = pdf / (spot * sd);
+        out.theta[i] = (-spot * pdf * vol / (2.0 * b.sqrt_t[i]) - b.phi[i] * rate * b.discounted[i] * n2) / 365.0;
+        out.vega[i] = spot * pdf * b.sqrt_t[i] / 100.0;
+        out.rho[i] = b.phi[i] * b.discounted[i] * b.years[i] * n2 / 100.0;
+    }
+}
+
+class Pricer {
+public:
+    Pricer(OptionChain& chain, double spot, const PricingConfig& config, PricingCounters& counters)
+        : chain_(chain), spot_(spot), rate_(config.rate), counters_(counters) {}
+
+    void add(uint32_t row) {
+        const double years = chain_.days_to_expiry(row) / 365.0;
+        const double strike = chain_.strike[row];
+        if (!(years > 0.0) || !(strike > 0.0) || !(spot_ > 0.0)) {
+            ++counters_.failed;
+            return;
+        }
+
+        const double price = chain_.mid[row];
+        const double discounted = strike * std::exp(-rate_ * years);
+        const bool call = chain_.is_call(row);
+        const double lower = std::max(call ? spot_ - discounted : discounted - spot_, 0.0);
+        const double upper = call ? spot_ : discounted;
+        if (!(price > lower && price < upper)) {
+            quote(row);
+            return;
+        }
+
+        size_t i = load(solving_, row, years, discounted);
+        solving_.price[i] = price;
+        solving_.lo[i] = MIN_VOL;
+        solving_.hi[i] = MAX_VOL;
+        solving_.vol[i] = initial_vol(call, price, discounted, solving_.sqrt_t[i]);
+        if (solving_.size == PRICING_BLOCK) solve();
+    }
+
+    void finish() {
+        solve();
+        value();
+    }
+
+private:
+    OptionChain& chain_;
+    double spot_;
+    double rate_;
+    PricingCounters& counters_;
+    Block solving_;
+    Block valuing_;
+    Greeks greeks_;
+
+    size_t load(Block& b, uint32_t row, double years, double discounted) {
+        const size_t i = b.size++;
+        b.row[i] = row;
+        b.years[i] = years;
+        b.sqrt_t[i] = std::sqrt(years);
+        b.discounted[i] = discounted;
+        b.log_forward[i] = std::log(spot_ / discounted);
+        b.phi[i] = chain_.is_call(row) ? 1.0 : -1.0;
+        return i;
+    }
+
+    // Corrado-Miller on the call price (puts through parity), per unit time
+    double initial_vol(bool call, double price, double discounted, double sqrt_t) const {
+        const double c = call ? price : price + spot_ - discounted;
+        const double half = c - 0.5 * (spot_ - discounted);
+        const double root = half * half - (spot_ - discounted) * (spot_ - discounted) / PI;
+        const double vol = std::sqrt(2.0 * PI) / (spot_ + discounted) * (half + std::sqrt(std::max(root, 0.0))) / sqrt_t;
+        return vol > MIN_VOL && vol < MAX_VOL ? vol : INITIAL_VOL;
+    }
+
+    // No usable mid: greeks from the quoted IV, if there is one
+    void quote(uint32_t row) {
+        const double iv = chain_.iv[row];
+        if (!(iv > 0.0)) {
+            ++counters_.failed;
+            return;
+        }
+        ++counters_.quoted;
+        const double years = chain_.days_to_expiry(row) / 365.0;
+        const size_t i = load(valuing_, row, years, chain_.strike[row] * std::exp(-rate_ * years));
+        valuing_.vol[i] = iv;
+        if (valuing_.size == PRICING_BLOCK) value();
+    }
+
+    // Steps the block, retiring rows as they come within tolerance, so the
+    // few that never do (no time value left at double precision) run alone
+    void solve() {
+        for (size_t iteration = 0; iteration < MAX_ITERATIONS && solving_.size > 0; ++iteration) {
+            newton_step(solving_, spot_);
+            size_t kept = 0;
+            for (size_t i = 0; i < solving_.size; ++i) {
+                if (solving_.error[i] < PRICING_TOLERANCE) {
+                    ++counters_.solved;
+                    const size_t v = load(valuing_, solving_.row[i], solving_.years[i], solving_.discounted[i]);
+                    valuing_.vol[v] = solving_.vol[i];
+                    if (valuing_.size == PRICING_BLOCK) value();
+                } else {
+                    if (kept != i) move(solving_, i, kept);
+                    ++kept;
+                }
+            }
+            solving_.size = kept;
+        }
+        for (size_t i = 0; i < solving_.size; ++i) {
+            quote(solving_.row[i]);
+        }
+        solving_.size = 0;
+    }
+
+    static void move(Block& b, size_t from, size_t to) {
+        b.row[to] = b.row[from];
+        b.years[to] = b.years[from];
+        b.sqrt_t[to] = b.sqrt_t[from];
+        b.discounted[to] = b.discounted[from];
+        b.log_forward[to] = b.log_forward[from];
+        b.phi[to] = b.phi[from];
+        b.price[to] = b.price[from];
+        b.vol[to] = b.vol[from];
+        b.lo[to] = b.lo[from];
+        b.hi[to] = b.hi[from];
+    }
+
+    void value() {
+        greeks(valuing_, spot_, rate_, greeks_);
+        for (size_t i = 0; i < valuing_.size; ++i) {
+            const uint32_t row = valuing_.row[i];
+            chain_.iv[row] = valuing_.vol[i];
+            chain_.delta[row] = greeks_.delta[i];
+            chain_.gamma[row] = greeks_.gamma[i];
+            chain_.theta[row] = greeks_.theta[i];
+            chain_.vega[row] = greeks_.vega[i];
+            chain_.rho[row] = greeks_.rho[i];
+        }
+        valuing_.size = 0;
+    }
+};
+
+}  // namespace
+
+std::vector<uint32_t> pricing_rows(const OptionChain& chain, PricingMode mode) {
+    std::vector<uint32_t> rows;
+    for (uint32_t i = 0; i < chain.size(); ++i) {
+        const bool no_greeks = chain.delta[i] == 0.0 && chain.gamma[i] == 0.0 && chain.theta[i] == 0.0 &&
+                               chain.vega[i] == 0.0;
+        if (mode == PricingMode::ALL || !(chain.iv[i] > 0.0) || no_greeks) rows.push_back(i);
+    }
+    return rows;
+}
+
+void price_rows(OptionChain& chain, double spot, const PricingConfig& config, const std::vector<uint32_t>& rows,
+                PricingCounters* counters) {
+    PricingCounters local;
+    PricingCounters& out = counters ? *counters : local;
+    out.rows += rows.size();
+
+    // About 90 KiB of blocks, so kept off the stack
+    auto pricer = std::make_unique<Pricer>(chain, spot, config, out);
+    for (uint32_t row : rows) pricer->add(row);
+    pricer->finish();
+}
+
+void price_chain(OptionChain& chain, double spot, const PricingConfig& config, PricingCounters* counters) {
+    price_rows(chain, spot, config, pricing_rows(chain, config.mode), counters);
+}
@@ -0,0 +1,95 @@
+#include "factory/rank_order.hpp"
+#include <optional>
+#include <stdexcept>
+
+namespace {
+
+std::string trim(const std::string& s) {
+    size_t first = s.find_first_not_of(" \t");
+    if (first == std::string::npos) return "";
+    size_t last = s.find_last_not_of(" \t");
+    return s.substr(first, last - first + 1);
+}
+
+// Pieces of s between separators, trimmed
+std::vector<std::string> split(const std::string& s, char separator) {
+    std::vector<std::string> parts;
+    size_t begin = 0;
+    while (true) {
+        size_t end = s.find(separator, begin);
+        parts.push_back(trim(s.substr(begin, end == std::string::npos ? std::string::npos : end - begin)));
+        if (end == std::string::npos) break;
+        begin = end + 1;
+    }
+    return parts;
+}
+
+bool ends_with(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+}  // namespace
+
+RankOrder::RankOrder(const std::string& spec, bool reverse) {
+    const std::string trimmed = trim(spec);
+    if (trimmed.empty() || trimmed == "none") return;
+
+    for (std::string text : split(trimmed, ',')) {
+        if (keys_.size() == MAX_RANK_KEYS) {
+            throw std::invalid_argument("Rank key \"" + spec + "\" has more than " +
+                                        std::to_string(MAX_RANK_KEYS) + " keys");
+        }
+
+        std::optional<bool> descending;
+        if (ends_with(text, ":asc")) {
+            descending = false;
+            text = trim(text.substr(0, text.size() - 4));
+        } else if (ends_with(text, ":desc")) {
+            descending = true;
+            text = trim(text.substr(0, text.size() - 5));
+        }
+
+        Key key;
+        size_t begin = 0;
+        bool divide = false;
+        while (true) {
+            size_t end = text.find_first_of("*/", begin);
+            const std::string name = trim(text.substr(begin, end == std::string::npos ? std::string::npos : end - begin));
+
+            Factor f{Column::CONSTANT, divide, 0.0};
+            if (name == "rr") f.column = Column::RR;
+            else if (name == "gain") f.column = Column::GAIN;
+            else if (name == "loss") f.column = Column::LOSS;
+            else if (name == "cost") f.column = Column::COST;
+            else if (name == "debit") f.column = Column::DEBIT;
+            else if (name == "credit") f.column = Column::CREDIT;
+            else if (name == "delta" || name == "net_delta") f.column = Column::DELTA;
+            else if (name == "theta" || name == "net_theta") f.column = Column::THETA;
+            else if (name == "vega" || name == "net_vega") f.column = Column::VEGA;
+            else if (name == "iv") f.column = Column::IV;
+            else if (name == "liquidity") f.column = Column::LIQUIDITY;
+            else {
+                size_t used = 0;
+                try {
+                    f.constant = std::stod(name, &used);
+                } catch (const std::exception&) {
+                    used = 0;
+                }
+                if (name.empty() || used != name.size()) {
+                    throw std::invalid_argument("Unknown rank key \"" + name + "\" in \"" + spec + "\"");
+                }
+            }
+            key.factors.push_back(f);
+
+            if (end == std::string::npos) break;
+            divide = text[end] == '/';
+            begin = end + 1;
+        }
+
+        // Only a plain loss is naturally smallest first
+        const bool natural = !(key.factors.size() == 1 && key.factors[0].column == Column::LOSS);
+        const bool largest_first = descending.value_or(natural) == reverse;
+        key.sign = largest_first ? 1.0 : -1.0;
+        keys_.push_back(std::move(key));
+    }
+}
@@ -0,0 +1,128 @@
+#include "factory/scenario.hpp"
+#include "factory/factory.hpp"
+#include "factory/bs_kernel.hpp"
+#include "simd.hpp"
+#include "strategy/strategy_class.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <string>
+
+namespace {
+
+// Branch-free second-order expansion over every scenario
+SIMD_TARGET_CLONES
+void greeks_pnl(double delta, double gamma, double vega, double theta, const double* d_spot, const double* d_spot2,
+                const double* d_vol, const double* days, double* out, size_t n) {
+    for (size_t s = 0; s < n; ++s) {
+        out[s] = delta * d_spot[s] + gamma * d_spot2[s] + vega * d_vol[s] + theta * days[s];
+    }
+}
+
+// Branch-free Black-Scholes revaluation over every scenario, less the value
+// now; now is computed by the same code, so the unshifted scenario is zero
+SIMD_TARGET_CLONES
+void reprice_pnl(double phi, double strike, double years, double iv, double spot, const double* spot_at,
+                 const double* log_spot_at, const double* d_vol, const double* days, double* out, size_t n) {
+    const double log_strike = std::log(strike);
+    const double now = detail::bs_value(phi, spot, std::log(spot), strike, log_strike, years, iv);
+    for (size_t s = 0; s < n; ++s) {
+        const double later = std::max(years - days[s] / 365.0, 0.0);
+        const double vol = std::max(iv + d_vol[s], 0.0);
+        out[s] = detail::bs_value(phi, spot_at[s], log_spot_at[s], strike, log_strike, later, vol) - now;
+    }
+}
+
+SIMD_TARGET_CLONES
+void axpy(double* out, const double* x, double a, size_t n) {
+    for (size_t s = 0; s < n; ++s) {
+        out[s] += a * x[s];
+    }
+}
+
+// Shortest round trip, with a '+' on non-negative numbers if sign: "+0.05"
+std::string signed_number(double v, bool sign) {
+    char buf[32];
+    char* first = buf;
+    if (sign && !(v < 0)) *first++ = '+';
+    const auto result = std::to_chars(first, buf + sizeof(buf), v);
+    return std::string(buf, result.ptr);
+}
+
+}  // namespace
+
+// ===================== SCENARIO KERNEL =====================
+
+ScenarioKernel::ScenarioKernel(const ScenarioGrid& grid, double spot) : model_(grid.model), spot_(spot) {
+    const size_t n = grid.size();
+    d_spot_.reserve(n);
+    d_spot2_.reserve(n);
+    d_vol_.reserve(n);
+    days_.reserve(n);
+    spot_at_.reserve(n);
+    log_spot_at_.reserve(n);
+    for (double shift : grid.spot_shifts) {
+        for (double vol : grid.iv_shifts) {
+            for (double days : grid.days_forward) {
+                const double move = spot * shift;
+                d_spot_.push_back(move);
+                d_spot2_.push_back(0.5 * move * move);
+                d_vol_.push_back(vol);
+                days_.push_back(days);
+                spot_at_.push_back(spot + move);
+                log_spot_at_.push_back(std::log(spot + move));
+            }
+        }
+    }
+}
+
+void ScenarioKernel::leg(const OptionChain& chain, uint32_t row, double* out) const {
+    const size_t n = size();
+    if (model_ == ScenarioModel::GREEKS) {
+        // The loader stores missing greeks as 0, which would read as a leg
+        // that never moves; such a leg makes the P&L NaN instead
+        if (chain.delta[row] == 0.0 && chain.gamma[row] == 0.0 && chain.theta[row] == 0.0 && chain.vega[row] == 0.0) {
+            std::fill(out, out + n, std::numeric_limits<double>::quiet_NaN());
+            return;
+        }
+        // Vega is per vol point and theta per calendar day, as quoted
+        greeks_pnl(chain.delta[row], chain.gamma[row], chain.vega[row] * 100.0, chain.theta[row], d_spot_.data(),
+                   d_spot2_.data(), d_vol_.data(), days_.data(), out, n);
+        return;
+    }
+
+    reprice_pnl(chain.is_call(row) ? 1.0 : -1.0, chain.strike[row], chain.days_to_expiry(row) / 365.0,
+                chain.iv[row], spot_, spot_at_.data(), log_spot_at_.data(), d_vol_.data(), days_.data(), out, n);
+}
+
+void ScenarioKernel::accumulate(double* out, const double* leg, double weight, size_t n) {
+    axpy(out, leg, weight, n);
+}
+
+// ===================== SCENARIO MATRIX =====================
+
+void ScenarioMatrix::write_csv(std::FILE* out, const StrategyList& list) const {
+    std::string line = "rank,strategy";
+    for (double shift : grid.spot_shifts) {
+        for (double vol : grid.iv_shifts) {
+            for (double days : grid.days_forward) {
+                line += ",spot=" + signed_number(shift, true) + ";iv=" + signed_number(vol, true) +
+                        ";days=" + signed_number(days, false);
+            }
+        }
+    }
+    line += '\n';
+    std::fputs(line.c_str(), out);
+
+    const size_t m = scenarios();
+    for (size_t i = 0; i < strategies; ++i) {
+        line = std::to_string(i + 1) + ",\"" + list[i].pretty(list.chain()) + "\"";
+        const double* pnl = row(i);
+        for (size_t s = 0; s < m; ++s) {
+            line += ',' + signed_number(pnl[s], false);
+        }
+        line += '\n';
+        std::fputs(line.c_str(), out);
+    }
+}
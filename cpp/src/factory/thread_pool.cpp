@@ -0,0 +1,103 @@
+#include "factory/thread_pool.hpp"
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 1; i < threads; ++i) {
+        threads_.emplace_back(&WorkStealingPool::worker_loop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& t : threads_) {
+        t.join();
+    }
+}
+
+void WorkStealingPool::run(const std::vector<Task>& tasks) {
+    if (tasks.empty()) return;
+
+    remaining_ = tasks.size();
+    // Round-robin so every worker starts with local work
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        Queue& q = *queues_[i % queues_.size()];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.tasks.push_back(&tasks[i]);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    drain(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&] { return remaining_ == 0; });
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+bool WorkStealingPool::pop(size_t worker, const Task*& task) {
+    {
+        Queue& own = *queues_[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t k = 1; k < queues_.size(); ++k) {
+        Queue& victim = *queues_[(worker + k) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::drain(size_t worker) {
+    const Task* task;
+    while (pop(worker, task)) {
+        try {
+            (*task)(worker);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) error_ = std::current_exception();
+        }
+        if (remaining_.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            done_.notify_all();
+        }
+    }
+}
+
+void WorkStealingPool::worker_loop(size_t worker) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+        }
+        drain(worker);
+    }
+}
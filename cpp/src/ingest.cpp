@@ -0,0 +1,205 @@
+#include "ingest.hpp"
+#include "loader.hpp"
+#include "factory/pricing.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// Appends row i of from to `to`, under expiry id expiry of `to`
+void append_row(OptionChain& to, const OptionChain& from, size_t i, uint16_t expiry) {
+    to.strike.push_back(from.strike[i]);
+    to.mid.push_back(from.mid[i]);
+    to.iv.push_back(from.iv[i]);
+    to.volume.push_back(from.volume[i]);
+    to.oi.push_back(from.oi[i]);
+    to.bid.push_back(from.bid[i]);
+    to.ask.push_back(from.ask[i]);
+    to.delta.push_back(from.delta[i]);
+    to.gamma.push_back(from.gamma[i]);
+    to.theta.push_back(from.theta[i]);
+    to.vega.push_back(from.vega[i]);
+    to.rho.push_back(from.rho[i]);
+    to.expiry_id.push_back(expiry);
+    to.side.push_back(from.side[i]);
+}
+
+// Rows of expiry id e of chain as a chain of their own
+OptionChain expiry_chain(const OptionChain& chain, uint16_t e) {
+    OptionChain part;
+    part.symbol = chain.symbol;
+    const uint16_t id = part.intern_expiry(chain.expiries[e], chain.expiry_days[e]);
+    for (size_t i = 0; i < chain.size(); ++i) {
+        if (chain.expiry_id[i] == e) append_row(part, chain, i, id);
+    }
+    return part;
+}
+
+}  // namespace
+
+IngestScreener::IngestScreener(const ScreenerConfig& config) : config_(config) {
+    per_expiry_ = config.strategy_filter;
+    per_expiry_.calendars = false;
+    per_expiry_.diagonals = false;
+    cross_expiry_.calendars = config.strategy_filter.calendars;
+    cross_expiry_.diagonals = config.strategy_filter.diagonals;
+
+    size_t threads = config.threads != 0 ? config.threads : std::thread::hardware_concurrency();
+    threads = std::max<size_t>(threads, 1);
+    for (size_t w = 0; w < threads; ++w) {
+        workers_.emplace_back([this] { worker_loop(); });
+    }
+}
+
+IngestScreener::~IngestScreener() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+void IngestScreener::push(std::string_view line) {
+    if (line.find_first_not_of(" \t\r\n") == std::string_view::npos) return;
+
+    auto [chain, spot] = parse_option_snapshot(line);
+    if (!chain.symbol.empty()) {
+        if (chain_.symbol.empty()) {
+            chain_.symbol = chain.symbol;
+        } else if (chain.symbol != chain_.symbol) {
+            throw std::runtime_error("Stream mixes symbols " + chain_.symbol + " and " + chain.symbol);
+        }
+    }
+
+    if (!spot_.has_value() && spot.has_value()) {
+        spot_ = spot;
+        for (Segment* segment : pending_) queue(segment);
+        pending_.clear();
+    }
+
+    auto add = [&](OptionChain part) {
+        for (const auto& segment : segments_) {
+            if (segment->chain.expiries[0] == part.expiries[0]) {
+                throw std::runtime_error("Expiry " + part.expiries[0] + " arrived twice");
+            }
+        }
+        rows_ += part.size();
+        segments_.push_back(std::make_unique<Segment>(Segment{std::move(part), {}}));
+        if (spot_.has_value()) {
+            queue(segments_.back().get());
+        } else {
+            pending_.push_back(segments_.back().get());
+        }
+    };
+
+    // Lines usually hold one expiry, which is screened as parsed
+    if (chain.expiries.size() == 1) {
+        add(std::move(chain));
+    } else {
+        for (uint16_t e = 0; e < chain.expiries.size(); ++e) {
+            add(expiry_chain(chain, e));
+        }
+    }
+}
+
+void IngestScreener::queue(Segment* segment) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(segment);
+    }
+    wake_.notify_one();
+}
+
+void IngestScreener::worker_loop() {
+    while (true) {
+        Segment* segment = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return closed_ || !queue_.empty(); });
+            if (queue_.empty()) return;
+            segment = queue_.front();
+            queue_.pop_front();
+            if (error_) continue;
+        }
+
+        try {
+            if (config_.pricing.has_value()) price_chain(segment->chain, spot_.value(), *config_.pricing);
+            StrategyFactory factory(segment->chain, spot_.value(), 1);
+            segment->tops = factory.top_by_generator(per_expiry_, config_.config_filter,
+                                                     config_.rank_key, config_.top_n);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) error_ = std::current_exception();
+        }
+    }
+}
+
+StrategyList IngestScreener::finish() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+
+    if (error_) std::rethrow_exception(error_);
+    if (!spot_.has_value()) {
+        throw std::runtime_error("Could not determine spot price from the stream");
+    }
+
+    // Expiries in expiry order, each a contiguous block of the chain
+    std::vector<Segment*> order;
+    for (const auto& segment : segments_) order.push_back(segment.get());
+    std::sort(order.begin(), order.end(), [](const Segment* a, const Segment* b) {
+        return a->chain.expiries[0] < b->chain.expiries[0];
+    });
+
+    chain_.reserve(rows_);
+    std::vector<uint32_t> base(order.size());
+    for (size_t k = 0; k < order.size(); ++k) {
+        const OptionChain& part = order[k]->chain;
+        const uint16_t id = chain_.intern_expiry(part.expiries[0], part.expiry_days[0]);
+        base[k] = uint32_t(chain_.size());
+        for (size_t i = 0; i < part.size(); ++i) {
+            append_row(chain_, part, i, id);
+        }
+    }
+
+    // Calendars and diagonals are scheduled after every single-expiry
+    // structure, and each generator's tasks go in expiry order, so pushing
+    // the tops generator by generator, then expiry by expiry, breaks ties
+    // the way one screen of the assembled chain does
+    TopStrategies best(config_.rank_key, config_.top_n);
+    uint64_t task = 0;
+    const size_t generators = StrategyFactory::enabled_generators(per_expiry_).size();
+    for (size_t g = 0; g < generators; ++g) {
+        for (size_t k = 0; k < order.size(); ++k) {
+            const std::vector<StrategyRecord>& records = order[k]->tops[g].records();
+            for (size_t i = 0; i < records.size(); ++i) {
+                StrategyRecord s = records[i];
+                for (size_t l = 0; l < s.leg_count; ++l) s.leg[l] += base[k];
+                best.push(s, task, i);
+            }
+            ++task;
+        }
+    }
+
+    if (cross_expiry_.calendars || cross_expiry_.diagonals) {
+        StrategyFactory factory(chain_, spot_.value(), config_.threads);
+        for (const StrategyList& list : factory.top_by_generator(cross_expiry_, config_.config_filter,
+                                                                 config_.rank_key, config_.top_n)) {
+            for (size_t i = 0; i < list.size(); ++i) {
+                best.push(list[i], task, i);
+            }
+            ++task;
+        }
+    }
+    return best.take(chain_);
+}
@@ -1,133 +1,525 @@
 #include "loader.hpp"
-#include <fstream>
-#include <iostream>
+#include "mapped_file.hpp"
+#include "snapshot.hpp"
+#include "factory/option_filter.hpp"
+#include "stats.hpp"
+#include <filesystem>
 #include <sstream>
 #include <json.hpp>
 #include <chrono>
 #include <iomanip>
 #include <ctime>
 #include <cmath>
+#include <array>
+#include <cctype>
+#include <limits>
 
 using json = nlohmann::json;
 
-static double mid_price(const json& opt) {
-    auto bid = opt.find("bid");
-    auto ask = opt.find("ask");
-    auto last = opt.find("last");
+int calculate_days_to_expiry(const std::string& expiry_str) {
+    return calculate_days_to_expiry(expiry_str, std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
+}
 
-    if (bid != opt.end() && ask != opt.end() && 
-        bid->is_number() && ask->is_number()) {
-        return (bid->get<double>() + ask->get<double>()) / 2.0;
+int calculate_days_to_expiry(const std::string& expiry_str, std::time_t as_of) {
+    std::tm tm = {};
+    std::istringstream ss(expiry_str);
+    ss >> std::get_time(&tm, "%Y-%m-%d");
+
+    auto expiry_time = std::mktime(&tm);
+    double diff_seconds = std::difftime(expiry_time, as_of);
+    return static_cast<int>(std::floor(diff_seconds / 86400.0));
+}
+
+// ===================== TRADIER SAX HANDLER =====================
+// Streams a Tradier snapshot straight into OptionChain columns without
+// building a DOM. Only the paths below are interpreted; everything else is skipped:
+//
+//   symbols[0]
+//   timestamp
+//   underlying.{bid,ask,last}
+//   chains.<symbol>.<expiry>[row].{option_type,expiration_date,strike,bid,ask,
+//                                  last,volume,open_interest,greeks.*}
+//
+// With a ConfigFilter, rows failing its option-level criteria are dropped
+// as they end instead of being appended, and an <expiry> array whose key
+// fails expiry or days_to_expiry_range is skipped like any unknown value,
+// so none of its rows are built.
+class TradierSaxHandler {
+public:
+    explicit TradierSaxHandler(const ConfigFilter* filter = nullptr, OptionCounters* counters = nullptr)
+        : filter_(filter), counters_(counters) {
+        if (filter_) quote_filter_.emplace(*filter_);
     }
-    if (last != opt.end() && last->is_number()) {
-        return last->get<double>();
+
+    std::string symbol;
+    std::optional<double> spot;
+    std::optional<double> timestamp;
+
+    // Every chain seen, keyed by the chain's symbol
+    std::vector<std::pair<std::string, OptionChain>> chains;
+
+    bool null() { return value(std::numeric_limits<double>::quiet_NaN(), false); }
+    bool boolean(bool) { return value(std::numeric_limits<double>::quiet_NaN(), false); }
+    bool number_integer(json::number_integer_t v) { return value(static_cast<double>(v), true); }
+    bool number_unsigned(json::number_unsigned_t v) { return value(static_cast<double>(v), true); }
+    bool number_float(json::number_float_t v, const std::string&) { return value(v, true); }
+    bool binary(json::binary_t&) { return value(std::numeric_limits<double>::quiet_NaN(), false); }
+
+    bool string(std::string& s) {
+        if (skip_depth_ > 0) return true;
+        switch (context()) {
+            case Context::SYMBOLS:
+                if (!symbol_seen_) {
+                    symbol = s;
+                    symbol_seen_ = true;
+                }
+                break;
+            case Context::ROW:
+                if (key_ == Key::OPTION_TYPE) {
+                    row_.is_call = (s.size() == 4 &&
+                                    std::toupper(static_cast<unsigned char>(s[0])) == 'C' &&
+                                    std::toupper(static_cast<unsigned char>(s[1])) == 'A' &&
+                                    std::toupper(static_cast<unsigned char>(s[2])) == 'L' &&
+                                    std::toupper(static_cast<unsigned char>(s[3])) == 'L');
+                } else if (key_ == Key::EXPIRATION_DATE) {
+                    row_.expiry = s;
+                    row_.has_expiry = true;
+                }
+                break;
+            default:
+                break;
+        }
+        key_ = Key::OTHER;
+        return true;
     }
-    return 0.0;
-}
 
-static std::optional<double> extract_iv(const json& greeks) {
-    if (greeks.is_null() || !greeks.is_object()) {
-        return std::nullopt;
+    bool start_object(std::size_t) {
+        if (skip_depth_ > 0) {
+            // A row of a skipped expiry
+            if (skip_depth_ == 1 && skipping_expiry_) drop(OptionCriterion::EXPIRY);
+            ++skip_depth_;
+            return true;
+        }
+        Context ctx = context();
+        Context next = Context::SKIP;
+        if (stack_.empty()) {
+            next = Context::ROOT;
+        } else if (ctx == Context::ROOT && key_ == Key::UNDERLYING) {
+            next = Context::UNDERLYING;
+        } else if (ctx == Context::ROOT && key_ == Key::CHAINS) {
+            next = Context::CHAINS;
+        } else if (ctx == Context::CHAINS && key_ == Key::CHAINS) {
+            next = Context::CHAIN_SYMBOL;
+        } else if (ctx == Context::EXPIRY_ROWS) {
+            begin_row();
+            next = Context::ROW;
+        } else if (ctx == Context::ROW && key_ == Key::GREEKS) {
+            next = Context::GREEKS;
+        }
+        return push(next);
     }
 
-    std::vector<std::string> iv_keys = {
-        "mid_iv", "bid_iv", "ask_iv", "smv_vol", 
-        "implied_volatility", "volatility"
-    };
+    bool end_object() {
+        if (skip_depth_ > 0) {
+            --skip_depth_;
+            return true;
+        }
+        if (context() == Context::ROW) {
+            end_row();
+        }
+        stack_.pop_back();
+        key_ = Key::OTHER;
+        return true;
+    }
+
+    bool start_array(std::size_t) {
+        if (skip_depth_ > 0) {
+            ++skip_depth_;
+            return true;
+        }
+        Context ctx = context();
+        Context next = Context::SKIP;
+        if (ctx == Context::ROOT && key_ == Key::SYMBOLS) {
+            next = Context::SYMBOLS;
+        } else if (ctx == Context::CHAIN_SYMBOL && key_ != Key::SKIPPED_EXPIRY) {
+            next = Context::EXPIRY_ROWS;
+        } else if (ctx == Context::CHAIN_SYMBOL) {
+            skipping_expiry_ = true;
+        }
+        return push(next);
+    }
+
+    bool end_array() {
+        if (skip_depth_ > 0) {
+            if (--skip_depth_ == 0) skipping_expiry_ = false;
+            return true;
+        }
+        stack_.pop_back();
+        key_ = Key::OTHER;
+        return true;
+    }
+
+    bool key(std::string& k) {
+        if (skip_depth_ > 0) return true;
+        switch (context()) {
+            case Context::ROOT:
+                key_ = k == "symbols" ? Key::SYMBOLS
+                     : k == "underlying" ? Key::UNDERLYING
+                     : k == "chains" ? Key::CHAINS
+                     : k == "timestamp" ? Key::TIMESTAMP
+                     : Key::OTHER;
+                break;
+            case Context::UNDERLYING:
+                key_ = quote_key(k);
+                break;
+            case Context::CHAINS:
+                // Chains of other symbols are skipped once symbols[0] is known;
+                // otherwise each gets its own row buffer until the end
+                if (symbol_seen_ && k != symbol) {
+                    key_ = Key::OTHER;
+                    break;
+                }
+                if (chains.empty() || chains.back().first != k) {
+                    chains.emplace_back(k, OptionChain());
+                    chains.back().second.symbol = k;
+                    dropped_.emplace_back();
+                }
+                current_chain_ = &chains.back().second;
+                last_expiry_id_.reset();
+                key_ = Key::CHAINS;
+                break;
+            case Context::CHAIN_SYMBOL:
+                key_ = filter_ && !expiry_passes(k) ? Key::SKIPPED_EXPIRY : Key::OTHER;
+                break;
+            case Context::ROW:
+                key_ = quote_key(k);
+                if (key_ == Key::OTHER) {
+                    key_ = k == "strike" ? Key::STRIKE
+                         : k == "option_type" ? Key::OPTION_TYPE
+                         : k == "expiration_date" ? Key::EXPIRATION_DATE
+                         : k == "volume" ? Key::VOLUME
+                         : k == "open_interest" ? Key::OPEN_INTEREST
+                         : k == "greeks" ? Key::GREEKS
+                         : Key::OTHER;
+                }
+                break;
+            case Context::GREEKS:
+                key_ = greek_key(k);
+                break;
+            default:
+                key_ = Key::OTHER;
+                break;
+        }
+        return true;
+    }
 
-    for (const auto& key : iv_keys) {
-        auto it = greeks.find(key);
-        if (it != greeks.end() && it->is_number()) {
-            double val = it->get<double>();
-            if (val > 0) {
-                return val;
+    bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& ex) {
+        throw std::runtime_error("JSON parse error at byte " + std::to_string(position) + ": " + ex.what());
+    }
+
+    bool has_chain() const {
+        for (const auto& entry : chains) {
+            if (entry.first == symbol) return true;
+        }
+        return false;
+    }
+
+    // The chain named by symbols[0]; its dropped rows go to the counters
+    OptionChain take_chain() {
+        for (size_t c = 0; c < chains.size(); ++c) {
+            if (chains[c].first == symbol) {
+                if (counters_) {
+                    counters_->rows += dropped_[c].rows;
+                    for (size_t r = 0; r < size_t(OptionCriterion::COUNT); ++r) {
+                        counters_->rejected[r] += dropped_[c].rejected[r];
+                    }
+                }
+                return std::move(chains[c].second);
             }
         }
+        throw std::runtime_error("No chain found for symbol: " + symbol);
     }
-    return std::nullopt;
-}
 
-static int calculate_days_to_expiry(const std::string& expiry_str) {
-    std::tm tm = {};
-    std::istringstream ss(expiry_str);
-    ss >> std::get_time(&tm, "%Y-%m-%d");
-    
-    auto expiry_time = std::mktime(&tm);
-    auto now = std::chrono::system_clock::now();
-    auto now_time = std::chrono::system_clock::to_time_t(now);
-    
-    double diff_seconds = std::difftime(expiry_time, now_time);
-    return static_cast<int>(std::floor(diff_seconds / 86400.0));
-}
+private:
+    enum class Context { ROOT, SYMBOLS, UNDERLYING, CHAINS, CHAIN_SYMBOL, EXPIRY_ROWS, ROW, GREEKS, SKIP };
+    enum class Key {
+        OTHER, SYMBOLS, UNDERLYING, CHAINS, TIMESTAMP, SKIPPED_EXPIRY,
+        BID, ASK, LAST, STRIKE, OPTION_TYPE, EXPIRATION_DATE, VOLUME, OPEN_INTEREST, GREEKS,
+        DELTA, GAMMA, THETA, VEGA, RHO,
+        IV_0, IV_1, IV_2, IV_3, IV_4, IV_5
+    };
+
+    // Priority order used to pick implied volatility from the greeks object
+    static constexpr std::array<const char*, 6> IV_KEYS = {
+        "mid_iv", "bid_iv", "ask_iv", "smv_vol", "implied_volatility", "volatility"
+    };
+
+    std::vector<Context> stack_;
+    int skip_depth_ = 0;
+    Key key_ = Key::OTHER;
+    bool symbol_seen_ = false;
+    OptionChain* current_chain_ = nullptr;
+    std::optional<uint16_t> last_expiry_id_;
+
+    const ConfigFilter* filter_;
+    OptionCounters* counters_;
+    std::optional<CompiledOptionFilter> quote_filter_;
+    bool skipping_expiry_ = false;
+    std::vector<OptionCounters> dropped_;  // per chain, until symbols[0] is known
+    std::string checked_expiry_;  // last expiry checked against filter_
+    bool checked_expiry_ok_ = false;
+
+    double underlying_bid_ = std::numeric_limits<double>::quiet_NaN();
+    double underlying_ask_ = std::numeric_limits<double>::quiet_NaN();
+    double underlying_last_ = std::numeric_limits<double>::quiet_NaN();
 
-std::tuple<std::vector<Option>, std::optional<double>> load_option_snapshot(const std::string& path) {
-    std::ifstream file(path);
-    if (!file.is_open()) {
-        throw std::runtime_error("Cannot open file: " + path);
+    // Current row; NaN marks a missing bid/ask/last
+    struct Row {
+        std::string expiry;
+        bool has_expiry = false;
+        bool has_strike = false;
+        bool is_call = false;
+        double strike = 0.0;
+        double bid = 0.0;
+        double ask = 0.0;
+        double last = 0.0;
+        double volume = 0.0;
+        double oi = 0.0;
+        double delta = 0.0;
+        double gamma = 0.0;
+        double theta = 0.0;
+        double vega = 0.0;
+        double rho = 0.0;
+        std::array<double, IV_KEYS.size()> iv{};
+    };
+    Row row_;
+
+    Context context() const { return stack_.empty() ? Context::SKIP : stack_.back(); }
+
+    bool push(Context ctx) {
+        if (ctx == Context::SKIP) {
+            skip_depth_ = 1;
+        } else {
+            stack_.push_back(ctx);
+        }
+        key_ = Key::OTHER;
+        return true;
     }
 
-    json data;
-    file >> data;
+    static Key quote_key(const std::string& k) {
+        return k == "bid" ? Key::BID : k == "ask" ? Key::ASK : k == "last" ? Key::LAST : Key::OTHER;
+    }
 
-    std::string symbol = data["symbols"][0].get<std::string>();
-    auto chains = data["chains"][symbol];
-    auto underlying = data.value("underlying", json::object());
+    static Key greek_key(const std::string& k) {
+        if (k == "delta") return Key::DELTA;
+        if (k == "gamma") return Key::GAMMA;
+        if (k == "theta") return Key::THETA;
+        if (k == "vega") return Key::VEGA;
+        if (k == "rho") return Key::RHO;
+        for (size_t i = 0; i < IV_KEYS.size(); ++i) {
+            if (k == IV_KEYS[i]) return static_cast<Key>(static_cast<int>(Key::IV_0) + i);
+        }
+        return Key::OTHER;
+    }
 
-    // Get spot price
-    std::optional<double> spot;
-    auto bid = underlying.find("bid");
-    auto ask = underlying.find("ask");
-    auto last = underlying.find("last");
-
-    if (bid != underlying.end() && ask != underlying.end() &&
-        bid->is_number() && ask->is_number()) {
-        spot = (bid->get<double>() + ask->get<double>()) / 2.0;
-    } else if (last != underlying.end() && last->is_number()) {
-        spot = last->get<double>();
-    }
-
-    // Convert chain rows into Option objects
-    std::vector<Option> options;
-    for (auto& [expiry_key, rows] : chains.items()) {
-        for (auto& opt_data : rows) {
-            std::string side = opt_data["option_type"].get<std::string>();
-            std::transform(side.begin(), side.end(), side.begin(), ::toupper);
-            side = (side == "CALL") ? "CALL" : "PUT";
-
-            auto greeks = opt_data.value("greeks", json::object());
-            std::string expiry_str = opt_data["expiration_date"].get<std::string>();
-            int days_to_expiry = calculate_days_to_expiry(expiry_str);
-
-            std::optional<double> bid_val, ask_val;
-            if (opt_data.contains("bid") && opt_data["bid"].is_number()) {
-                bid_val = opt_data["bid"].get<double>();
+    bool value(double v, bool is_number) {
+        if (skip_depth_ > 0) return true;
+        // Non-numeric values count as missing, like the Python loader's `or 0`
+        switch (context()) {
+            case Context::ROOT:
+                if (is_number && key_ == Key::TIMESTAMP) timestamp = v;
+                break;
+            case Context::UNDERLYING:
+                if (!is_number) break;
+                if (key_ == Key::BID) underlying_bid_ = v;
+                if (key_ == Key::ASK) underlying_ask_ = v;
+                if (key_ == Key::LAST) underlying_last_ = v;
+                update_spot();
+                break;
+            case Context::ROW:
+                if (!is_number) break;
+                switch (key_) {
+                    case Key::STRIKE: row_.strike = v; row_.has_strike = true; break;
+                    case Key::BID: row_.bid = v; break;
+                    case Key::ASK: row_.ask = v; break;
+                    case Key::LAST: row_.last = v; break;
+                    case Key::VOLUME: row_.volume = v; break;
+                    case Key::OPEN_INTEREST: row_.oi = v; break;
+                    default: break;
+                }
+                break;
+            case Context::GREEKS:
+                if (!is_number) break;
+                switch (key_) {
+                    case Key::DELTA: row_.delta = v; break;
+                    case Key::GAMMA: row_.gamma = v; break;
+                    case Key::THETA: row_.theta = v; break;
+                    case Key::VEGA: row_.vega = v; break;
+                    case Key::RHO: row_.rho = v; break;
+                    default:
+                        if (key_ >= Key::IV_0) {
+                            row_.iv[static_cast<int>(key_) - static_cast<int>(Key::IV_0)] = v;
+                        }
+                        break;
+                }
+                break;
+            default:
+                break;
+        }
+        key_ = Key::OTHER;
+        return true;
+    }
+
+    // Expiry-level criteria of filter_, evaluated once per run of rows of
+    // the same expiry
+    bool expiry_passes(const std::string& expiry) {
+        if (expiry != checked_expiry_ || checked_expiry_.empty()) {
+            checked_expiry_ = expiry;
+            checked_expiry_ok_ =
+                CompiledOptionFilter::expiry_passes(*filter_, expiry, calculate_days_to_expiry(expiry));
+        }
+        return checked_expiry_ok_;
+    }
+
+    void drop(OptionCriterion criterion) {
+        if (!counters_) return;
+        ++dropped_.back().rows;
+        ++dropped_.back().rejected[size_t(criterion)];
+    }
+
+    void update_spot() {
+        if (!std::isnan(underlying_bid_) && !std::isnan(underlying_ask_)) {
+            spot = (underlying_bid_ + underlying_ask_) / 2.0;
+        } else if (!std::isnan(underlying_last_)) {
+            spot = underlying_last_;
+        } else {
+            spot.reset();
+        }
+    }
+
+    void begin_row() {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        row_.has_expiry = false;
+        row_.has_strike = false;
+        row_.is_call = false;
+        row_.strike = 0.0;
+        row_.bid = nan;
+        row_.ask = nan;
+        row_.last = nan;
+        row_.volume = 0.0;
+        row_.oi = 0.0;
+        row_.delta = 0.0;
+        row_.gamma = 0.0;
+        row_.theta = 0.0;
+        row_.vega = 0.0;
+        row_.rho = 0.0;
+        row_.iv.fill(0.0);
+    }
+
+    void end_row() {
+        if (!row_.has_strike || !row_.has_expiry) {
+            throw std::runtime_error("Option row without strike or expiration_date");
+        }
+        OptionChain& chain = *current_chain_;
+
+        double mid = 0.0;
+        if (!std::isnan(row_.bid) && !std::isnan(row_.ask)) {
+            mid = (row_.bid + row_.ask) / 2.0;
+        } else if (!std::isnan(row_.last)) {
+            mid = row_.last;
+        }
+
+        if (filter_) {
+            const OptionCriterion outcome = !expiry_passes(row_.expiry)
+                ? OptionCriterion::EXPIRY
+                : quote_filter_->quote_rejection(row_.volume, row_.oi, mid, row_.bid, row_.ask);
+            if (outcome != OptionCriterion::NONE) {
+                drop(outcome);
+                return;
             }
-            if (opt_data.contains("ask") && opt_data["ask"].is_number()) {
-                ask_val = opt_data["ask"].get<double>();
+        }
+
+        double iv = 0.0;
+        for (double candidate : row_.iv) {
+            if (candidate > 0) {
+                iv = candidate;
+                break;
             }
+        }
 
-            Option opt;
-            opt.symbol = symbol;
-            opt.expiry = expiry_str;
-            opt.strike = opt_data["strike"].get<double>();
-            opt.side = side;
-            opt.mid = mid_price(opt_data);
-            opt.iv = extract_iv(greeks).value_or(0.0);
-            opt.volume = opt_data.value("volume", 0.0);
-            opt.oi = opt_data.value("open_interest", 0.0);
-            opt.bid = bid_val;
-            opt.ask = ask_val;
-            opt.delta = greeks.value("delta", 0.0);
-            opt.gamma = greeks.value("gamma", 0.0);
-            opt.theta = greeks.value("theta", 0.0);
-            opt.vega = greeks.value("vega", 0.0);
-            opt.rho = greeks.value("rho", 0.0);
-            opt.days_to_expiry = days_to_expiry;
-
-            options.push_back(opt);
-        }
-    }
-
-    return {options, spot};
+        // days_to_expiry is computed only when a new expiry is interned
+        if (!last_expiry_id_.has_value() || chain.expiries[*last_expiry_id_] != row_.expiry) {
+            last_expiry_id_ = chain.find_expiry(row_.expiry);
+            if (!last_expiry_id_.has_value()) {
+                last_expiry_id_ = chain.intern_expiry(row_.expiry, calculate_days_to_expiry(row_.expiry));
+            }
+        }
+
+        chain.strike.push_back(row_.strike);
+        chain.mid.push_back(mid);
+        chain.iv.push_back(iv);
+        chain.volume.push_back(row_.volume);
+        chain.oi.push_back(row_.oi);
+        chain.bid.push_back(row_.bid);
+        chain.ask.push_back(row_.ask);
+        chain.delta.push_back(row_.delta);
+        chain.gamma.push_back(row_.gamma);
+        chain.theta.push_back(row_.theta);
+        chain.vega.push_back(row_.vega);
+        chain.rho.push_back(row_.rho);
+        chain.expiry_id.push_back(*last_expiry_id_);
+        chain.side.push_back(row_.is_call ? Side::CALL : Side::PUT);
+    }
+};
+
+TradierSnapshot read_option_snapshot(const std::string& path) {
+    MappedFile file(path);
+
+    TradierSaxHandler handler;
+    json::sax_parse(file.data(), file.data() + file.size(), &handler);
+
+    return {handler.take_chain(), handler.spot, handler.timestamp};
 }
 
+std::tuple<OptionChain, std::optional<double>> load_option_snapshot(const std::string& path,
+                                                                    const ConfigFilter& filter,
+                                                                    OptionCounters* counters) {
+    MappedFile file(path);
+
+    TradierSaxHandler handler(&filter, counters);
+    json::sax_parse(file.data(), file.data() + file.size(), &handler);
+
+    return {handler.take_chain(), handler.spot};
+}
+
+std::tuple<OptionChain, std::optional<double>> load_option_snapshot(const std::string& path) {
+    TradierSnapshot snapshot = read_option_snapshot(path);
+    return {std::move(snapshot.chain), snapshot.spot};
+}
+
+std::tuple<OptionChain, std::optional<double>> parse_option_snapshot(std::string_view text) {
+    TradierSaxHandler handler;
+    json::sax_parse(text.data(), text.data() + text.size(), &handler);
+
+    if (!handler.has_chain()) {
+        OptionChain chain;
+        chain.symbol = handler.symbol;
+        return {std::move(chain), handler.spot};
+    }
+    return {handler.take_chain(), handler.spot};
+}
+
+std::tuple<OptionChain, std::optional<double>> load_snapshot(const std::string& path) {
+    if (std::filesystem::path(path).extension() == SNAPSHOT_EXTENSION) {
+        return load_binary_snapshot(path);
+    }
+    return load_option_snapshot(path);
+}
+
+std::tuple<OptionChain, std::optional<double>> load_snapshot(const std::string& path, const ConfigFilter& filter,
+                                                             OptionCounters* counters) {
+    if (std::filesystem::path(path).extension() == SNAPSHOT_EXTENSION) {
+        return load_binary_snapshot(path, filter, counters);
+    }
+    return load_option_snapshot(path, filter, counters);
+}
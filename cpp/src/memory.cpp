@@ -0,0 +1,175 @@
+#include "memory.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+std::atomic<bool> installed{false};
+std::atomic<uint64_t> allocations{0};
+std::atomic<uint64_t> bytes{0};
+std::atomic<int64_t> live{0};
+std::atomic<int64_t> peak{0};
+std::atomic<uint64_t> limit{0};
+std::atomic<const char*> stage{nullptr};
+
+thread_local memory::detail::Tally thread_tally_;
+
+void raise_to(std::atomic<int64_t>& value, int64_t candidate) {
+    int64_t current = value.load(std::memory_order_relaxed);
+    while (candidate > current && !value.compare_exchange_weak(current, candidate, std::memory_order_relaxed)) {
+    }
+}
+
+constexpr double MIB = 1024.0 * 1024.0;
+
+}  // namespace
+
+MemoryBudgetExceeded::MemoryBudgetExceeded(uint64_t budget, int64_t live_bytes, size_t requested,
+                                           const char* stage_name) {
+    std::snprintf(message_, sizeof(message_),
+                  "memory budget of %.1f MiB exceeded%s%s%s: %.1f MiB live, %zu more bytes requested",
+                  double(budget) / MIB, stage_name ? " in stage '" : "", stage_name ? stage_name : "",
+                  stage_name ? "'" : "", double(live_bytes) / MIB, requested);
+}
+
+namespace memory {
+
+namespace detail {
+
+std::atomic<bool> counting{false};
+
+bool on_alloc(size_t size) {
+    const int64_t now = live.fetch_add(int64_t(size), std::memory_order_relaxed) + int64_t(size);
+    const uint64_t budget = limit.load(std::memory_order_relaxed);
+    if (budget != 0 && now > int64_t(budget)) {
+        live.fetch_sub(int64_t(size), std::memory_order_relaxed);
+        return false;
+    }
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(size, std::memory_order_relaxed);
+    raise_to(peak, now);
+
+    Tally& t = thread_tally_;
+    t.allocations += 1;
+    t.bytes += size;
+    t.live += int64_t(size);
+    t.peak = std::max(t.peak, t.live);
+    return true;
+}
+
+void on_free(size_t size) {
+    live.fetch_sub(int64_t(size), std::memory_order_relaxed);
+    thread_tally_.live -= int64_t(size);
+}
+
+void budget_exceeded(size_t requested) {
+    throw MemoryBudgetExceeded(limit.load(std::memory_order_relaxed), live.load(std::memory_order_relaxed),
+                               requested, stage.load(std::memory_order_relaxed));
+}
+
+void install() {
+    installed.store(true, std::memory_order_relaxed);
+}
+
+Tally process_tally() {
+    Tally t;
+    t.allocations = allocations.load(std::memory_order_relaxed);
+    t.bytes = bytes.load(std::memory_order_relaxed);
+    t.live = live.load(std::memory_order_relaxed);
+    t.peak = peak.load(std::memory_order_relaxed);
+    return t;
+}
+
+Tally& thread_tally() {
+    return thread_tally_;
+}
+
+}  // namespace detail
+
+bool available() {
+    return installed.load(std::memory_order_relaxed);
+}
+
+void enable() {
+    if (!available()) {
+        throw std::runtime_error("memory accounting needs the counting allocator, which this program does not link");
+    }
+    detail::counting.store(true, std::memory_order_relaxed);
+}
+
+void set_budget(uint64_t budget_bytes) {
+    limit.store(budget_bytes, std::memory_order_relaxed);
+}
+
+uint64_t budget() {
+    return limit.load(std::memory_order_relaxed);
+}
+
+void check_budget() {
+    const uint64_t budget_bytes = limit.load(std::memory_order_relaxed);
+    if (enabled() && budget_bytes != 0 && live.load(std::memory_order_relaxed) > int64_t(budget_bytes)) {
+        detail::budget_exceeded(0);
+    }
+}
+
+int64_t live_bytes() {
+    return live.load(std::memory_order_relaxed);
+}
+
+int64_t peak_bytes() {
+    return peak.load(std::memory_order_relaxed);
+}
+
+uint64_t peak_rss_bytes() {
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+    return uint64_t(usage.ru_maxrss);  // bytes
+#else
+    return uint64_t(usage.ru_maxrss) * 1024;  // KiB
+#endif
+#else
+    return 0;
+#endif
+}
+
+const char* enter_stage(const char* name) {
+    return stage.exchange(name, std::memory_order_relaxed);
+}
+
+// ===================== SCOPES =====================
+
+Scope::Scope() : start_(detail::process_tally()) {
+    outer_peak_ = peak.exchange(start_.live, std::memory_order_relaxed);
+}
+
+Scope::~Scope() {
+    raise_to(peak, outer_peak_);
+}
+
+MemoryCounters Scope::counters() const {
+    const detail::Tally now = detail::process_tally();
+    return {now.allocations - start_.allocations, now.bytes - start_.bytes, uint64_t(std::max<int64_t>(now.peak, 0))};
+}
+
+ThreadScope::ThreadScope() : start_(thread_tally_), outer_peak_(thread_tally_.peak) {
+    thread_tally_.peak = thread_tally_.live;
+}
+
+ThreadScope::~ThreadScope() {
+    thread_tally_.peak = std::max(thread_tally_.peak, outer_peak_);
+}
+
+MemoryCounters ThreadScope::counters() const {
+    const detail::Tally& now = thread_tally_;
+    return {now.allocations - start_.allocations, now.bytes - start_.bytes,
+            uint64_t(std::max<int64_t>(now.peak - start_.live, 0))};
+}
+
+}  // namespace memory
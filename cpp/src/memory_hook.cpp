@@ -0,0 +1,87 @@
+// Counting global allocator for memory accounting (see memory.hpp). Linked
+// into executables, not the library, so embedding programs and the Python
+// module keep their own allocator.
+#include "memory.hpp"
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__) || defined(__APPLE__)
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#define USABLE_SIZE(p) malloc_size(p)
+#else
+#include <malloc.h>
+#define USABLE_SIZE(p) malloc_usable_size(p)
+#endif
+
+namespace {
+
+const bool installed = (memory::detail::install(), true);
+
+// Retries through the new handler like the default operator new
+void* allocate(size_t size, size_t alignment) {
+    if (size == 0) size = 1;
+    for (;;) {
+        void* p = nullptr;
+        if (alignment <= alignof(std::max_align_t)) {
+            p = std::malloc(size);
+        } else if (posix_memalign(&p, alignment, size) != 0) {
+            p = nullptr;
+        }
+        if (p) {
+            if (memory::enabled() && !memory::detail::on_alloc(USABLE_SIZE(p))) {
+                std::free(p);
+                memory::detail::budget_exceeded(size);
+            }
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* allocate_nothrow(size_t size, size_t alignment) noexcept {
+    try {
+        return allocate(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void release(void* p) noexcept {
+    if (!p) return;
+    if (memory::enabled()) memory::detail::on_free(USABLE_SIZE(p));
+    std::free(p);
+}
+
+}  // namespace
+
+void* operator new(size_t size) { return allocate(size, 0); }
+void* operator new[](size_t size) { return allocate(size, 0); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate_nothrow(size, 0); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate_nothrow(size, 0); }
+void* operator new(size_t size, std::align_val_t al) { return allocate(size, size_t(al)); }
+void* operator new[](size_t size, std::align_val_t al) { return allocate(size, size_t(al)); }
+void* operator new(size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return allocate_nothrow(size, size_t(al));
+}
+void* operator new[](size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return allocate_nothrow(size, size_t(al));
+}
+
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, size_t) noexcept { release(p); }
+void operator delete[](void* p, size_t) noexcept { release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete(void* p, std::align_val_t) noexcept { release(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { release(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { release(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { release(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { release(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { release(p); }
+
+#endif
@@ -0,0 +1,254 @@
+#include "resident.hpp"
+#include "factory/pricing.hpp"
+#include "factory/strategy_level_filter.hpp"
+#include <cmath>
+#include <json.hpp>
+#include <limits>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+static std::optional<double> optional_number(const json& update, const char* key) {
+    auto it = update.find(key);
+    if (it == update.end() || it->is_null()) return std::nullopt;
+    return it->get<double>();
+}
+
+static QuoteUpdate parse_quote_update(const json& update) {
+    if (!update.is_object()) {
+        throw std::runtime_error("Quote update must be an object");
+    }
+    if (!update.contains("expiry") || !update.contains("strike") || !update.contains("side")) {
+        throw std::runtime_error("Quote update needs \"expiry\", \"strike\" and \"side\"");
+    }
+
+    QuoteUpdate q;
+    q.expiry = update["expiry"].get<std::string>();
+    q.strike = update["strike"].get<double>();
+
+    std::string side = update["side"].get<std::string>();
+    if (side == "call" || side == "CALL") {
+        q.side = Side::CALL;
+    } else if (side == "put" || side == "PUT") {
+        q.side = Side::PUT;
+    } else {
+        throw std::runtime_error("Invalid quote update side: " + side);
+    }
+
+    q.bid = optional_number(update, "bid");
+    q.ask = optional_number(update, "ask");
+    q.last = optional_number(update, "last");
+    q.volume = optional_number(update, "volume");
+    q.oi = optional_number(update, "oi");
+    q.iv = optional_number(update, "iv");
+    q.delta = optional_number(update, "delta");
+    q.gamma = optional_number(update, "gamma");
+    q.theta = optional_number(update, "theta");
+    q.vega = optional_number(update, "vega");
+    q.rho = optional_number(update, "rho");
+    return q;
+}
+
+std::vector<QuoteUpdate> parse_quote_updates(const std::string& line) {
+    json parsed = json::parse(line);
+
+    std::vector<QuoteUpdate> updates;
+    if (parsed.is_array()) {
+        for (const json& update : parsed) {
+            updates.push_back(parse_quote_update(update));
+        }
+    } else {
+        updates.push_back(parse_quote_update(parsed));
+    }
+    return updates;
+}
+
+// Only the criteria that do not depend on quotes, so the candidate set
+// covers every strategy a later quote could let through; short_delta_range
+// is checked per candidate instead
+static ConfigFilter structural_filter(const ConfigFilter& cfg) {
+    ConfigFilter structural;
+    structural.expiry = cfg.expiry;
+    structural.days_to_expiry_range = cfg.days_to_expiry_range;
+    structural.max_wing_width = cfg.max_wing_width;
+    structural.direction = cfg.direction;
+    return structural;
+}
+
+ResidentScreener::ResidentScreener(OptionChain chain, double spot, const ScreenerConfig& config)
+    : chain_(std::move(chain)), spot_(spot), config_(config),
+      option_filter_(config.config_filter, chain_),
+      order_(config.rank_key) {
+    const size_t rows = chain_.size();
+    if (rows > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("Chain too large for a resident screen");
+    }
+
+    modeled_.assign(rows, 0);
+    if (config_.pricing.has_value()) {
+        const std::vector<uint32_t> priced = pricing_rows(chain_, config_.pricing->mode);
+        price_rows(chain_, spot_, *config_.pricing, priced);
+        for (uint32_t i : priced) modeled_[i] = 1;
+    }
+
+    row_ok_.resize(rows);
+    option_filter_.evaluate(chain_, row_ok_.data());
+
+    for (uint32_t i = 0; i < rows; ++i) {
+        auto [it, inserted] = contracts_.emplace(std::make_tuple(chain_.expiry_id[i], chain_.side[i], chain_.strike[i]), i);
+        if (!inserted && it->second != AMBIGUOUS) {
+            it->second = AMBIGUOUS;
+            ++ambiguous_contracts_;
+        }
+    }
+
+    // Serial generation order, which is also the tie order of StrategyFactory::top
+    StrategyFactory factory(chain_, spot_);
+    factory.generate(config_.strategy_filter, structural_filter(config_.config_filter),
+        [&](const StrategyRecord& s) {
+            if (candidates_.size() == std::numeric_limits<uint32_t>::max()) {
+                throw std::runtime_error("Too many candidate strategies for a resident screen");
+            }
+            candidates_.push_back(s);
+        });
+
+    // Leg row -> candidates, as compressed rows
+    leg_offsets_.assign(rows + 1, 0);
+    for (const StrategyRecord& s : candidates_) {
+        for (size_t l = 0; l < s.leg_count; ++l) ++leg_offsets_[s.leg[l] + 1];
+    }
+    for (size_t r = 0; r < rows; ++r) leg_offsets_[r + 1] += leg_offsets_[r];
+
+    leg_candidates_.resize(leg_offsets_[rows]);
+    std::vector<uint32_t> fill(leg_offsets_.begin(), leg_offsets_.end() - 1);
+    for (uint32_t id = 0; id < candidates_.size(); ++id) {
+        const StrategyRecord& s = candidates_[id];
+        for (size_t l = 0; l < s.leg_count; ++l) leg_candidates_[fill[s.leg[l]]++] = id;
+    }
+
+    rank_value_.resize(candidates_.size());
+    ranked_.assign(candidates_.size(), 0);
+    row_stamp_.assign(rows, 0);
+    candidate_stamp_.assign(candidates_.size(), 0);
+
+    for (uint32_t id = 0; id < candidates_.size(); ++id) {
+        if (!passes(candidates_[id])) continue;
+        rank_value_[id] = order_.value(candidates_[id]);
+        ranked_[id] = 1;
+        ranking_.insert(ranking_.end(), RankKey{rank_value_[id], id});
+    }
+}
+
+std::optional<uint32_t> ResidentScreener::find_row(const std::string& expiry, double strike, Side side) const {
+    auto expiry_id = chain_.find_expiry(expiry);
+    if (!expiry_id.has_value()) return std::nullopt;
+
+    auto it = contracts_.find(std::make_tuple(expiry_id.value(), side, strike));
+    if (it == contracts_.end() || it->second == AMBIGUOUS) return std::nullopt;
+    return it->second;
+}
+
+bool ResidentScreener::passes(const StrategyRecord& s) const {
+    for (size_t l = 0; l < s.leg_count; ++l) {
+        if (!row_ok_[s.leg[l]]) return false;
+        if (s.sign[l] < 0 && !sold_leg_passes(config_.config_filter, chain_.delta[s.leg[l]])) return false;
+    }
+    return passes_strategy_level_filters(config_.config_filter, s);
+}
+
+void ResidentScreener::rescore(uint32_t id) {
+    StrategyRecord& s = candidates_[id];
+    s = rebuild_record(chain_, s);
+
+    if (ranked_[id]) {
+        ranking_.erase(RankKey{rank_value_[id], id});
+        ranked_[id] = 0;
+    }
+    if (passes(s)) {
+        rank_value_[id] = order_.value(s);
+        ranked_[id] = 1;
+        ranking_.insert(RankKey{rank_value_[id], id});
+    }
+}
+
+RescreenStats ResidentScreener::apply(const std::vector<QuoteUpdate>& updates) {
+    if (++epoch_ == 0) {
+        std::fill(row_stamp_.begin(), row_stamp_.end(), 0);
+        std::fill(candidate_stamp_.begin(), candidate_stamp_.end(), 0);
+        epoch_ = 1;
+    }
+
+    RescreenStats stats;
+    std::vector<uint32_t> changed;
+    for (const QuoteUpdate& q : updates) {
+        auto row = find_row(q.expiry, q.strike, q.side);
+        if (!row.has_value()) {
+            auto expiry_id = chain_.find_expiry(q.expiry);
+            if (expiry_id.has_value() && contracts_.count(std::make_tuple(expiry_id.value(), q.side, q.strike))) {
+                ++stats.ambiguous;
+            } else {
+                ++stats.unknown;
+            }
+            continue;
+        }
+        const uint32_t i = row.value();
+        ++stats.quotes;
+
+        if (q.bid) chain_.bid[i] = *q.bid;
+        if (q.ask) chain_.ask[i] = *q.ask;
+        if (q.bid || q.ask || q.last) {
+            if (!std::isnan(chain_.bid[i]) && !std::isnan(chain_.ask[i])) {
+                chain_.mid[i] = (chain_.bid[i] + chain_.ask[i]) / 2.0;
+            } else if (q.last) {
+                chain_.mid[i] = *q.last;
+            }
+        }
+        if (q.volume) chain_.volume[i] = *q.volume;
+        if (q.oi) chain_.oi[i] = *q.oi;
+        if (q.iv) chain_.iv[i] = *q.iv;
+        if (q.delta) chain_.delta[i] = *q.delta;
+        if (q.gamma) chain_.gamma[i] = *q.gamma;
+        if (q.theta) chain_.theta[i] = *q.theta;
+        if (q.vega) chain_.vega[i] = *q.vega;
+        if (q.rho) chain_.rho[i] = *q.rho;
+        // A quoted IV replaces the model's unless every row is recomputed
+        if (q.iv && config_.pricing.has_value() && config_.pricing->mode == PricingMode::MISSING) modeled_[i] = 0;
+
+        if (row_stamp_[i] != epoch_) {
+            row_stamp_[i] = epoch_;
+            changed.push_back(i);
+        }
+    }
+
+    for (uint32_t i : changed) {
+        row_ok_[i] = option_filter_.passes(chain_, i);
+    }
+    if (config_.pricing.has_value()) {
+        std::vector<uint32_t> repriced;
+        for (uint32_t i : changed) {
+            if (modeled_[i]) repriced.push_back(i);
+        }
+        price_rows(chain_, spot_, *config_.pricing, repriced);
+    }
+
+    // A candidate with several changed legs is rescored once, after all of them
+    for (uint32_t i : changed) {
+        for (uint32_t k = leg_offsets_[i]; k < leg_offsets_[i + 1]; ++k) {
+            uint32_t id = leg_candidates_[k];
+            if (candidate_stamp_[id] == epoch_) continue;
+            candidate_stamp_[id] = epoch_;
+            rescore(id);
+            ++stats.rescored;
+        }
+    }
+    return stats;
+}
+
+StrategyList ResidentScreener::top() const {
+    std::vector<StrategyRecord> best;
+    for (const RankKey& key : ranking_) {
+        if (best.size() >= config_.top_n) break;
+        best.push_back(candidates_[key.id]);
+    }
+    return StrategyList(chain_, std::move(best));
+}
@@ -0,0 +1,266 @@
+#include "result_writer.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// Metric columns in output order, shared by the CSV header and every format
+struct MetricColumn {
+    const char* name;
+    double (*value)(const StrategyMetrics&);
+};
+
+constexpr MetricColumn METRIC_COLUMNS[] = {
+    {"cost", [](const StrategyMetrics& m) { return m.cost(); }},
+    {"debit", [](const StrategyMetrics& m) { return m.debit; }},
+    {"credit", [](const StrategyMetrics& m) { return m.credit; }},
+    {"max_gain", [](const StrategyMetrics& m) { return m.max_gain; }},
+    {"max_loss", [](const StrategyMetrics& m) { return m.max_loss; }},
+    {"rr", [](const StrategyMetrics& m) { return m.reward_risk; }},
+    {"net_delta", [](const StrategyMetrics& m) { return m.net_delta; }},
+    {"net_theta", [](const StrategyMetrics& m) { return m.net_theta; }},
+    {"net_vega", [](const StrategyMetrics& m) { return m.net_vega; }},
+    {"iv", [](const StrategyMetrics& m) { return m.iv; }},
+    {"liquidity", [](const StrategyMetrics& m) { return m.liquidity; }},
+};
+
+const char* side_code(Side side) {
+    return side == Side::CALL ? "C" : "P";
+}
+
+// "YYYY-MM-DD" as yyyymmdd, 0 if it is not in that form
+uint32_t expiry_number(std::string_view expiry) {
+    if (expiry.size() != 10 || expiry[4] != '-' || expiry[7] != '-') return 0;
+    uint32_t n = 0;
+    for (size_t i = 0; i < expiry.size(); ++i) {
+        if (i == 4 || i == 7) continue;
+        if (expiry[i] < '0' || expiry[i] > '9') return 0;
+        n = n * 10 + uint32_t(expiry[i] - '0');
+    }
+    return n;
+}
+
+}  // namespace
+
+ResultFormat parse_result_format(const std::string& name) {
+    if (name == "text") return ResultFormat::TEXT;
+    if (name == "csv") return ResultFormat::CSV;
+    if (name == "ndjson" || name == "jsonl") return ResultFormat::NDJSON;
+    if (name == "binary") return ResultFormat::BINARY;
+    throw std::invalid_argument("Unknown result format \"" + name + "\" (expected text, csv, ndjson or binary)");
+}
+
+ResultRow ResultRow::of(const OptionChain& chain, const StrategyRecord& s, std::string_view symbol) {
+    ResultRow row{};
+    row.symbol = symbol;
+    row.kind = s.kind;
+    row.leg_count = s.leg_count;
+    for (size_t l = 0; l < s.leg_count; ++l) {
+        const uint32_t r = s.leg[l];
+        row.legs[l] = {chain.side[r], s.sign[l], chain.strike[r], chain.expiry(r)};
+    }
+    row.metrics = &s.metrics();
+    return row;
+}
+
+ResultWriter::ResultWriter(std::FILE* out, ResultFormat format)
+    : out_(out), format_(format), buffer_(CAPACITY, '\0') {
+    if (format_ == ResultFormat::TEXT) {
+        throw std::invalid_argument("ResultWriter does not write text; use StrategyList::print");
+    }
+
+    if (format_ == ResultFormat::BINARY) {
+        ResultFileHeader header{};
+        std::memcpy(header.magic, RESULT_MAGIC, sizeof(header.magic));
+        header.version = RESULT_VERSION;
+        header.byte_order = RESULT_BYTE_ORDER;
+        header.record_size = sizeof(ResultBinaryRecord);
+        put_bytes(&header, sizeof(header));
+    } else if (format_ == ResultFormat::CSV) {
+        reserve(MAX_ROW);
+        put("symbol,kind,leg_count");
+        for (size_t l = 1; l <= MAX_LEGS; ++l) {
+            for (const char* field : {"side", "qty", "strike", "expiry"}) {
+                put(",leg");
+                put_integer(int64_t(l));
+                put('_');
+                put(field);
+            }
+        }
+        for (const MetricColumn& column : METRIC_COLUMNS) {
+            put(',');
+            put(column.name);
+        }
+        put('\n');
+    }
+}
+
+ResultWriter::~ResultWriter() {
+    try {
+        flush();
+    } catch (const std::exception&) {
+        // Callers that care about errors flush explicitly
+    }
+}
+
+void ResultWriter::write(const ResultRow& row) {
+    switch (format_) {
+        case ResultFormat::CSV: write_csv(row); break;
+        case ResultFormat::NDJSON: write_ndjson(row); break;
+        case ResultFormat::BINARY: write_binary(row); break;
+        case ResultFormat::TEXT: break;
+    }
+    ++rows_;
+}
+
+void ResultWriter::flush() {
+    drain();
+    if (std::fflush(out_) != 0) {
+        throw std::runtime_error("Cannot write results");
+    }
+}
+
+size_t ResultWriter::text_size(const ResultRow& row) {
+    size_t n = MAX_ROW + row.symbol.size();
+    for (size_t l = 0; l < row.leg_count; ++l) {
+        n += row.legs[l].expiry.size();
+    }
+    return n;
+}
+
+void ResultWriter::reserve(size_t n) {
+    if (size_ + n <= buffer_.size()) return;
+    drain();
+    if (n > buffer_.size()) buffer_.resize(n);
+}
+
+void ResultWriter::write_csv(const ResultRow& row) {
+    reserve(text_size(row));
+    put(row.symbol);
+    put(',');
+    put(strategy_kind_name(row.kind));
+    put(',');
+    put_integer(row.leg_count);
+    for (size_t l = 0; l < MAX_LEGS; ++l) {
+        if (l < row.leg_count) {
+            const ResultLeg& leg = row.legs[l];
+            put(',');
+            put(side_code(leg.side));
+            put(',');
+            put_integer(leg.qty);
+            put(',');
+            put_number(leg.strike);
+            put(',');
+            put(leg.expiry);
+        } else {
+            put(",,,,");
+        }
+    }
+    for (const MetricColumn& column : METRIC_COLUMNS) {
+        put(',');
+        put_number(column.value(*row.metrics));
+    }
+    put('\n');
+}
+
+void ResultWriter::write_ndjson(const ResultRow& row) {
+    // Symbols and expiries are plain ASCII identifiers, so strings are
+    // written as-is
+    reserve(text_size(row));
+    put("{\"symbol\":\"");
+    put(row.symbol);
+    put("\",\"kind\":\"");
+    put(strategy_kind_name(row.kind));
+    put("\",\"legs\":[");
+    for (size_t l = 0; l < row.leg_count; ++l) {
+        const ResultLeg& leg = row.legs[l];
+        put(l == 0 ? "{\"side\":\"" : ",{\"side\":\"");
+        put(side_code(leg.side));
+        put("\",\"qty\":");
+        put_integer(leg.qty);
+        put(",\"strike\":");
+        put_json_number(leg.strike);
+        put(",\"expiry\":\"");
+        put(leg.expiry);
+        put("\"}");
+    }
+    put(']');
+    for (const MetricColumn& column : METRIC_COLUMNS) {
+        put(",\"");
+        put(column.name);
+        put("\":");
+        put_json_number(column.value(*row.metrics));
+    }
+    put("}\n");
+}
+
+void ResultWriter::write_binary(const ResultRow& row) {
+    ResultBinaryRecord r{};
+    std::memcpy(r.symbol, row.symbol.data(), std::min(row.symbol.size(), sizeof(r.symbol)));
+    r.kind = static_cast<uint8_t>(row.kind);
+    r.leg_count = row.leg_count;
+    for (size_t l = 0; l < row.leg_count; ++l) {
+        const ResultLeg& leg = row.legs[l];
+        r.qty[l] = leg.qty;
+        r.side[l] = leg.side == Side::CALL ? 0 : 1;
+        r.expiry[l] = expiry_number(leg.expiry);
+        r.strike[l] = leg.strike;
+    }
+    const StrategyMetrics& m = *row.metrics;
+    r.debit = m.debit;
+    r.credit = m.credit;
+    r.max_gain = m.max_gain;
+    r.max_loss = m.max_loss;
+    r.reward_risk = m.reward_risk;
+    r.net_delta = m.net_delta;
+    r.net_theta = m.net_theta;
+    r.net_vega = m.net_vega;
+    r.iv = m.iv;
+    r.liquidity = m.liquidity;
+    put_bytes(&r, sizeof(r));
+}
+
+void ResultWriter::put(std::string_view s) {
+    std::memcpy(buffer_.data() + size_, s.data(), s.size());
+    size_ += s.size();
+}
+
+void ResultWriter::put_number(double v) {
+    if (std::isnan(v)) {
+        put("nan");
+        return;
+    }
+    auto [end, ec] = std::to_chars(buffer_.data() + size_, buffer_.data() + buffer_.size(), v);
+    size_ = size_t(end - buffer_.data());
+}
+
+void ResultWriter::put_json_number(double v) {
+    if (!std::isfinite(v)) {
+        put("null");
+        return;
+    }
+    put_number(v);
+}
+
+void ResultWriter::put_integer(int64_t v) {
+    auto [end, ec] = std::to_chars(buffer_.data() + size_, buffer_.data() + buffer_.size(), v);
+    size_ = size_t(end - buffer_.data());
+}
+
+void ResultWriter::put_bytes(const void* data, size_t n) {
+    reserve(n);
+    std::memcpy(buffer_.data() + size_, data, n);
+    size_ += n;
+}
+
+void ResultWriter::drain() {
+    if (size_ == 0) return;
+    const size_t size = size_;
+    size_ = 0;
+    if (std::fwrite(buffer_.data(), 1, size, out_) != size) {
+        throw std::runtime_error("Cannot write results");
+    }
+}
@@ -0,0 +1,365 @@
+#include "shard.hpp"
+#include "loader.hpp"
+#include "mapped_file.hpp"
+#include "stats.hpp"
+#include "factory/factory.hpp"
+#include "factory/pricing.hpp"
+#include "factory/rank_order.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Rank value, then input, then emission position within the input
+struct ShardBefore {
+    const RankOrder& order;
+
+    bool operator()(const ShardStrategy& a, const ShardStrategy& b) const {
+        const RankValue va = order.value(a.strategy.record);
+        const RankValue vb = order.value(b.strategy.record);
+        if (RankOrder::before(va, vb)) return true;
+        if (RankOrder::before(vb, va)) return false;
+        if (a.strategy.input != b.strategy.input) return a.strategy.input < b.strategy.input;
+        if (a.task != b.task) return a.task < b.task;
+        return a.seq < b.seq;
+    }
+};
+
+// String section of a shard file; equal strings are stored once
+class StringTable {
+public:
+    ShardString add(const std::string& s) {
+        auto [it, inserted] = offsets_.try_emplace(s, ShardString{});
+        if (inserted) {
+            if (bytes_.size() + s.size() > UINT32_MAX) {
+                throw std::runtime_error("Shard strings exceed 4 GiB");
+            }
+            it->second = {uint32_t(bytes_.size()), uint32_t(s.size())};
+            bytes_ += s;
+        }
+        return it->second;
+    }
+
+    const std::string& bytes() const { return bytes_; }
+
+private:
+    std::map<std::string, ShardString> offsets_;
+    std::string bytes_;
+};
+
+[[noreturn]] void corrupt(const std::string& path) {
+    throw std::runtime_error("Corrupt shard file: " + path);
+}
+
+}  // namespace
+
+// ===================== SHARD SPEC =====================
+
+ShardSpec ShardSpec::parse(const std::string& text) {
+    const size_t slash = text.find('/');
+    try {
+        if (slash != std::string::npos) {
+            size_t used = 0;
+            const unsigned long index = std::stoul(text.substr(0, slash), &used);
+            if (used == slash) {
+                const std::string count_text = text.substr(slash + 1);
+                const unsigned long count = std::stoul(count_text, &used);
+                if (used == count_text.size() && count > 0 && count <= UINT32_MAX && index < count) {
+                    return {uint32_t(index), uint32_t(count)};
+                }
+            }
+        }
+    } catch (const std::logic_error&) {
+    }
+    throw std::runtime_error("Invalid shard \"" + text + "\": expected i/N with 0 <= i < N");
+}
+
+// ===================== SHARD SCREEN =====================
+
+uint64_t config_fingerprint(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open config file: " + path);
+    }
+    uint64_t hash = 0xcbf29ce484222325ull;
+    char c;
+    while (file.get(c)) {
+        hash = (hash ^ uint8_t(c)) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+ShardPartial run_shard(const ScreenerConfig& config, const std::vector<std::string>& inputs, ShardSpec spec,
+                       uint64_t config_hash) {
+    if (!config.pareto.empty()) {
+        throw std::runtime_error("\"ranking.pareto\" fronts cannot be merged across shards");
+    }
+
+    ShardPartial partial;
+    partial.spec = spec;
+    partial.config_hash = config_hash;
+
+    ScreenStats stats;
+    stats.threads = config.threads;
+    const RankOrder order(config.rank_key);
+    const ShardBefore before{order};
+
+    uint64_t unit = 0;  // units of the inputs before this one
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        ShardPartial::Input& input = partial.inputs.emplace_back();
+        input.path = inputs[i];
+
+        std::vector<ShardStrategy> screened;
+        try {
+            auto load_start = std::chrono::steady_clock::now();
+            auto [chain, spot] = load_snapshot(inputs[i], config.config_filter, &stats.options());
+            stats.add_stage("load", std::chrono::duration<double>(std::chrono::steady_clock::now() - load_start).count());
+            if (!spot.has_value()) {
+                throw std::runtime_error("Could not determine spot price");
+            }
+            if (config.pricing.has_value()) {
+                StageTimer timer(&stats, "pricing");
+                price_chain(chain, spot.value(), *config.pricing, &stats.pricing());
+            }
+
+            StrategyFactory factory(chain, spot.value(), config.threads);
+            auto mine = [&](size_t task) { return (unit + task) % spec.count == spec.index; };
+            size_t tasks = 0;
+            auto top = factory.top_of_tasks(config.strategy_filter, config.config_filter, config.rank_key,
+                                            config.top_n, partial.parts, mine, tasks, true, &stats);
+            input.tasks = uint32_t(tasks);
+            for (size_t t = 0; t < tasks; ++t) {
+                if (mine(t)) ++partial.units;
+            }
+            unit += tasks;
+
+            std::string symbol = chain.symbol.empty() ? fs::path(inputs[i]).stem().string() : chain.symbol;
+            for (const TopStrategies::Ranked& r : top) {
+                const StrategyRecord& s = r.strategy;
+                ShardStrategy& out = screened.emplace_back(ShardStrategy{r.task, r.seq, {i, symbol, s.pretty(chain), s, {}}});
+                for (size_t l = 0; l < s.leg_count; ++l) {
+                    out.strategy.legs[l] = {chain.side[s.leg[l]], chain.strike[s.leg[l]], chain.expiry(s.leg[l])};
+                }
+            }
+        } catch (const std::exception& e) {
+            input.error = e.what();
+            continue;
+        }
+
+        // Later inputs rank after earlier ones on ties, so one merge keeps the
+        // combined top_n
+        std::vector<ShardStrategy> merged;
+        merged.reserve(partial.strategies.size() + screened.size());
+        std::merge(std::make_move_iterator(partial.strategies.begin()), std::make_move_iterator(partial.strategies.end()),
+                   std::make_move_iterator(screened.begin()), std::make_move_iterator(screened.end()),
+                   std::back_inserter(merged), before);
+        if (merged.size() > config.top_n) {
+            merged.resize(config.top_n);
+        }
+        partial.strategies = std::move(merged);
+    }
+
+    partial.stats_json = stats.to_json();
+    return partial;
+}
+
+// ===================== SHARD FILE =====================
+
+void write_shard(const ShardPartial& partial, const std::string& path) {
+    StringTable strings;
+
+    ShardFileHeader header{};
+    std::memcpy(header.magic, SHARD_MAGIC, sizeof(header.magic));
+    header.version = SHARD_VERSION;
+    header.byte_order = SHARD_BYTE_ORDER;
+    header.shard_index = partial.spec.index;
+    header.shard_count = partial.spec.count;
+    header.parts = partial.parts;
+    header.input_count = uint32_t(partial.inputs.size());
+    header.config_hash = partial.config_hash;
+    header.units = partial.units;
+    header.record_count = partial.strategies.size();
+    header.stats_json = strings.add(partial.stats_json);
+
+    std::vector<ShardFileInput> inputs;
+    inputs.reserve(partial.inputs.size());
+    for (const ShardPartial::Input& input : partial.inputs) {
+        inputs.push_back({strings.add(input.path), strings.add(input.error), input.tasks, input.error.empty() ? 1u : 0u});
+    }
+
+    std::vector<ShardFileRecord> records;
+    records.reserve(partial.strategies.size());
+    for (const ShardStrategy& s : partial.strategies) {
+        const ScreenedStrategy& screened = s.strategy;
+        ShardFileRecord& r = records.emplace_back(ShardFileRecord{});
+        r.task = s.task;
+        r.seq = s.seq;
+        r.metrics = screened.record.metrics();
+        r.input = uint32_t(screened.input);
+        r.kind = uint8_t(screened.record.kind);
+        r.leg_count = screened.record.leg_count;
+        r.symbol = strings.add(screened.symbol);
+        r.name = strings.add(screened.name);
+        for (size_t l = 0; l < screened.record.leg_count; ++l) {
+            r.sign[l] = screened.record.sign[l];
+            r.side[l] = uint8_t(screened.legs[l].side);
+            r.strike[l] = screened.legs[l].strike;
+            r.expiry[l] = strings.add(screened.legs[l].expiry);
+        }
+    }
+    header.string_bytes = strings.bytes().size();
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        throw std::runtime_error("Cannot create shard file: " + path);
+    }
+    const bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                    std::fwrite(inputs.data(), sizeof(ShardFileInput), inputs.size(), file) == inputs.size() &&
+                    std::fwrite(records.data(), sizeof(ShardFileRecord), records.size(), file) == records.size() &&
+                    std::fwrite(strings.bytes().data(), 1, strings.bytes().size(), file) == strings.bytes().size();
+    if (std::fclose(file) != 0 || !ok) {
+        throw std::runtime_error("Failed to write shard file: " + path);
+    }
+}
+
+ShardPartial read_shard(const std::string& path) {
+    MappedFile file(path);
+    ShardFileHeader header;
+    if (file.size() < sizeof(header)) corrupt(path);
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, SHARD_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Not a shard file: " + path);
+    }
+    if (header.version != SHARD_VERSION || header.byte_order != SHARD_BYTE_ORDER) {
+        throw std::runtime_error("Unsupported shard version or byte order: " + path);
+    }
+
+    // Sizes are checked one at a time, so no product can overflow
+    const size_t left = file.size() - sizeof(header);
+    if (header.input_count > left / sizeof(ShardFileInput)) corrupt(path);
+    const size_t input_bytes = header.input_count * sizeof(ShardFileInput);
+    if (header.record_count > (left - input_bytes) / sizeof(ShardFileRecord)) corrupt(path);
+    const size_t record_bytes = header.record_count * sizeof(ShardFileRecord);
+    if (header.string_bytes != left - input_bytes - record_bytes) corrupt(path);
+
+    const char* input_data = file.data() + sizeof(header);
+    const char* record_data = input_data + input_bytes;
+    const char* string_data = record_data + record_bytes;
+    auto text = [&](ShardString s) {
+        if (s.offset > header.string_bytes || s.size > header.string_bytes - s.offset) corrupt(path);
+        return std::string(string_data + s.offset, s.size);
+    };
+
+    ShardPartial partial;
+    partial.spec = {header.shard_index, header.shard_count};
+    if (partial.spec.count == 0 || partial.spec.index >= partial.spec.count) corrupt(path);
+    partial.parts = header.parts;
+    partial.config_hash = header.config_hash;
+    partial.units = header.units;
+    partial.stats_json = text(header.stats_json);
+
+    partial.inputs.reserve(header.input_count);
+    for (size_t i = 0; i < header.input_count; ++i) {
+        ShardFileInput in;
+        std::memcpy(&in, input_data + i * sizeof(in), sizeof(in));
+        partial.inputs.push_back({text(in.path), in.loaded ? std::string() : text(in.error), in.tasks});
+    }
+
+    partial.strategies.reserve(header.record_count);
+    for (size_t i = 0; i < header.record_count; ++i) {
+        ShardFileRecord r;
+        std::memcpy(&r, record_data + i * sizeof(r), sizeof(r));
+        if (r.input >= header.input_count || r.kind > uint8_t(StrategyKind::DIAGONAL) || r.leg_count == 0 ||
+            r.leg_count > MAX_LEGS) {
+            corrupt(path);
+        }
+
+        ShardStrategy& out = partial.strategies.emplace_back();
+        out.task = r.task;
+        out.seq = r.seq;
+        ScreenedStrategy& s = out.strategy;
+        s.input = r.input;
+        s.symbol = text(r.symbol);
+        s.name = text(r.name);
+        s.record = StrategyRecord{};
+        static_cast<StrategyMetrics&>(s.record) = r.metrics;
+        s.record.kind = StrategyKind(r.kind);
+        s.record.leg_count = r.leg_count;
+        for (size_t l = 0; l < r.leg_count; ++l) {
+            if (r.side[l] > uint8_t(Side::PUT) || (r.sign[l] != 1 && r.sign[l] != -1)) corrupt(path);
+            s.record.sign[l] = r.sign[l];
+            s.legs[l] = {Side(r.side[l]), r.strike[l], text(r.expiry[l])};
+        }
+    }
+    return partial;
+}
+
+// ===================== SHARD MERGE =====================
+
+BatchResult merge_shards(const ScreenerConfig& config, const std::vector<ShardPartial>& partials) {
+    if (partials.empty()) {
+        throw std::runtime_error("No shards to merge");
+    }
+
+    // Same screen, every shard once
+    const ShardPartial& first = partials.front();
+    std::vector<bool> seen(first.spec.count, false);
+    for (const ShardPartial& p : partials) {
+        if (p.spec.count != first.spec.count || p.parts != first.parts) {
+            throw std::runtime_error("Shards come from different shard counts");
+        }
+        if (p.config_hash != first.config_hash) {
+            throw std::runtime_error("Shards were screened with different configs");
+        }
+        bool same_inputs = p.inputs.size() == first.inputs.size();
+        for (size_t i = 0; same_inputs && i < p.inputs.size(); ++i) {
+            same_inputs = p.inputs[i].path == first.inputs[i].path && p.inputs[i].tasks == first.inputs[i].tasks;
+        }
+        if (!same_inputs) {
+            throw std::runtime_error("Shards were screened over different inputs");
+        }
+        if (seen[p.spec.index]) {
+            throw std::runtime_error("Shard " + std::to_string(p.spec.index) + "/" + std::to_string(p.spec.count) +
+                                     " given twice");
+        }
+        seen[p.spec.index] = true;
+    }
+    for (uint32_t i = 0; i < first.spec.count; ++i) {
+        if (!seen[i]) {
+            throw std::runtime_error("Missing shard " + std::to_string(i) + "/" + std::to_string(first.spec.count));
+        }
+    }
+
+    // Every shard kept its own top_n, so the top_n of their union is the
+    // global top_n
+    std::vector<ShardStrategy> all;
+    for (const ShardPartial& p : partials) {
+        all.insert(all.end(), p.strategies.begin(), p.strategies.end());
+    }
+    const RankOrder order(config.rank_key);
+    const size_t n = std::min(all.size(), config.top_n);
+    std::partial_sort(all.begin(), all.begin() + n, all.end(), ShardBefore{order});
+
+    BatchResult result;
+    result.strategies.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        result.strategies.push_back(std::move(all[i].strategy));
+    }
+    for (const ShardPartial::Input& input : first.inputs) {
+        if (input.error.empty()) {
+            ++result.screened;
+        } else {
+            result.failures.push_back({input.path, input.error});
+        }
+    }
+    return result;
+}
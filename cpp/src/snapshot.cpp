@@ -0,0 +1,231 @@
+#include "snapshot.hpp"
+#include "loader.hpp"
+#include "mapped_file.hpp"
+#include "factory/option_filter.hpp"
+#include "stats.hpp"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+static uint64_t align8(uint64_t n) {
+    return (n + 7) & ~uint64_t(7);
+}
+
+static size_t column_width(uint32_t col) {
+    if (col == COL_EXPIRY_ID) return sizeof(uint16_t);
+    if (col == COL_SIDE) return sizeof(uint8_t);
+    return sizeof(double);
+}
+
+// Row columns in SnapshotColumn order; Chain is OptionChain or const OptionChain
+template <typename Chain>
+static auto* double_column(Chain& chain, uint32_t col) {
+    using Column = std::conditional_t<std::is_const_v<Chain>, const std::vector<double>, std::vector<double>>;
+    Column* column = nullptr;
+    switch (col) {
+        case COL_STRIKE: column = &chain.strike; break;
+        case COL_MID: column = &chain.mid; break;
+        case COL_IV: column = &chain.iv; break;
+        case COL_VOLUME: column = &chain.volume; break;
+        case COL_OI: column = &chain.oi; break;
+        case COL_BID: column = &chain.bid; break;
+        case COL_ASK: column = &chain.ask; break;
+        case COL_DELTA: column = &chain.delta; break;
+        case COL_GAMMA: column = &chain.gamma; break;
+        case COL_THETA: column = &chain.theta; break;
+        case COL_VEGA: column = &chain.vega; break;
+        case COL_RHO: column = &chain.rho; break;
+        default: break;
+    }
+    return column;
+}
+
+void write_binary_snapshot(const std::string& path,
+                           const OptionChain& chain,
+                           std::optional<double> spot) {
+    const size_t n = chain.size();
+
+    std::vector<uint32_t> expiry_offsets{0};
+    std::string expiry_bytes;
+    for (const auto& e : chain.expiries) {
+        expiry_bytes += e;
+        expiry_offsets.push_back(static_cast<uint32_t>(expiry_bytes.size()));
+    }
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byte_order = SNAPSHOT_BYTE_ORDER;
+    header.row_count = static_cast<uint32_t>(n);
+    header.expiry_count = static_cast<uint32_t>(chain.expiries.size());
+    header.has_spot = spot.has_value() ? 1 : 0;
+    header.symbol_size = static_cast<uint32_t>(chain.symbol.size());
+    header.spot = spot.value_or(0.0);
+
+    uint64_t offset = align8(sizeof(SnapshotHeader));
+    header.symbol_offset = offset;
+    offset = align8(offset + chain.symbol.size());
+    header.expiry_offsets_offset = offset;
+    offset = align8(offset + expiry_offsets.size() * sizeof(uint32_t));
+    header.expiry_bytes_offset = offset;
+    offset = align8(offset + expiry_bytes.size());
+    for (uint32_t col = 0; col < COL_COUNT; ++col) {
+        header.column_offset[col] = offset;
+        offset = align8(offset + n * column_width(col));
+    }
+
+    std::vector<char> buffer(offset, 0);
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    std::memcpy(buffer.data() + header.symbol_offset, chain.symbol.data(), chain.symbol.size());
+    std::memcpy(buffer.data() + header.expiry_offsets_offset, expiry_offsets.data(),
+                expiry_offsets.size() * sizeof(uint32_t));
+    std::memcpy(buffer.data() + header.expiry_bytes_offset, expiry_bytes.data(), expiry_bytes.size());
+
+    for (uint32_t col = 0; col < COL_EXPIRY_ID; ++col) {
+        std::memcpy(buffer.data() + header.column_offset[col], double_column(chain, col)->data(),
+                    n * sizeof(double));
+    }
+    std::memcpy(buffer.data() + header.column_offset[COL_EXPIRY_ID], chain.expiry_id.data(), n * sizeof(uint16_t));
+    std::memcpy(buffer.data() + header.column_offset[COL_SIDE], chain.side.data(), n * sizeof(Side));
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file for writing: " + path);
+    }
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (!file) {
+        throw std::runtime_error("Failed to write snapshot: " + path);
+    }
+}
+
+// Every row, or with a filter only the rows passing its option-level
+// criteria, gathered straight from the mapped columns
+static std::tuple<OptionChain, std::optional<double>> load_binary(const std::string& path,
+                                                                  const ConfigFilter* filter,
+                                                                  OptionCounters* counters) {
+    MappedFile file(path);
+
+    if (file.size() < sizeof(SnapshotHeader)) {
+        throw std::runtime_error("Truncated snapshot: " + path);
+    }
+    SnapshotHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Not an option snapshot: " + path);
+    }
+    if (header.version != SNAPSHOT_VERSION || header.byte_order != SNAPSHOT_BYTE_ORDER) {
+        throw std::runtime_error("Unsupported snapshot version or byte order: " + path);
+    }
+
+    const size_t n = header.row_count;
+    auto in_bounds = [&](uint64_t offset, uint64_t bytes) {
+        return offset <= file.size() && bytes <= file.size() - offset;
+    };
+    bool valid = in_bounds(header.symbol_offset, header.symbol_size) &&
+                 in_bounds(header.expiry_offsets_offset, (uint64_t(header.expiry_count) + 1) * sizeof(uint32_t));
+    for (uint32_t col = 0; valid && col < COL_COUNT; ++col) {
+        valid = in_bounds(header.column_offset[col], n * column_width(col));
+    }
+    if (!valid) {
+        throw std::runtime_error("Corrupt snapshot: " + path);
+    }
+
+    OptionChain chain;
+    chain.symbol.assign(file.data() + header.symbol_offset, header.symbol_size);
+
+    // Expiry table and per-expiry days to expiry, computed once per expiry.
+    // A filter drops failing expiries from the table, so ids are remapped.
+    constexpr uint16_t DROPPED = std::numeric_limits<uint16_t>::max();
+    std::vector<uint16_t> new_id(header.expiry_count, DROPPED);
+    std::vector<uint32_t> expiry_offsets(header.expiry_count + 1);
+    std::memcpy(expiry_offsets.data(), file.data() + header.expiry_offsets_offset,
+                expiry_offsets.size() * sizeof(uint32_t));
+    if (!in_bounds(header.expiry_bytes_offset, expiry_offsets.back())) {
+        throw std::runtime_error("Corrupt snapshot: " + path);
+    }
+    for (uint32_t e = 0; e < header.expiry_count; ++e) {
+        if (expiry_offsets[e] > expiry_offsets[e + 1]) {
+            throw std::runtime_error("Corrupt snapshot: " + path);
+        }
+        std::string expiry(file.data() + header.expiry_bytes_offset + expiry_offsets[e],
+                           expiry_offsets[e + 1] - expiry_offsets[e]);
+        const int days = calculate_days_to_expiry(expiry);
+        if (filter && !CompiledOptionFilter::expiry_passes(*filter, expiry, days)) continue;
+        new_id[e] = uint16_t(chain.expiries.size());
+        chain.expiries.push_back(std::move(expiry));
+        chain.expiry_days.push_back(days);
+    }
+
+    const auto* expiry_id = reinterpret_cast<const uint16_t*>(file.data() + header.column_offset[COL_EXPIRY_ID]);
+    const auto* side = reinterpret_cast<const uint8_t*>(file.data() + header.column_offset[COL_SIDE]);
+    for (size_t i = 0; i < n; ++i) {
+        if (expiry_id[i] >= header.expiry_count || side[i] > 1) {
+            throw std::runtime_error("Corrupt snapshot: " + path);
+        }
+    }
+
+    if (filter) {
+        auto column = [&](uint32_t col) {
+            return reinterpret_cast<const double*>(file.data() + header.column_offset[col]);
+        };
+        const double *volume = column(COL_VOLUME), *oi = column(COL_OI), *mid = column(COL_MID);
+        const double *bid = column(COL_BID), *ask = column(COL_ASK);
+        const CompiledOptionFilter quotes(*filter);
+        std::vector<uint32_t> rows;
+        for (size_t i = 0; i < n; ++i) {
+            // Every row of a skipped expiry is an expiry rejection, as in the JSON loader
+            const OptionCriterion outcome = new_id[expiry_id[i]] == DROPPED
+                ? OptionCriterion::EXPIRY
+                : quotes.quote_rejection(volume[i], oi[i], mid[i], bid[i], ask[i]);
+            if (outcome == OptionCriterion::NONE) {
+                rows.push_back(uint32_t(i));
+            } else if (counters) {
+                ++counters->rows;
+                ++counters->rejected[size_t(outcome)];
+            }
+        }
+
+        for (uint32_t col = 0; col < COL_EXPIRY_ID; ++col) {
+            const double* src = column(col);
+            std::vector<double>& dst = *double_column(chain, col);
+            dst.resize(rows.size());
+            for (size_t r = 0; r < rows.size(); ++r) dst[r] = src[rows[r]];
+        }
+        chain.expiry_id.resize(rows.size());
+        chain.side.resize(rows.size());
+        for (size_t r = 0; r < rows.size(); ++r) {
+            chain.expiry_id[r] = new_id[expiry_id[rows[r]]];
+            chain.side[r] = static_cast<Side>(side[rows[r]]);
+        }
+    } else {
+        // Columns are copied as-is
+        for (uint32_t col = 0; col < COL_EXPIRY_ID; ++col) {
+            const auto* src = reinterpret_cast<const double*>(file.data() + header.column_offset[col]);
+            double_column(chain, col)->assign(src, src + n);
+        }
+        chain.expiry_id.assign(expiry_id, expiry_id + n);
+        chain.side.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            chain.side[i] = static_cast<Side>(side[i]);
+        }
+    }
+
+    std::optional<double> spot;
+    if (header.has_spot) {
+        spot = header.spot;
+    }
+    return {std::move(chain), spot};
+}
+
+std::tuple<OptionChain, std::optional<double>> load_binary_snapshot(const std::string& path) {
+    return load_binary(path, nullptr, nullptr);
+}
+
+std::tuple<OptionChain, std::optional<double>> load_binary_snapshot(const std::string& path,
+                                                                    const ConfigFilter& filter,
+                                                                    OptionCounters* counters) {
+    return load_binary(path, &filter, counters);
+}
@@ -0,0 +1,116 @@
+#include "stats.hpp"
+#include <json.hpp>
+#include <algorithm>
+
+using ordered_json = nlohmann::ordered_json;
+
+void GeneratorCounters::merge(const GeneratorCounters& other) {
+    tasks += other.tasks;
+    seconds += other.seconds;
+    candidates += other.candidates;
+    pruned += other.pruned;
+    passed += other.passed;
+    for (size_t c = 0; c < size_t(StrategyCriterion::COUNT); ++c) {
+        rejected[c] += other.rejected[c];
+    }
+    memory.merge(other.memory);
+}
+
+void ScreenStats::add_stage(const std::string& name, double seconds) {
+    auto it = std::find_if(stages_.begin(), stages_.end(), [&](const auto& s) { return s.first == name; });
+    if (it == stages_.end()) {
+        stages_.emplace_back(name, seconds);
+    } else {
+        it->second += seconds;
+    }
+}
+
+void ScreenStats::add_stage_memory(const std::string& name, const MemoryCounters& counters) {
+    auto it = std::find_if(stage_memory_.begin(), stage_memory_.end(), [&](const auto& s) { return s.first == name; });
+    if (it == stage_memory_.end()) {
+        stage_memory_.emplace_back(name, counters);
+    } else {
+        it->second.merge(counters);
+    }
+}
+
+static ordered_json memory_json(const MemoryCounters& m) {
+    ordered_json out;
+    out["allocations"] = m.allocations;
+    out["bytes"] = m.bytes;
+    out["peak_bytes"] = m.peak_bytes;
+    return out;
+}
+
+GeneratorCounters& ScreenStats::generator(const std::string& name) {
+    auto it = std::find_if(generators_.begin(), generators_.end(), [&](const auto& g) { return g.first == name; });
+    if (it == generators_.end()) {
+        generators_.emplace_back(name, GeneratorCounters{});
+        return generators_.back().second;
+    }
+    return it->second;
+}
+
+std::string ScreenStats::to_json(int indent) const {
+    ordered_json out;
+    out["threads"] = threads;
+
+    ordered_json stages = ordered_json::object();
+    for (const auto& [name, seconds] : stages_) {
+        stages[name] = seconds;
+    }
+    out["stages"] = stages;
+
+    // Every criterion is listed, so dashboards see zeros rather than gaps
+    ordered_json options;
+    options["rows"] = options_.rows;
+    options["passed"] = options_.passed;
+    ordered_json option_rejected = ordered_json::object();
+    for (size_t c = 1; c < size_t(OptionCriterion::COUNT); ++c) {
+        option_rejected[option_criterion_name(OptionCriterion(c))] = options_.rejected[c];
+    }
+    options["rejected"] = option_rejected;
+    out["options"] = options;
+
+    if (priced_) {
+        ordered_json pricing;
+        pricing["rows"] = pricing_.rows;
+        pricing["solved"] = pricing_.solved;
+        pricing["quoted"] = pricing_.quoted;
+        pricing["failed"] = pricing_.failed;
+        out["pricing"] = pricing;
+    }
+
+    ordered_json generators = ordered_json::object();
+    for (const auto& [name, g] : generators_) {
+        ordered_json entry;
+        entry["tasks"] = g.tasks;
+        entry["seconds"] = g.seconds;
+        entry["candidates"] = g.candidates;
+        entry["pruned"] = g.pruned;
+        entry["passed"] = g.passed;
+        ordered_json rejected = ordered_json::object();
+        for (size_t c = 1; c < size_t(StrategyCriterion::COUNT); ++c) {
+            rejected[strategy_criterion_name(StrategyCriterion(c))] = g.rejected[c];
+        }
+        entry["rejected"] = rejected;
+        if (memory) entry["memory"] = memory_json(g.memory);
+        generators[name] = entry;
+    }
+    out["generators"] = generators;
+
+    if (memory) {
+        ordered_json mem;
+        mem["peak_bytes"] = std::max<int64_t>(memory::peak_bytes(), 0);
+        mem["peak_rss"] = memory::peak_rss_bytes();
+        mem["budget"] = memory::budget();
+        ordered_json stages_mem = ordered_json::object();
+        for (const auto& [name, m] : stage_memory_) {
+            stages_mem[name] = memory_json(m);
+        }
+        mem["stages"] = stages_mem;
+        out["memory"] = mem;
+    }
+
+    return out.dump(indent);
+}
@@ -0,0 +1,293 @@
+#include "strategy/combo_kernel.hpp"
+#include "simd.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+// Built with -ffp-contract=off (see CMakeLists.txt): a fused multiply-add
+// would round differently from the scalar builders. -fno-trapping-math only
+// lets the selects below be evaluated on both sides; results are unchanged.
+
+namespace {
+
+constexpr size_t legs_of(StrategyKind kind) {
+    switch (kind) {
+        case StrategyKind::SINGLE_LEG: return 1;
+        case StrategyKind::IRON_CONDOR:
+        case StrategyKind::BUTTERFLY: return 4;
+        case StrategyKind::STRADDLE:
+        case StrategyKind::STRANGLE:
+        case StrategyKind::VERTICAL:
+        case StrategyKind::CALENDAR:
+        case StrategyKind::DIAGONAL: return 2;
+    }
+    return 0;
+}
+
+// The FIXED legs are summed once, then each combo continues from those
+// partial sums over its VARYING legs, unrolled. Every shape is a template
+// parameter (LONG for the directed kinds), so the loop has no control
+// flow and every accumulator stays in a register.
+template <StrategyKind KIND, size_t VARYING, bool LONG>
+SIMD_INLINE void evaluate_block(const OptionChain& chain, const ComboBlock& block,
+                                const CompiledStrategyFilter& filter, const ComboMetrics& out) {
+    constexpr size_t FIXED = legs_of(KIND) - VARYING;
+    const double INF = std::numeric_limits<double>::infinity();
+    const double NaN = std::numeric_limits<double>::quiet_NaN();
+    const double* __restrict mid = chain.mid.data();
+    const double* __restrict strike = chain.strike.data();
+    const double* __restrict delta = chain.delta.data();
+    const double* __restrict theta = chain.theta.data();
+    const double* __restrict vega = chain.vega.data();
+    const double* __restrict ivs = chain.iv.data();
+    const double* __restrict volume = chain.volume.data();
+    const double* __restrict oi = chain.oi.data();
+    const Side* __restrict side = chain.side.data();
+
+    // Leg by leg in builder order: prices into debit (BUY) or credit (SELL),
+    // signed greeks, IV over legs with iv > 0, and the thinnest leg
+    struct Sums {
+        double paid = 0.0, received = 0.0;
+        double nd = 0.0, nt = 0.0, nv = 0.0;
+        double iv_sum = 0.0, iv_count = 0.0;
+        double liquidity = std::numeric_limits<double>::infinity();
+    };
+    auto add_leg = [&](Sums& s, uint32_t r, double qty) {
+        const double m = mid[r];
+        const double price = m > 0.0 ? m : 0.0;
+        s.paid += qty > 0 ? price : 0.0;
+        s.received += qty > 0 ? 0.0 : price;
+        s.nd += delta[r] * 100.0 * qty;
+        s.nt += theta[r] * 100.0 * qty;
+        s.nv += vega[r] * 100.0 * qty;
+        const double v = ivs[r];
+        s.iv_sum += v > 0 ? v : 0.0;
+        s.iv_count += v > 0 ? 1.0 : 0.0;
+        const double q = volume[r] + oi[r];
+        s.liquidity = q < s.liquidity ? q : s.liquidity;
+    };
+
+    uint32_t fixed_rows[FIXED + 1];  // + 1 since FIXED may be 0
+    Sums prefix;
+    for (size_t l = 0; l < FIXED; ++l) {
+        fixed_rows[l] = block.rows[l][0];
+        add_leg(prefix, fixed_rows[l], block.sign[l]);
+    }
+
+    const uint32_t* __restrict rows[VARYING];
+    double qty[VARYING];
+    for (size_t v = 0; v < VARYING; ++v) {
+        rows[v] = block.rows[FIXED + v];
+        qty[v] = block.sign[FIXED + v];
+    }
+
+    // Row of leg L in combo i, for the gain/loss formulas
+    auto leg_row = [&](auto L, size_t i) -> uint32_t {
+        if constexpr (L() < FIXED) return fixed_rows[L()];
+        else return rows[L() - FIXED][i];
+    };
+    using Leg0 = std::integral_constant<size_t, 0>;
+    using Leg1 = std::integral_constant<size_t, 1>;
+
+    double* __restrict debit = out.debit;
+    double* __restrict credit = out.credit;
+    double* __restrict max_gain = out.max_gain;
+    double* __restrict max_loss = out.max_loss;
+    double* __restrict reward_risk = out.reward_risk;
+    double* __restrict net_delta = out.net_delta;
+    double* __restrict net_theta = out.net_theta;
+    double* __restrict net_vega = out.net_vega;
+    double* __restrict avg_iv = out.iv;
+    double* __restrict liquidity = out.liquidity;
+    uint8_t* __restrict pass = out.pass;
+
+    // Locals, since stores through pass could otherwise alias the block and
+    // filter and force reloads every iteration
+    const size_t n = block.count;
+    const CompiledStrategyFilter::Range f_debit = filter.debit, f_credit = filter.credit;
+    const CompiledStrategyFilter::Range f_gain = filter.gain, f_loss = filter.loss, f_rr = filter.rr;
+    const CompiledStrategyFilter::Range f_delta = filter.delta, f_theta = filter.theta, f_vega = filter.vega;
+    const CompiledStrategyFilter::Range f_iv = filter.iv;
+
+    // The chain columns are read-only here, but GCC cannot prove that the
+    // gathers from them never alias the output stores
+#pragma GCC ivdep
+    for (size_t i = 0; i < n; ++i) {
+        Sums s = prefix;
+        for (size_t v = 0; v < VARYING; ++v) {
+            add_leg(s, rows[v][i], qty[v]);
+        }
+
+        const double d = s.paid * 100.0;
+        const double c = s.received * 100.0;
+        const double cost = d - c;
+
+        double gain, loss;
+        if constexpr (KIND == StrategyKind::IRON_CONDOR) {
+            gain = c;
+            loss = (strike[leg_row(Leg1{}, i)] - strike[leg_row(Leg0{}, i)]) * 100.0 - c;
+        } else if constexpr (KIND == StrategyKind::VERTICAL || KIND == StrategyKind::BUTTERFLY) {
+            // detail::finish_spread
+            const double width = std::fabs(strike[leg_row(Leg1{}, i)] - strike[leg_row(Leg0{}, i)]) * 100.0;
+            gain = LONG ? width - cost : -cost;
+            loss = LONG ? cost : width + cost;
+        } else if constexpr (KIND == StrategyKind::SINGLE_LEG) {
+            const uint32_t r = leg_row(Leg0{}, i);
+            gain = side[r] == Side::CALL ? INF : strike[r] * 100.0 - cost;
+            loss = cost;
+        } else {
+            gain = LONG ? INF : c;
+            loss = LONG ? cost : INF;
+        }
+        // Divided unconditionally so the selects need no branch; the kept
+        // quotients are the same as the builders'
+        const double ratio = gain / loss;
+        const double mean_iv = s.iv_sum / s.iv_count;
+        const double rr = loss > 0 ? ratio : INF;
+        const double iv = s.iv_count > 0 ? mean_iv : NaN;
+
+        debit[i] = d;
+        credit[i] = c;
+        max_gain[i] = gain;
+        max_loss[i] = loss;
+        reward_risk[i] = rr;
+        net_delta[i] = s.nd;
+        net_theta[i] = s.nt;
+        net_vega[i] = s.nv;
+        avg_iv[i] = iv;
+        liquidity[i] = s.liquidity;
+
+        // passes_strategy_level_filters: NaN fails every enabled range, and
+        // debit/credit ranges only apply to nonzero amounts. A combo without
+        // IV has mean_iv = 0/0 = NaN, which the negated iv tests let through.
+        auto in = [](const CompiledStrategyFilter::Range& range, double x) {
+            return !range.on | ((x >= range.lo) & (x <= range.hi));
+        };
+        pass[i] = (!(d > 0) | in(f_debit, d)) &
+                  (!(c > 0) | in(f_credit, c)) &
+                  in(f_gain, gain) & in(f_loss, loss) & in(f_rr, rr) &
+                  in(f_delta, s.nd) & in(f_theta, s.nt) & in(f_vega, s.nv) &
+                  (!f_iv.on | (!(mean_iv < f_iv.lo) & !(mean_iv > f_iv.hi)));
+    }
+}
+
+template <StrategyKind KIND, bool LONG = false>
+SIMD_INLINE void evaluate_kind(const OptionChain& chain, const ComboBlock& block,
+                               const CompiledStrategyFilter& filter, const ComboMetrics& out) {
+    constexpr size_t LEGS = legs_of(KIND);
+    switch (LEGS - block.fixed) {
+        case 1: evaluate_block<KIND, 1, LONG>(chain, block, filter, out); break;
+        case 2: if constexpr (LEGS >= 2) evaluate_block<KIND, 2, LONG>(chain, block, filter, out); break;
+        case 3: if constexpr (LEGS >= 3) evaluate_block<KIND, 3, LONG>(chain, block, filter, out); break;
+        case 4: if constexpr (LEGS >= 4) evaluate_block<KIND, 4, LONG>(chain, block, filter, out); break;
+    }
+}
+
+}  // namespace
+
+// Every combo needs at least one varying leg
+SIMD_TARGET_CLONES
+void evaluate_combos(const OptionChain& chain, const ComboBlock& block,
+                     const CompiledStrategyFilter& filter, const ComboMetrics& out) {
+    switch (block.kind) {
+        case StrategyKind::SINGLE_LEG: evaluate_kind<StrategyKind::SINGLE_LEG>(chain, block, filter, out); break;
+        case StrategyKind::IRON_CONDOR: evaluate_kind<StrategyKind::IRON_CONDOR>(chain, block, filter, out); break;
+        case StrategyKind::STRADDLE:
+            if (block.sign[0] > 0) evaluate_kind<StrategyKind::STRADDLE, true>(chain, block, filter, out);
+            else evaluate_kind<StrategyKind::STRADDLE, false>(chain, block, filter, out);
+            break;
+        case StrategyKind::STRANGLE:
+            if (block.sign[0] > 0) evaluate_kind<StrategyKind::STRANGLE, true>(chain, block, filter, out);
+            else evaluate_kind<StrategyKind::STRANGLE, false>(chain, block, filter, out);
+            break;
+        case StrategyKind::VERTICAL:
+            if (block.sign[0] > 0) evaluate_kind<StrategyKind::VERTICAL, true>(chain, block, filter, out);
+            else evaluate_kind<StrategyKind::VERTICAL, false>(chain, block, filter, out);
+            break;
+        case StrategyKind::BUTTERFLY:
+            if (block.sign[0] > 0) evaluate_kind<StrategyKind::BUTTERFLY, true>(chain, block, filter, out);
+            else evaluate_kind<StrategyKind::BUTTERFLY, false>(chain, block, filter, out);
+            break;
+        case StrategyKind::CALENDAR:
+        case StrategyKind::DIAGONAL:
+            break;  // see kernel_supports
+    }
+}
+
+ComboEvaluator::ComboEvaluator(const OptionChain& chain, StrategyKind kind, std::span<const int8_t> signs,
+                               const ConfigFilter& cfg, const std::function<void(const StrategyRecord&)>& emit,
+                               std::pmr::memory_resource* scratch, GeneratorCounters* counters)
+    : chain_(chain), cfg_(cfg), filter_(cfg), emit_(emit), counters_(counters), kind_(kind),
+      columns_(10 * BLOCK, scratch), pass_(BLOCK, scratch) {
+    for (int8_t sign : signs) {
+        sign_[leg_count_++] = sign;
+    }
+}
+
+void ComboEvaluator::run(std::span<const uint32_t> fixed, std::span<const uint32_t* const> varying, size_t count) {
+    ComboBlock block{};
+    block.kind = kind_;
+    block.leg_count = leg_count_;
+    block.fixed = static_cast<uint8_t>(fixed.size());
+    std::copy(sign_, sign_ + leg_count_, block.sign);
+
+    // Every record of this call starts from the fixed legs
+    StrategyRecord record{};
+    record.kind = kind_;
+    record.leg_count = leg_count_;
+    std::copy(sign_, sign_ + leg_count_, record.sign);
+    const uint32_t* fixed_rows = fixed.data();
+    for (size_t l = 0; l < fixed.size(); ++l) {
+        block.rows[l] = fixed_rows + l;
+        record.leg[l] = fixed_rows[l];
+    }
+
+    double* col = columns_.data();
+    const ComboMetrics out{col, col + BLOCK, col + 2 * BLOCK, col + 3 * BLOCK, col + 4 * BLOCK,
+                           col + 5 * BLOCK, col + 6 * BLOCK, col + 7 * BLOCK, col + 8 * BLOCK, col + 9 * BLOCK,
+                           pass_.data()};
+    const uint8_t* pass = pass_.data();
+
+    for (size_t begin = 0; begin < count; begin += BLOCK) {
+        size_t l = block.fixed;
+        for (const uint32_t* rows : varying) {
+            block.rows[l++] = rows + begin;
+        }
+        const size_t n = std::min(BLOCK, count - begin);
+        block.count = n;
+        evaluate_combos(chain_, block, filter_, out);
+
+        for (size_t i = 0; i < n; ++i) {
+            if (!pass[i]) {
+                if (counters_) record_rejection(i);
+                continue;
+            }
+
+            StrategyRecord r = record;
+            for (size_t k = fixed.size(); k < leg_count_; ++k) {
+                r.leg[k] = block.rows[k][i];
+            }
+            r.debit = col[i];
+            r.credit = col[BLOCK + i];
+            r.max_gain = col[2 * BLOCK + i];
+            r.max_loss = col[3 * BLOCK + i];
+            r.reward_risk = col[4 * BLOCK + i];
+            r.net_delta = col[5 * BLOCK + i];
+            r.net_theta = col[6 * BLOCK + i];
+            r.net_vega = col[7 * BLOCK + i];
+            r.iv = col[8 * BLOCK + i];
+            r.liquidity = col[9 * BLOCK + i];
+            emit_(r);
+        }
+    }
+}
+
+void ComboEvaluator::record_rejection(size_t i) {
+    const double* col = columns_.data();
+    const double iv = col[8 * BLOCK + i];
+    counters_->record(strategy_level_rejection(
+        cfg_, col[i], col[BLOCK + i], col[2 * BLOCK + i], col[3 * BLOCK + i], col[4 * BLOCK + i],
+        col[5 * BLOCK + i], col[6 * BLOCK + i], col[7 * BLOCK + i],
+        std::isnan(iv) ? std::nullopt : std::optional<double>(iv)));
+}
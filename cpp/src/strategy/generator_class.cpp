@@ -1,4 +1,266 @@
 #include "strategy/generator_class.hpp"
+#include "factory/strategy_level_filter.hpp"
+#include <cmath>
+#include <limits>
 
-// Implementation mostly in header
+namespace {
 
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+// Closed interval of a metric over a set of combinations; empty when lo > hi.
+// NaN values are never added, which is safe because a NaN metric fails any
+// range that is set.
+struct Bounds {
+    double lo = INF;
+    double hi = -INF;
+
+    void add(double v) {
+        lo = std::min(lo, v);
+        hi = std::max(hi, v);
+    }
+
+    void add(const Bounds& b) {
+        lo = std::min(lo, b.lo);
+        hi = std::max(hi, b.hi);
+    }
+};
+
+// Bounds are assembled in a different order than the exact per-combination
+// sums, so they are widened slightly before any pruning decision
+double widen_lo(double x) { return x - (std::fabs(x) * 1e-9 + 1e-9); }
+double widen_hi(double x) { return x + (std::fabs(x) * 1e-9 + 1e-9); }
+
+// True if no value in b can satisfy range (an unset range never prunes)
+bool outside(double lo, double hi, const std::optional<std::tuple<double, double>>& range) {
+    if (!range.has_value()) return false;
+    auto [min_val, max_val] = range.value();
+    return widen_hi(hi) < min_val || widen_lo(lo) > max_val;
+}
+
+// Same as StrategyRecord::rr of a condor with this credit and width;
+// non-decreasing in credit
+double condor_rr(double credit, double width) {
+    double loss = width - credit;
+    return loss > 0 ? (credit / loss) : INF;
+}
+
+// Per-expiry put-side aggregates. prefix_*[j] covers puts[0, j), i.e. the buy
+// puts available to a short put with j puts strictly below it.
+struct PutSide {
+    std::pmr::vector<size_t> bp_end;
+    std::pmr::vector<Bounds> prefix_price, prefix_delta, prefix_theta, prefix_vega;
+
+    // Over every valid (short put, buy put) pair
+    size_t pairs = 0;
+    Bounds credit_price;  // short put price
+    Bounds debit_price;   // buy put price
+    Bounds delta, theta, vega;
+
+    PutSide(const OptionChain& chain, const ExpirySlice& slice, std::pmr::memory_resource* resource)
+        : bp_end(resource), prefix_price(resource), prefix_delta(resource),
+          prefix_theta(resource), prefix_vega(resource) {
+        const auto& puts = slice.puts;
+        prefix_price.resize(puts.size() + 1);
+        prefix_delta.resize(puts.size() + 1);
+        prefix_theta.resize(puts.size() + 1);
+        prefix_vega.resize(puts.size() + 1);
+        for (size_t j = 0; j < puts.size(); ++j) {
+            uint32_t p = puts[j];
+            prefix_price[j + 1] = prefix_price[j];
+            prefix_price[j + 1].add(chain.price(p));
+            prefix_delta[j + 1] = prefix_delta[j];
+            prefix_delta[j + 1].add(chain.delta[p] * 100.0);
+            prefix_theta[j + 1] = prefix_theta[j];
+            prefix_theta[j + 1].add(chain.theta[p] * 100.0);
+            prefix_vega[j + 1] = prefix_vega[j];
+            prefix_vega[j + 1].add(chain.vega[p] * 100.0);
+        }
+
+        bp_end.resize(slice.otm_put_end);
+        size_t j = 0;
+        for (size_t sp = 0; sp < slice.otm_put_end; ++sp) {
+            double strike = chain.strike[puts[sp]];
+            while (j < sp && chain.strike[puts[j]] < strike) ++j;
+            bp_end[sp] = j;
+            pairs += j;
+            if (j == 0) continue;
+
+            uint32_t p = puts[sp];
+            credit_price.add(chain.price(p));
+            debit_price.add(prefix_price[j]);
+            delta.add(shifted(prefix_delta[j], -chain.delta[p] * 100.0));
+            theta.add(shifted(prefix_theta[j], -chain.theta[p] * 100.0));
+            vega.add(shifted(prefix_vega[j], -chain.vega[p] * 100.0));
+        }
+    }
+
+    static Bounds shifted(const Bounds& b, double offset) {
+        Bounds out;
+        if (b.lo <= b.hi && !std::isnan(offset)) {
+            out.lo = b.lo + offset;
+            out.hi = b.hi + offset;
+        }
+        return out;
+    }
+};
+
+}  // namespace
+
+// ===================== IRON CONDOR PRUNER =====================
+class IronCondor::Pruner {
+public:
+    Pruner(const OptionChain& chain, const ExpirySlice& slice, const ConfigFilter& cfg,
+           std::pmr::memory_resource* scratch)
+        : chain_(chain), cfg_(cfg), put_side_(chain, slice, scratch) {}
+
+    bool empty() const { return put_side_.credit_price.lo > put_side_.credit_price.hi; }  // no put wing pairs
+
+    template <size_t L>
+    LegStep check(const uint32_t* rows, size_t pos, size_t end, GeneratorCounters* counters);
+
+private:
+    const OptionChain& chain_;
+    const ConfigFilter& cfg_;
+    const PutSide put_side_;
+
+    // Of the current call wing
+    double sc_price_ = 0.0;
+    double bc_price_ = 0.0;
+    double width_ = 0.0;
+    double call_delta_ = 0.0, call_theta_ = 0.0, call_vega_ = 0.0;
+};
+
+template <size_t L>
+LegStep IronCondor::Pruner::check(const uint32_t* rows, size_t pos, size_t end, GeneratorCounters* counters) {
+    const OptionChain& chain = chain_;
+    const ConfigFilter& cfg = cfg_;
+    const PutSide& put_side = put_side_;
+
+    if constexpr (L == 0) {
+        sc_price_ = chain.price(rows[0]);
+        return LegStep::KEEP;
+    } else if constexpr (L == 1) {
+        const uint32_t sc_row = rows[0];
+        const uint32_t bc_row = rows[1];
+        const double sc_price = sc_price_;
+        const double bc_price = chain.price(bc_row);
+        const double width = (chain.strike[bc_row] - chain.strike[sc_row]) * 100.0;
+        const double call_delta = chain.delta[sc_row] * 100.0 * -1 + chain.delta[bc_row] * 100.0;
+        const double call_theta = chain.theta[sc_row] * 100.0 * -1 + chain.theta[bc_row] * 100.0;
+        const double call_vega = chain.vega[sc_row] * 100.0 * -1 + chain.vega[bc_row] * 100.0;
+
+        // Bounds over every put wing pair for this call wing
+        const double credit_lo = (sc_price + put_side.credit_price.lo) * 100.0;
+        const double credit_hi = (sc_price + put_side.credit_price.hi) * 100.0;
+        const double debit_lo = (bc_price + put_side.debit_price.lo) * 100.0;
+        const double debit_hi = (bc_price + put_side.debit_price.hi) * 100.0;
+        const double loss_lo = width - credit_hi;
+        const double loss_hi = width - credit_lo;
+        const double rr_lo = condor_rr(credit_lo, width);
+        const double rr_hi = condor_rr(credit_hi, width);
+
+        // Wider call wings only increase max_loss and decrease rr
+        if ((cfg.potential_loss_range.has_value() &&
+             widen_lo(loss_lo) > std::get<1>(cfg.potential_loss_range.value())) ||
+            (cfg.rr_range.has_value() &&
+             widen_hi(rr_hi) < std::get<0>(cfg.rr_range.value()))) {
+            if (counters) counters->pruned += (end - pos) * put_side.pairs;
+            return LegStep::STOP;
+        }
+
+        if ((credit_lo > 0 && outside(credit_lo, credit_hi, cfg.credit_range)) ||
+            (debit_lo > 0 && outside(debit_lo, debit_hi, cfg.debit_range)) ||
+            outside(credit_lo, credit_hi, cfg.potential_gain_range) ||
+            outside(loss_lo, loss_hi, cfg.potential_loss_range) ||
+            outside(rr_lo, rr_hi, cfg.rr_range) ||
+            outside(call_delta + put_side.delta.lo, call_delta + put_side.delta.hi, cfg.net_delta_range) ||
+            outside(call_theta + put_side.theta.lo, call_theta + put_side.theta.hi, cfg.net_theta_range) ||
+            outside(call_vega + put_side.vega.lo, call_vega + put_side.vega.hi, cfg.net_vega_range)) {
+            if (counters) counters->pruned += put_side.pairs;
+            return LegStep::SKIP;
+        }
+
+        bc_price_ = bc_price;
+        width_ = width;
+        call_delta_ = call_delta;
+        call_theta_ = call_theta;
+        call_vega_ = call_vega;
+        return LegStep::KEEP;
+    } else {
+        static_assert(L == 2);
+        const size_t bp_end = put_side.bp_end[pos];
+        if (bp_end == 0) return LegStep::SKIP;  // nothing below this short put
+
+        const uint32_t sp_row = rows[2];
+
+        // credit, max_gain, max_loss and rr are fixed by the short legs
+        // and computed exactly as make_iron_condor does
+        const double credit = (sc_price_ + chain.price(sp_row)) * 100.0;
+        const double max_loss = width_ - credit;
+        const double rr = condor_rr(credit, width_);
+        if ((cfg.credit_range.has_value() && credit > 0 && !check_range(credit, cfg.credit_range)) ||
+            !check_range(credit, cfg.potential_gain_range) ||
+            !check_range(max_loss, cfg.potential_loss_range) ||
+            !check_range(rr, cfg.rr_range)) {
+            if (counters) counters->pruned += bp_end;
+            return LegStep::SKIP;
+        }
+
+        const Bounds& bp_price = put_side.prefix_price[bp_end];
+        const double d_off = call_delta_ - chain.delta[sp_row] * 100.0;
+        const double t_off = call_theta_ - chain.theta[sp_row] * 100.0;
+        const double v_off = call_vega_ - chain.vega[sp_row] * 100.0;
+        const Bounds& bp_delta = put_side.prefix_delta[bp_end];
+        const Bounds& bp_theta = put_side.prefix_theta[bp_end];
+        const Bounds& bp_vega = put_side.prefix_vega[bp_end];
+        const double bp_debit_lo = (bc_price_ + bp_price.lo) * 100.0;
+        if ((bp_debit_lo > 0 && outside(bp_debit_lo, (bc_price_ + bp_price.hi) * 100.0, cfg.debit_range)) ||
+            outside(d_off + bp_delta.lo, d_off + bp_delta.hi, cfg.net_delta_range) ||
+            outside(t_off + bp_theta.lo, t_off + bp_theta.hi, cfg.net_theta_range) ||
+            outside(v_off + bp_vega.lo, v_off + bp_vega.hi, cfg.net_vega_range)) {
+            if (counters) counters->pruned += bp_end;
+            return LegStep::SKIP;
+        }
+        return LegStep::KEEP;
+    }
+}
+
+// ===================== IRON CONDOR PARTITION =====================
+std::vector<GeneratorTask> IronCondor::partition(const ChainIndex& index, size_t parts) {
+    // Rough combination count: each short call pairs with every call above
+    // it, times the put wing pairs of its expiry
+    constexpr size_t TASKS_PER_PART = 4;
+    auto put_pairs = [](const ExpirySlice& slice) {
+        return double(slice.otm_put_end) * double(slice.otm_put_end) / 2.0;
+    };
+    auto call_work = [](const ExpirySlice& slice, size_t sc) {
+        return double(slice.calls.size() - sc - 1);
+    };
+
+    double total = 0.0;
+    for (const ExpirySlice& slice : index.expiries()) {
+        for (size_t sc = slice.otm_call_begin; sc < slice.calls.size(); ++sc) {
+            total += call_work(slice, sc) * put_pairs(slice);
+        }
+    }
+    const double target = parts > 1 ? total / double(parts * TASKS_PER_PART) : INF;
+
+    std::vector<GeneratorTask> tasks;
+    for (size_t e = 0; e < index.expiries().size(); ++e) {
+        const ExpirySlice& slice = index.expiries()[e];
+        size_t begin = slice.otm_call_begin;
+        double work = 0.0;
+        for (size_t sc = slice.otm_call_begin; sc < slice.calls.size(); ++sc) {
+            work += call_work(slice, sc) * put_pairs(slice);
+            if (work >= target && sc + 1 < slice.calls.size()) {
+                tasks.push_back({e, begin, sc + 1});
+                begin = sc + 1;
+                work = 0.0;
+            }
+        }
+        tasks.push_back({e, begin, slice.calls.size()});
+    }
+    return tasks;
+}
+
+template class ComboGenerator<IronCondor>;
@@ -1,5 +1,48 @@
 #include "strategy/strategy_class.hpp"
-#include <limits>
 
-// Implementation mostly in header
+const char* strategy_kind_name(StrategyKind kind) {
+    switch (kind) {
+        case StrategyKind::SINGLE_LEG: return "single_leg";
+        case StrategyKind::IRON_CONDOR: return "iron_condor";
+        case StrategyKind::STRADDLE: return "straddle";
+        case StrategyKind::STRANGLE: return "strangle";
+        case StrategyKind::VERTICAL: return "vertical";
+        case StrategyKind::BUTTERFLY: return "butterfly";
+        case StrategyKind::CALENDAR: return "calendar";
+        case StrategyKind::DIAGONAL: return "diagonal";
+    }
+    return "unknown";
+}
 
+std::string StrategyRecord::pretty(const OptionChain& chain) const {
+    switch (kind) {
+        case StrategyKind::SINGLE_LEG:
+            return "Single " + std::string(sign[0] > 0 ? "BUY" : "SELL") + " " + side_to_string(chain.side[leg[0]]) +
+                   "@" + std::to_string(chain.strike[leg[0]]) + " exp " + chain.expiry(leg[0]);
+        case StrategyKind::IRON_CONDOR:
+            return "IC C:" + std::to_string(chain.strike[leg[0]]) + "/" + std::to_string(chain.strike[leg[1]]) +
+                   " P:" + std::to_string(chain.strike[leg[2]]) + "/" + std::to_string(chain.strike[leg[3]]) +
+                   " exp " + chain.expiry(leg[0]);
+        case StrategyKind::STRADDLE:
+        case StrategyKind::STRANGLE:
+            return std::string(kind == StrategyKind::STRADDLE ? "Straddle " : "Strangle ") +
+                   (sign[0] > 0 ? "LONG" : "SHORT") + " C:" + std::to_string(chain.strike[leg[0]]) +
+                   " P:" + std::to_string(chain.strike[leg[1]]) + " exp " + chain.expiry(leg[0]);
+        case StrategyKind::VERTICAL:
+            return "Vertical " + std::string(sign[0] > 0 ? "LONG" : "SHORT") + " " +
+                   (chain.is_call(leg[0]) ? "C:" : "P:") + std::to_string(chain.strike[leg[0]]) + "/" +
+                   std::to_string(chain.strike[leg[1]]) + " exp " + chain.expiry(leg[0]);
+        case StrategyKind::BUTTERFLY:
+            return "Butterfly " + std::string(sign[0] > 0 ? "LONG" : "SHORT") + " " +
+                   (chain.is_call(leg[0]) ? "C:" : "P:") + std::to_string(chain.strike[leg[0]]) + "/" +
+                   std::to_string(chain.strike[leg[1]]) + "/" + std::to_string(chain.strike[leg[3]]) +
+                   " exp " + chain.expiry(leg[0]);
+        case StrategyKind::CALENDAR:
+            return "Calendar " + std::string(chain.is_call(leg[0]) ? "C:" : "P:") + std::to_string(chain.strike[leg[0]]) +
+                   " exp " + chain.expiry(leg[0]) + "/" + chain.expiry(leg[1]);
+        case StrategyKind::DIAGONAL:
+            return "Diagonal " + std::string(chain.is_call(leg[0]) ? "C:" : "P:") + std::to_string(chain.strike[leg[0]]) +
+                   "/" + std::to_string(chain.strike[leg[1]]) + " exp " + chain.expiry(leg[0]) + "/" + chain.expiry(leg[1]);
+    }
+    return "";
+}
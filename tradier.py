@@ -3,7 +3,7 @@ import time
 import json
 from datetime import datetime, timezone
 from pathlib import Path
-from typing import Dict, Iterable, List, Optional
+from typing import Callable, Dict, Iterable, List, Optional
 from threading import Thread, Lock
 
 import requests
@@ -110,7 +110,9 @@ def get_chain_for_expiration(symbol: str, expiration: str, greeks: bool = True)
     return out
 
 
-def iter_all_chains_grouped(symbol: str, delay_sec: float = 0.2) -> Dict[str, List[Dict]]:
+def iter_all_chains_grouped(symbol: str, delay_sec: float = 0.2,
+                            on_chain: Optional[Callable[[str, List[Dict]], None]] = None) -> Dict[str, List[Dict]]:
+    """Fetch every expiration; on_chain(exp, rows) is called as each one arrives."""
     expirations = get_expirations(symbol)
     total = len(expirations)
     result: Dict[str, List[Dict]] = {}
@@ -137,6 +139,8 @@ def iter_all_chains_grouped(symbol: str, delay_sec: float = 0.2) -> Dict[str, Li
             if rows:
                 with result_lock:
                     result[exp] = rows
+                    if on_chain:
+                        on_chain(exp, rows)
         except Exception as exc:
             print(f"expiration {exp} generated an exception: {exc}")
     
@@ -178,14 +182,43 @@ def write_json(data: Dict, out_path: Optional[Path]) -> None:
         print(json.dumps(data, indent=2))
 
 
+def stream_chains(symbol: str, out=sys.stdout) -> None:
+    """Write the chain as compact snapshot lines, one per expiration as it arrives.
+
+    The underlying quote goes first, so a consumer such as
+    `option_screener config.json --ingest -` can screen each expiration on
+    arrival instead of waiting for the whole chain.
+    """
+    def write_line(doc: Dict) -> None:
+        out.write(json.dumps(doc, separators=(",", ":")) + "\n")
+        out.flush()
+
+    write_line({"symbols": [symbol], "underlying": get_underlying_quote(symbol), "chains": {}})
+    iter_all_chains_grouped(
+        symbol,
+        on_chain=lambda exp, rows: write_line({"symbols": [symbol], "chains": {symbol: {exp: rows}}}),
+    )
+
+
 def normalize_symbol_param(symbol: str) -> str:
     s = (symbol or "").strip().upper().replace(" ", "")
     return s
 
 
-def main(symbol: str = "PLTR", output: Optional[str] = None, delay: float = 0.2, stdout: bool = False) -> int:
-    print(f"start: symbol={symbol} delay={delay} output={'stdout' if stdout else output}")
+def main(symbol: str = "PLTR", output: Optional[str] = None, delay: float = 0.2, stdout: bool = False,
+         stream: bool = False) -> int:
     symbol = normalize_symbol_param(symbol)
+    if stream:
+        # stdout carries the stream, so progress goes to stderr
+        real_stdout = sys.stdout
+        sys.stdout = sys.stderr
+        try:
+            stream_chains(symbol, out=real_stdout)
+        finally:
+            sys.stdout = real_stdout
+        return 0
+
+    print(f"start: symbol={symbol} delay={delay} output={'stdout' if stdout else output}")
 
     if stdout:
         out_path = None
@@ -214,4 +247,6 @@ def main(symbol: str = "PLTR", output: Optional[str] = None, delay: float = 0.2,
 
 
 if __name__ == "__main__":
-    sys.exit(main())
+    # python tradier.py [SYMBOL] [--stream]
+    args = [a for a in sys.argv[1:] if a != "--stream"]
+    sys.exit(main(symbol=args[0] if args else "PLTR", stream="--stream" in sys.argv[1:]))